@@ -40,6 +40,7 @@ sudo apt-get install -y \
     libopenal-dev \
     libmpg123-dev \
     libsndfile1-dev \
+    libturbojpeg0-dev \
     libboost-filesystem-dev
 
 # Step 2: Download openFrameworks if not present
@@ -172,7 +173,7 @@ Version: ${VERSION}
 Section: graphics
 Priority: optional
 Architecture: amd64
-Depends: libopencv-core${OPENCV_SUFFIX}, libopencv-imgproc${OPENCV_SUFFIX}, libopencv-video${OPENCV_SUFFIX}, libopencv-videoio${OPENCV_SUFFIX}, libglfw3, libfreeimage3t64, libpugixml1v5, liburiparser1, libgstreamer1.0-0, libgstreamer-plugins-base1.0-0, libasound2t64, libpulse0, libgtk-3-0t64, libcurl4t64
+Depends: libopencv-core${OPENCV_SUFFIX}, libopencv-imgproc${OPENCV_SUFFIX}, libopencv-video${OPENCV_SUFFIX}, libopencv-videoio${OPENCV_SUFFIX}, libglfw3, libfreeimage3t64, libpugixml1v5, liburiparser1, libgstreamer1.0-0, libgstreamer-plugins-base1.0-0, libasound2t64, libpulse0, libgtk-3-0t64, libcurl4t64, libturbojpeg
 Maintainer: GRL <info@graffitiresearchlab.com>
 Description: Laser Tag 2026 - Interactive laser graffiti
  An interactive art installation that uses computer vision
@@ -1,4 +1,5 @@
 #include "appController.h"
+#include "asyncLogger.h"
 
 // Logical window dimensions for UI scaling
 static const int LOGICAL_WIDTH = 1280;
@@ -9,7 +10,25 @@ static ofTrueTypeFont statusBarFont;
 
 //---------------------------------------------------
 appController::appController() {
-    
+    for (int i = 0; i < NUM_BRUSHES; i++) {
+        brushes[i] = NULL;
+    }
+    activeBrush = -1;
+    brushW = 0;
+    brushH = 0;
+    bRestoreWall = false;
+    soakHours = 0;
+    prewarmNum = PREWARM_STEPS;
+    prewarmStart = 0;
+}
+
+//set before setup - bring back the wall if the last run crashed
+void appController::setRestoreWall(bool bRestore) {
+    bRestoreWall = bRestore;
+}
+
+void appController::setSoakTest(float hours) {
+    soakHours = hours;
 }
 
 //all our initalizers
@@ -25,6 +44,12 @@ void appController::setup() {
     BRUSH_MODE = 0;
     bSetupCamera = false;
     bSetupVideo = false;
+    numMjpegFailures = 0;
+    bAttract = false;
+    lastLaserTime = 0;
+    bPowerSave = false;
+    bBrushDirty = false;
+    powerWakeTime = 0;
 
     // Load status bar font (14pt for visibility at 2x scale)
     statusBarFont.load("fonts/cour.ttf", 14);
@@ -34,22 +59,41 @@ void appController::setup() {
     setupProjections();
     projection_.loadSettings(ofToDataPath("settings/quadProj.xml"));
     colorMgr_.loadColorSettings(ofToDataPath("settings/colors.xml"));
+    
+    //per projector color correction luts
+    int numLuts = projection_.LUT.loadLuts(ofToDataPath("luts/"));
+    if(numLuts > 0){
+        LUT_NO.setMax(numLuts-1);
+        projection_.LUT.selectLut(LUT_NO);
+    }
     /////// GUI STUFF ////
     settingsImg.load("sys/settings.png");
     noticeImg.load("sys/criticalDontEditOrDelete.png");
     // Year logo removed - project now "laser-tag-2026"
     tracker_.useTrueTypeFont("fonts/courbd.ttf", 10);
     
+    //////// TRACKING THREADS ///
+    setupTrackingThreads();
+    shadow_.setup(ofToDataPath("settings/quad.xml"));
+    
     //////// NETWORK SETUP ///
     setupNetwork();
+    setupDmx();
+    setupReceiving();
     
-    if (USE_CAMERA) {
+    //////// STROKE LOGS ///
+    recorder_.setup(ofToDataPath("strokes/"));
+    heatmap_.setup();
+    
+    if (soakHours > 0) {
+        setupSoakSource();
+    } else if (USE_CAMERA) {
         setupCamera();
     } else {
         // Try video first, fall back to camera if video fails
         setupVideo();
         if (!tracker_.bVideoSetup) {
-            ofLogNotice("appController") << "Video setup failed, falling back to camera";
+            LT_LOG_NOTICE("appController") << "Video setup failed, falling back to camera";
             setupCamera();
         }
     }
@@ -69,9 +113,46 @@ void appController::setup() {
 }
 
 void appController::setupProjections(){
+    PROJECTION_W = MIN(PROJECTION_W, CANVAS_MAX_W);
+    PROJECTION_H = MIN(PROJECTION_H, CANVAS_MAX_H);
+    
+    //whatever a crashed run left in shared memory - only on launch,
+    //after a resize we start blank. the brush goes back first so
+    //LT_LOW_MEMORY makes the right one
+    ofPixels wallPix;
+    sceneBrushState wallState;
+    bool bAttached = wall_.setup(PROJECTION_W, PROJECTION_H);
+    bool bWall = bAttached && bRestoreWall && wall_.getWall(wallPix, wallState);
+    bRestoreWall = false;
+    if (bWall) {
+        BRUSH_MODE  = wallState.mode;
+        BRUSH_NO    = wallState.number;
+        BRUSH_COLOR = wallState.color;
+        BRUSH_WIDTH = wallState.width;
+    }
+    
     projection_.setup(PROJECTION_W, PROJECTION_H);
     setupBrushes(PROJECTION_W, PROJECTION_H);
     projection_.setToolDimensions(640, 360);
+    snapshot_.setup(PROJECTION_W, PROJECTION_H, ofToDataPath("snapshots/"));
+    sparks_.setup(PROJECTION_W, PROJECTION_H);
+    scenes_.setup(PROJECTION_W, PROJECTION_H);
+    mural_.setup(PROJECTION_W, PROJECTION_H, ofToDataPath("mural/"));
+    
+    //new brushes and buffers - warm them up before anyone paints
+    prewarmFbo.allocate(PROJECTION_W, PROJECTION_H, GL_RGBA);
+    prewarmNum = 0;
+    prewarmStart = ofGetElapsedTimeMillis();
+    
+    if (bWall) {
+        //in mural mode the mural's view is what is drawn - so the
+        //wall goes into the mural where the view is
+        scenes_.restore(wallPix);
+        if (MURAL) mural_.setView(wallPix);
+        setCommonText("status: wall restored after a crash");
+    } else {
+        wall_.clear();
+    }
 }
 
 void appController::setupCamera(){
@@ -83,12 +164,21 @@ void appController::setupCamera(){
     //is what we asked for and if not lets update our settings
     //with the real dimensions
     
-    tracker_.setupCamera(CAM_ID, camWidth, camHeight);
-    if (tracker_.W != 0 && tracker_.H != 0) {
+    //with mjpeg the tracker works at the scaled down size
+    //so the settings keep what the camera itself sends
+    if (CAM_MJPEG && numMjpegFailures < MJPEG_MAX_FAILURES && tracker_.setupMjpegCamera(CAM_ID, camWidth, camHeight, CAM_DECODE_SCALE)) {
+        CAM_WIDTH = tracker_.MJ.getCameraWidth();
+        CAM_HEIGHT = tracker_.MJ.getCameraHeight();
         camWidth = tracker_.W;
         camHeight = tracker_.H;
-        CAM_WIDTH = camWidth;
-        CAM_HEIGHT = camHeight;
+    } else {
+        tracker_.setupCamera(CAM_ID, camWidth, camHeight);
+        if (tracker_.W != 0 && tracker_.H != 0) {
+            camWidth = tracker_.W;
+            camHeight = tracker_.H;
+            CAM_WIDTH = camWidth;
+            CAM_HEIGHT = camHeight;
+        }
     }
     tracker_.setupCV(ofToDataPath("settings/quad.xml"));
 }
@@ -101,15 +191,64 @@ void appController::setupVideo(){
 //-----------------------------------------------------------
 void appController::setupBrushes(int w, int h) {
     
-    brushes[0] = new pngBrush();
-    brushes[1] = new vectorBrush();
-    brushes[2] = new gestureBrush();
-    brushes[3] = new graffLetter();
+    brushW = w;
+    brushH = h;
     
     for (int i = 0; i < NUM_BRUSHES; i++) {
+        delete brushes[i];
+        brushes[i] = NULL;
+    }
+    activeBrush = -1;
+    
+#ifdef LT_LOW_MEMORY
+    selectBrush();
+#else
+    for (int i = 0; i < NUM_BRUSHES; i++) {
+        brushes[i] = createBrush(i);
         brushes[i]->setup(w, h);
     }
+#endif
+    
+}
+
+//-----------------------------------------------------------
+baseBrush * appController::createBrush(int which) {
+    
+    if (which == 0) return new pngBrush();
+    if (which == 1) return new vectorBrush();
+    if (which == 2) return new gestureBrush();
+    if (which == 3) return new graffLetter();
+    
+    if (which == 4) {
+        fluidBrush * fluid = new fluidBrush();
+        fluid->setThreadPool(&threads_);
+        return fluid;
+    }
+    
+    if (which == 5) {
+        reactionBrush * reaction = new reactionBrush();
+        reaction->setThreadPool(&threads_);
+        return reaction;
+    }
+    
+    return new revealBrush();
+}
+
+//a brush that isn't picked isn't kept - switching brushes
+//starts the new one on a clean canvas
+//-----------------------------------------------------------
+void appController::selectBrush() {
+    
+    if (BRUSH_MODE == activeBrush && brushes[activeBrush] != NULL) return;
+    
+    for (int i = 0; i < NUM_BRUSHES; i++) {
+        delete brushes[i];
+        brushes[i] = NULL;
+    }
     
+    activeBrush = ofClamp(BRUSH_MODE, 0, NUM_BRUSHES - 1);
+    brushes[activeBrush] = createBrush(activeBrush);
+    brushes[activeBrush]->setup(brushW, brushH);
 }
 
 void appController::onBrushModeChange(int& i) {
@@ -119,6 +258,14 @@ void appController::onBrushModeChange(int& i) {
 void appController::onEnableNetwork(bool& b) {
     setupNetwork();
 }
+
+void appController::onEnableDmx(bool& b) {
+    setupDmx();
+}
+
+void appController::onEnableReceive(bool& b) {
+    setupReceiving();
+}
 //lets read some xml!
 //----------------------------------------------------
 void appController::loadSettings() {
@@ -133,6 +280,47 @@ void appController::loadSettings() {
     
     brush_panel = GUI.addPanel(BRUSH_SETTINGS);
     
+    LUT_SETTINGS.setName("Projector color");
+    LUT_SETTINGS.add(LUT_ENABLED.set("Use color LUT", false));
+    LUT_SETTINGS.add(LUT_NO.set("LUT file", 0, 0, 25));
+    LUT_SETTINGS.add(LUT_GAMMA.set("LUT gamma", 1.0, 0.2, 3.0));
+    lut_panel = GUI.addPanel(LUT_SETTINGS);
+    
+    SNAPSHOT_SETTINGS.setName("Snapshot settings");
+    SNAPSHOT_SETTINGS.add(SNAP_JPEG.set("Save as jpeg", false));
+    SNAPSHOT_SETTINGS.add(SNAP_QUALITY.set("Jpeg quality", 3, 0, 4));
+    SNAPSHOT_SETTINGS.add(SNAP_INTERVAL.set("Auto snapshot mins", 0, 0, 60));
+    snapshot_panel = GUI.addPanel(SNAPSHOT_SETTINGS);
+    
+    ATTRACT_SETTINGS.setName("Attract mode");
+    ATTRACT_SETTINGS.add(ATTRACT.set("Play back when idle", false));
+    ATTRACT_SETTINGS.add(ATTRACT_DELAY.set("Idle secs", 120, 10, 1800));
+    ATTRACT_SETTINGS.add(ATTRACT_SPEED.set("Playback speed", 1.0, 0.25, 8.0));
+    ATTRACT_SETTINGS.add(RECORD_STROKES.set("Record strokes", true));
+    ATTRACT_SETTINGS.add(POWER_SAVE.set("Power save when idle", false));
+    ATTRACT_SETTINGS.add(POWER_SAVE_DELAY.set("Power save secs", 300, 10, 3600));
+    ATTRACT_SETTINGS.add(POWER_SAVE_FPS.set("Power save fps", 30, 5, 60));
+    attract_panel = GUI.addPanel(ATTRACT_SETTINGS);
+    
+    SPARK_SETTINGS.setName("Spark settings");
+    SPARK_SETTINGS.add(SPARKS.set("Laser sparks", false));
+    SPARK_SETTINGS.add(SPARK_AMOUNT.set("Sparks per width", 60, 0, 400));
+    SPARK_SETTINGS.add(SPARK_LIFE.set("Spark life secs", 0.6, 0.1, 2.0));
+    SPARK_SETTINGS.add(SPARK_SIZE.set("Spark size", 6, 1, 32));
+    spark_panel = GUI.addPanel(SPARK_SETTINGS);
+    
+    SCENE_SETTINGS.setName("Scene settings");
+    SCENE_SETTINGS.add(SCENE_ZONE.set("Next scene zone", false));
+    SCENE_SETTINGS.add(SCENE_ZONE_X.set("Zone x pos", 0.9, 0.0, 1.0));
+    SCENE_SETTINGS.add(SCENE_ZONE_Y.set("Zone y pos", 0.0, 0.0, 1.0));
+    SCENE_SETTINGS.add(SCENE_ZONE_W.set("Zone width", 0.1, 0.0, 1.0));
+    SCENE_SETTINGS.add(SCENE_ZONE_H.set("Zone height", 0.1, 0.0, 1.0));
+    SCENE_SETTINGS.add(SCENE_BUDGET.set("Scene gpu mb", SCENE_GPU_BUDGET_MB, 8, 512));
+    SCENE_SETTINGS.add(MURAL.set("Mural mode", false));
+    SCENE_SETTINGS.add(MURAL_STEP.set("Mural pan step", 0.25, 0.05, 1.0));
+    SCENE_SETTINGS.add(MURAL_NEW.set("New mural", false));
+    scene_panel = GUI.addPanel(SCENE_SETTINGS);
+    
     DRIPS_SETTINGS.setName("Drip settings");
     DRIPS_SETTINGS.add(DRIPS.set("Drips enabled", true));
     DRIPS_SETTINGS.add(DRIPS_FREQ.set("Drips freq", 11, 1, 120));
@@ -149,8 +337,27 @@ void appController::loadSettings() {
     TRACKING_SETTINGS.add(MIN_BLOB_SIZE.set("Min blob size", 8, 1, 100));
     TRACKING_SETTINGS.add(ACTIVITY.set("Activity thresh", 10, 0, 100));
     TRACKING_SETTINGS.add(JUMP_DIST.set("Jump dist", 0.610000014, 0.0f, 1.0f));
+    TRACKING_SETTINGS.add(STREAK_FIT.set("Fit fast streaks", true));
+    TRACKING_SETTINGS.add(HALO_GROWTH.set("Halo growth", 0.5, 0.0f, 1.0f));
+    TRACKING_SETTINGS.add(TRACK_THREADS.set("Tracking threads", MAX(1, MIN(16, (int)std::thread::hardware_concurrency())), 1, 16));
     tracking_panel = GUI.addPanel(TRACKING_SETTINGS);
     
+    //a second set of tracking settings tried on the same frames
+    SHADOW_SETTINGS.setName("Shadow tracking");
+    SHADOW_SETTINGS.add(SHADOW.set("Shadow tracker", false));
+    SHADOW_SETTINGS.add(SHADOW_HUE_POINT.set("Shadow hue point", 0.280000001, 0.0f, 1.0f));
+    SHADOW_SETTINGS.add(SHADOW_HUE_WIDTH.set("Shadow hue width", 0.170000002, 0.0f, 1.0f));
+    SHADOW_SETTINGS.add(SHADOW_SAT_POINT.set("Shadow sat threshold", 0.219999999, 0.0f, 1.0f));
+    SHADOW_SETTINGS.add(SHADOW_VAL_POINT.set("Shadow value threshold", 0.160000995, 0.0f, 1.0f));
+    SHADOW_SETTINGS.add(SHADOW_MIN_BLOB_SIZE.set("Shadow min blob size", 8, 1, 100));
+    SHADOW_SETTINGS.add(SHADOW_ACTIVITY.set("Shadow activity thresh", 10, 0, 100));
+    SHADOW_SETTINGS.add(SHADOW_JUMP_DIST.set("Shadow jump dist", 0.610000014, 0.0f, 1.0f));
+    SHADOW_SETTINGS.add(SHADOW_STREAK_FIT.set("Shadow fit streaks", true));
+    SHADOW_SETTINGS.add(SHADOW_HALO_GROWTH.set("Shadow halo growth", 0.5, 0.0f, 1.0f));
+    SHADOW_SETTINGS.add(SHADOW_COPY.set("Copy from live", false));
+    SHADOW_SETTINGS.add(SHADOW_PROMOTE.set("Promote to live", false));
+    shadow_panel = GUI.addPanel(SHADOW_SETTINGS);
+    
     CLEAR_ZONE_SETTINGS.setName("Clear zone settings");
     CLEAR_ZONE_SETTINGS.add(CLEAR_ZONE.set("Use clear zone", 0, 0, 1));
     CLEAR_ZONE_SETTINGS.add(CLEAR_THRESH.set("Clear sensitivty", 1, 1, 9000));
@@ -169,6 +376,9 @@ void appController::loadSettings() {
     NETWORK_SETTINGS.add(IP_PT3.set("ip: xxx.xxx.val.xxx", 1, 0, 255));
     NETWORK_SETTINGS.add(IP_PT4.set("ip: xxx.xxx.xxx.val", 255, 0, 255));
     NETWORK_SETTINGS.add(PORT.set("port", 5544, 0, 65000));
+    NETWORK_SETTINGS.add(DMX_SEND.set("Enable DMX out", false));
+    NETWORK_SETTINGS.add(RECEIVE_OSC.set("Receive OSC", false));
+    NETWORK_SETTINGS.add(RECEIVE_PORT.set("in port", 5545, 0, 65000));
     network_panel = GUI.addPanel(NETWORK_SETTINGS);
     
     MUSIC_SETTINGS.setName("Music player settings");
@@ -183,8 +393,10 @@ void appController::loadSettings() {
     ofVideoGrabber g;
     vector<ofVideoDevice> tempG = g.listDevices();
     CAMERA_SETTINGS.add(CAM_ID.set("Camera", 0, 0, tempG.size()-1));
-    CAMERA_SETTINGS.add(CAM_WIDTH.set("Camera Width", 320, 0, 640));
-    CAMERA_SETTINGS.add(CAM_HEIGHT.set("Camera Height", 240, 0, 480));
+    CAMERA_SETTINGS.add(CAM_WIDTH.set("Camera Width", 320, 0, 1920));
+    CAMERA_SETTINGS.add(CAM_HEIGHT.set("Camera Height", 240, 0, 1080));
+    CAMERA_SETTINGS.add(CAM_MJPEG.set("MJPEG capture (linux)", false));
+    CAMERA_SETTINGS.add(CAM_DECODE_SCALE.set("MJPEG decode 1 / n", 2, 1, 8));
     CAMERA_SETTINGS.add(PROJECTION_W.set("Porjection Width", 1280, 640, 1920));
     CAMERA_SETTINGS.add(PROJECTION_H.set("Porjection Height", 720, 480, 1080));
     camera_panel = GUI.addPanel(CAMERA_SETTINGS);
@@ -194,16 +406,24 @@ void appController::loadSettings() {
     SAVE.set("Save", false);
     LOAD.set("Load", false);
     CLEAR.set("Clear Screen", false);
+    SNAPSHOT.set("Snapshot", false);
     SHOW_CHECKERBOARD.set("Show Checkerboard", false);
     
     save_panel->add(SAVE, ofJson({{"type", "fullsize"}, {"text-align", "center"}}));
     save_panel->add(LOAD, ofJson({{"type", "fullsize"}, {"text-align", "center"}}));
     save_panel->add(SHOW_CHECKERBOARD, ofJson({{"type", "fullsize"}, {"text-align", "center"}}));
     save_panel->add(CLEAR, ofJson({{"type", "fullsize"}, {"text-align", "center"}}));
+    save_panel->add(SNAPSHOT, ofJson({{"type", "fullsize"}, {"text-align", "center"}}));
     
     brush_panel->loadFromFile(ofToDataPath("settings/brush_settings.xml"));
     drip_panel->loadFromFile(ofToDataPath("settings/drip_settings.xml"));
+    lut_panel->loadFromFile(ofToDataPath("settings/lut_settings.xml"));
+    snapshot_panel->loadFromFile(ofToDataPath("settings/snapshot_settings.xml"));
+    attract_panel->loadFromFile(ofToDataPath("settings/attract_settings.xml"));
+    spark_panel->loadFromFile(ofToDataPath("settings/spark_settings.xml"));
+    scene_panel->loadFromFile(ofToDataPath("settings/scene_settings.xml"));
     tracking_panel->loadFromFile(ofToDataPath("settings/tracking_settings.xml"));
+    shadow_panel->loadFromFile(ofToDataPath("settings/shadow_settings.xml"));
     clear_panel->loadFromFile(ofToDataPath("settings/clear_settings.xml"));
     network_panel->loadFromFile(ofToDataPath("settings/network_settings.xml"));
     music_panel->loadFromFile(ofToDataPath("settings/music_settings.xml"));
@@ -222,9 +442,19 @@ void appController::setupListeners(){
     TRACK.addListener(this, &appController::onTrackChange);
     MUSIC.addListener(this, &appController::onMusicChange);
     NETWORK_SEND.addListener(this, &appController::onEnableNetwork);
+    DMX_SEND.addListener(this, &appController::onEnableDmx);
+    RECEIVE_OSC.addListener(this, &appController::onEnableReceive);
+    SNAPSHOT.addListener(this, &appController::onSnapshot);
     SAVE.addListener(this, &appController::onSave);
     LOAD.addListener(this, &appController::onLoad);
     CLEAR.addListener(this, &appController::onClear);
+    MURAL.addListener(this, &appController::onMural);
+    MURAL_NEW.addListener(this, &appController::onMuralNew);
+    LUT_NO.addListener(this, &appController::onLutChange);
+    TRACK_THREADS.addListener(this, &appController::onTrackThreadsChange);
+    ofAddListener(SHADOW_SETTINGS.parameterChangedE(), this, &appController::onShadowChange);
+    SHADOW_COPY.addListener(this, &appController::onShadowCopy);
+    SHADOW_PROMOTE.addListener(this, &appController::onShadowPromote);
 }
 
 void appController::positionGui(){
@@ -246,24 +476,73 @@ void appController::positionGui(){
     music_panel->setShowHeader(false);
     music_panel->setPosition(camera_panel->getWidth(), tracking_panel->getHeight()+clear_panel->getHeight());
     
+    scene_panel->setShowHeader(false);
+    scene_panel->setPosition(camera_panel->getWidth(), tracking_panel->getHeight()+clear_panel->getHeight()+music_panel->getHeight());
+    
+    shadow_panel->setShowHeader(false);
+    shadow_panel->setPosition(camera_panel->getWidth(), tracking_panel->getHeight()+clear_panel->getHeight()+music_panel->getHeight()+scene_panel->getHeight());
+    
     brush_panel->setShowHeader(false);
     brush_panel->setPosition(camera_panel->getWidth()+tracking_panel->getWidth(), 0);
     
     drip_panel->setShowHeader(false);
     drip_panel->setPosition(camera_panel->getWidth()+tracking_panel->getWidth(), brush_panel->getHeight());
+    
+    lut_panel->setShowHeader(false);
+    lut_panel->setPosition(camera_panel->getWidth()+tracking_panel->getWidth()+brush_panel->getWidth(), 0);
+    
+    snapshot_panel->setShowHeader(false);
+    snapshot_panel->setPosition(camera_panel->getWidth()+tracking_panel->getWidth()+brush_panel->getWidth(), lut_panel->getHeight());
+    
+    attract_panel->setShowHeader(false);
+    attract_panel->setPosition(camera_panel->getWidth()+tracking_panel->getWidth()+brush_panel->getWidth(), lut_panel->getHeight()+snapshot_panel->getHeight());
+    
+    spark_panel->setShowHeader(false);
+    spark_panel->setPosition(camera_panel->getWidth()+tracking_panel->getWidth()+brush_panel->getWidth(), lut_panel->getHeight()+snapshot_panel->getHeight()+attract_panel->getHeight());
 }
 
 
 //----------------------------------------------------
 void appController::clearProjectedImage() {
     for (int i = 0; i < NUM_BRUSHES; i++) {
-        brushes[i]->clear();
+        if (brushes[i] != NULL) brushes[i]->clear();
     }
+    
+    sparks_.clear();
+    
+    //a blank wall - no stored scene underneath either
+    scenes_.clearActive();
+    projection_.setSceneTexture(NULL);
+    wall_.clear();
+    
+    //only the part of the mural on the wall
+    if (MURAL) mural_.clearView();
+    
+    //a clear wall is the end of a piece
+    recorder_.endPiece();
+    
+    //attract mode clears don't count
+    if (!bAttract) heatmap_.addClear();
+    
+    bBrushDirty = true;
 }
 
 //----------------------------------------------------
 void appController::mainLoop() {
 
+    if (soakHours > 0) {
+        updateSoakTest();
+    }
+
+    //a camera unplugged or a usb hiccup stops the mjpeg thread -
+    //open it again, and if it keeps going use the grabber instead
+    if(tracker_.hasCameraFailed()){
+        numMjpegFailures++;
+        LT_LOG_WARNING("appController") << "lost the mjpeg camera - "
+            << (numMjpegFailures < MJPEG_MAX_FAILURES ? "opening it again" : "switching to the grabber");
+        bSetupCamera = true;
+    }
+
     if(bSetupCamera){
         setupCamera();
         bSetupCamera = false;
@@ -274,14 +553,64 @@ void appController::mainLoop() {
         bSetupVideo = false;
     }
 
+    //stored walls are swapped in here - between frames
+    //and before anything is painted
+    scenes_.setGpuBudget(SCENE_BUDGET);
+    if (scenes_.update(projection_)) {
+        applyScene();
+    }
+    
+    //the mural moves here too - what was on the wall is baked
+    //into it and the brushes start again over the new view. the
+    //view has to be under the brushes for the bake
+    if (MURAL) {
+        projection_.setSceneTexture(&mural_.getViewTexture());
+    }
+    if (mural_.update(projection_)) {
+        for (int i = 0; i < NUM_BRUSHES; i++) {
+            if (brushes[i] != NULL) brushes[i]->clear();
+        }
+        sparks_.clear();
+        recorder_.endPiece();
+        bBrushDirty = true;
+        setCommonText("status: mural at " + ofToString(mural_.getViewX()) + ", " + ofToString(mural_.getViewY())
+            + " - " + ofToString(mural_.getNumResident()) + " tiles in memory, " + ofToString(mural_.getNumPaged()) + " paged");
+    }
+    
+    //the first frames after startup use everything once behind a
+    //progress bar - nothing is tracked or painted until it is done
+    if (prewarmNum < PREWARM_STEPS) {
+        runPrewarm(prewarmNum++);
+        return;
+    }
+
     //lets find dat laser!
     trackLaser();
 
+    //replay old pieces if nobody is painting
+    manageAttract();
+    
+    //or go quiet if nothing is happening at all
+    managePowerSave();
+    
+    //where and how much people painted
+    heatmap_.addSample(tracker_.laserX, tracker_.laserY, ofGetLastFrameTime(), tracker_.isLaserSeen(), tracker_.newData() && tracker_.isStrokeNew());
+    
+    //remote control over osc
+    handleNetworkReceiving();
+    
     //if sending data is enabled
     //then lets send our data!
     if (SEND_DATA && tracker_.newData()) {
         handleNetworkSending();
     }
+    
+    //the dmx thread sends on its own clock
+    //we just keep it up to date - a laser held still
+    //has no new data but is still drawing
+    if (dmx_.isSetup() && tracker_.isLaserSeen()) {
+        dmx_.setLaserPos(tracker_.laserX, tracker_.laserY, tracker_.newData() && tracker_.isStrokeNew(), tracker_.newData());
+    }
     //this deals with telling our brushes
     //all about the settings that are being
     //changed
@@ -290,11 +619,43 @@ void appController::mainLoop() {
     //this is where we paint
     managePainting();
 
+    //sparks off the laser tip - they are drawn over
+    //the brush in drawProjector
+    if (SPARKS) {
+        sparks_.setSettings(SPARK_AMOUNT, SPARK_LIFE, SPARK_SIZE);
+        sparks_.setBrightness(PROJ_BRIGHTNESS);
+        sparks_.update(ofGetLastFrameTime());
+    }
+    else if (sparks_.getNumAlive() > 0) {
+        sparks_.clear();
+    }
+
     //if you have a crazy bright projector
     //and a weak laser - you might need to dim the
     //projector - this method is for raster brushes
     //for gl brushes we do it in updateBrushSettings
     projection_.setProjectionBrightness(PROJ_BRIGHTNESS);
+    projection_.setColorCorrection(LUT_ENABLED, LUT_GAMMA);
+    
+    //snapshots are read back over a couple of frames
+    //and saved on another thread
+    snapshot_.setFormat(SNAP_JPEG, SNAP_QUALITY);
+    snapshot_.setInterval(SNAP_INTERVAL);
+    snapshot_.update(projection_);
+    string snapshotName;
+    if (snapshot_.getNewSaved(snapshotName)) {
+        setCommonText("status: saved snapshot " + snapshotName);
+    }
+    
+    //the wall goes into shared memory every few frames so
+    //a restart after a crash can bring it back
+    sceneBrushState wallState;
+    wallState.mode   = BRUSH_MODE;
+    wallState.number = BRUSH_NO;
+    wallState.color  = BRUSH_COLOR;
+    wallState.width  = BRUSH_WIDTH;
+    wall_.setBrushState(wallState);
+    wall_.update(projection_);
 
     //this is for the singlescreen mode
     //it will show the current setting for a few seconds
@@ -321,6 +682,66 @@ void appController::setupNetwork() {
     }
 }
 
+//----------------------------------------------------
+void appController::setupTrackingThreads() {
+    
+    //one band per thread - a single thread just runs serially
+    threads_.setup(TRACK_THREADS);
+    tracker_.setThreadPool(&threads_);
+    tracker_.setNumBands(TRACK_THREADS);
+}
+
+//----------------------------------------------------
+void appController::setupDmx() {
+    
+    if (DMX_SEND) {
+        if (dmx_.loadMapping("settings/dmx.xml") && dmx_.setup()) {
+            unsigned char* rgb = colorMgr_.getColor3I();
+            dmx_.setLaserColor(rgb[0], rgb[1], rgb[2]);
+            setCommonText("status: sending " + dmx_.getProtocolName() + " to " + ofToString(dmx_.getNumUniverses()) + " universes");
+        }
+        else {
+            setCommonText("status: dmx setup failed - check settings/dmx.xml");
+        }
+    }
+    else {
+        dmx_.close();
+    }
+}
+
+//----------------------------------------------------
+void appController::setupReceiving() {
+    
+    if (RECEIVE_OSC) {
+        if (receiver_.setup(RECEIVE_PORT)) {
+            setCommonText("status: listening for osc on port " + ofToString(RECEIVE_PORT));
+        }
+        else {
+            setCommonText("status: couldn't listen on port " + ofToString(RECEIVE_PORT));
+        }
+    }
+    else {
+        receiver_.close();
+    }
+}
+
+//----------------------------------------------------
+void appController::handleNetworkReceiving() {
+    ofxOscMessage m;
+    while (receiver_.getNextMessage(m)) {
+        if (m.getAddress() == "/LaserTag/snapshot") {
+            snapshot_.requestSnapshot();
+        }
+        //scenes are numbered from 1 like the keys
+        else if (m.getAddress() == "/LaserTag/scene" && m.getNumArgs() > 0) {
+            recallScene(m.getArgAsInt(0) - 1);
+        }
+        else if (m.getAddress() == "/LaserTag/scene/store" && m.getNumArgs() > 0) {
+            storeScene(m.getArgAsInt(0) - 1);
+        }
+    }
+}
+
 //----------------------------------------------------
 void appController::handleNetworkSending() {
     if (sender_.isSetup()) {
@@ -336,9 +757,44 @@ void appController::trackLaser() {
     tracker_.setUseClearZone(CLEAR_ZONE);
     tracker_.setClearZone(CLEAR_X, CLEAR_Y, CLEAR_W, CLEAR_H);
     tracker_.setClearThreshold(CLEAR_THRESH);
+    tracker_.setStreakFitting(STREAK_FIT);
+    tracker_.setHaloGrowth(HALO_GROWTH);
+    
+    //saving power we only glance at each frame - if there is
+    //a laser we wake up and the same frame gets the full pass
+    if (bPowerSave) {
+        if (!tracker_.scanFrame(HUE_POINT, HUE_WIDTH, SAT_POINT, VAL_POINT, MIN_BLOB_SIZE)) {
+            return;
+        }
+        stopPowerSave();
+    }
     
     //lets process the video data to track that laser
-    tracker_.processFrame(HUE_POINT, HUE_WIDTH, SAT_POINT, VAL_POINT, MIN_BLOB_SIZE, ACTIVITY, JUMP_DIST);
+    if (soakHours > 0) {
+        //a color right in the middle of what we look for - the
+        //tracker's hue is opencv's 0 - 180
+        float hueDeg = MIN(359.0f, HUE_POINT * 255 * 2);
+        soak_.makeFrame(soakFrame, tracker_.QUAD.getScaledQuadPoints(tracker_.W, tracker_.H), ofColor::fromHsb(hueDeg / 360.0f * 255, 255, 255));
+        tracker_.processPixels(soakFrame, HUE_POINT, HUE_WIDTH, SAT_POINT, VAL_POINT, MIN_BLOB_SIZE, ACTIVITY, JUMP_DIST);
+    } else {
+        tracker_.processFrame(HUE_POINT, HUE_WIDTH, SAT_POINT, VAL_POINT, MIN_BLOB_SIZE, ACTIVITY, JUMP_DIST);
+    }
+    
+    //the shadow gets the same frame with its own settings
+    if (SHADOW && tracker_.getLastFrame() != NULL) {
+        trackingConfig config;
+        config.hue        = SHADOW_HUE_POINT;
+        config.hueThresh  = SHADOW_HUE_WIDTH;
+        config.sat        = SHADOW_SAT_POINT;
+        config.value      = SHADOW_VAL_POINT;
+        config.minSize    = SHADOW_MIN_BLOB_SIZE;
+        config.deadCount  = SHADOW_ACTIVITY;
+        config.jumpDist   = SHADOW_JUMP_DIST;
+        config.fitStreaks = SHADOW_STREAK_FIT;
+        config.haloGrowth = SHADOW_HALO_GROWTH;
+        shadow_.setConfig(config);
+        shadow_.submit(*tracker_.getLastFrame(), tracker_.QUAD.getQuadPoints(), tracker_);
+    }
     
     //clear the images if the clear zone is hit
     if (tracker_.isClearZoneHit()) {
@@ -357,6 +813,42 @@ void appController::onCameraChange(bool&b){
     else bSetupVideo = true;
 }
 
+//any change starts the comparison again
+void appController::onShadowChange(ofAbstractParameter & p) {
+    shadow_.resetStats();
+}
+
+void appController::onShadowCopy(bool & b) {
+    if (!SHADOW_COPY) return;
+    SHADOW_COPY = false;
+    SHADOW_HUE_POINT     = HUE_POINT;
+    SHADOW_HUE_WIDTH     = HUE_WIDTH;
+    SHADOW_SAT_POINT     = SAT_POINT;
+    SHADOW_VAL_POINT     = VAL_POINT;
+    SHADOW_MIN_BLOB_SIZE = MIN_BLOB_SIZE;
+    SHADOW_ACTIVITY      = ACTIVITY;
+    SHADOW_JUMP_DIST     = JUMP_DIST;
+    SHADOW_STREAK_FIT    = STREAK_FIT;
+    SHADOW_HALO_GROWTH   = HALO_GROWTH;
+    setCommonText("status: shadow tracker starts from the live settings");
+}
+
+void appController::onShadowPromote(bool & b) {
+    if (!SHADOW_PROMOTE) return;
+    SHADOW_PROMOTE = false;
+    HUE_POINT     = SHADOW_HUE_POINT;
+    HUE_WIDTH     = SHADOW_HUE_WIDTH;
+    SAT_POINT     = SHADOW_SAT_POINT;
+    VAL_POINT     = SHADOW_VAL_POINT;
+    MIN_BLOB_SIZE = SHADOW_MIN_BLOB_SIZE;
+    ACTIVITY      = SHADOW_ACTIVITY;
+    JUMP_DIST     = SHADOW_JUMP_DIST;
+    STREAK_FIT    = SHADOW_STREAK_FIT;
+    HALO_GROWTH   = SHADOW_HALO_GROWTH;
+    shadow_.resetStats();
+    setCommonText("status: shadow tracking settings are live - save to keep them");
+}
+
 void appController::onMusicChange(bool& b) {
     if (MUSIC) {
         player_.unPause();
@@ -370,6 +862,18 @@ void appController::onMusicChange(bool& b) {
 void appController::onTrackChange(int& i) {
     
 }
+
+void appController::onLutChange(int& i) {
+    if (projection_.LUT.selectLut(LUT_NO)) {
+        setCommonText("status: color lut " + projection_.LUT.getLutName());
+    }
+}
+
+//----------------------------------------------------
+void appController::onTrackThreadsChange(int& i) {
+    setupTrackingThreads();
+    setCommonText("status: tracking on " + ofToString(threads_.getNumThreads()) + " threads");
+}
 //----------------------------------------------------
 void appController::manageMusic() {
 
@@ -406,10 +910,15 @@ void appController::manageMusic() {
 //----------------------------------------------------
 void appController::updateBrushSettings(bool first) {
     
+#ifdef LT_LOW_MEMORY
+    selectBrush();
+#endif
+    
     colorMgr_.setCurrentColor(BRUSH_COLOR);
     unsigned char* rgb = colorMgr_.getColor3I();
     
     for (int i = 0; i < NUM_BRUSHES; i++) {
+        if (brushes[i] == NULL) continue;
         brushes[i]->dripsSettings(DRIPS, DRIPS_FREQ, DRIPS_SPEED, DRIP_DIRECTION, DRIP_WIDTH);
         brushes[i]->setBrushWidth(BRUSH_WIDTH);
         if (i == BRUSH_MODE) brushes[i]->setBrushNumber(BRUSH_NO);
@@ -419,6 +928,8 @@ void appController::updateBrushSettings(bool first) {
     }
     
     projection_.setProjectionColor(rgb[0], rgb[1], rgb[2]);
+    sparks_.setColor(rgb[0], rgb[1], rgb[2]);
+    dmx_.setLaserColor(rgb[0], rgb[1], rgb[2]);
 }
 
 //----------------------------------------------------
@@ -428,24 +939,54 @@ void appController::managePainting() {
     //but only if we have got data
     if (tracker_.newData()) {
 
-        float laserX = tracker_.laserX;
-        float laserY = tracker_.laserY;
+        //a fast stroke gives us both ends of its streak
+        const vector<trackedPoint> & points = tracker_.getNewPoints();
 
-        //if our brush is a vector brush we need
-        //to warp the coords as we are not
-        //texture warping
-        if (brushes[BRUSH_MODE]->getIsVector()) {
-            tracker_.getWarpedCoordinates(projection_.getQuadPoints(), &laserX, &laserY);
+        if (RECORD_STROKES) {
+            for (size_t i = 0; i < points.size(); i++) {
+                recorder_.addPoint(points[i].x, points[i].y, i == 0 && tracker_.isStrokeNew(), points[i].timeMs);
+            }
         }
 
-        brushes[BRUSH_MODE]->addPoint(laserX, laserY, tracker_.isStrokeNew());
+        //starting a stroke in the scene zone flips to the next stored wall
+        if (SCENE_ZONE && tracker_.isStrokeNew()
+            && tracker_.laserX >= SCENE_ZONE_X && tracker_.laserX <= SCENE_ZONE_X + SCENE_ZONE_W
+            && tracker_.laserY >= SCENE_ZONE_Y && tracker_.laserY <= SCENE_ZONE_Y + SCENE_ZONE_H) {
+            nextScene();
+        }
+
+        for (size_t i = 0; i < points.size(); i++) {
+            paintPoint(points[i].x, points[i].y, i == 0 && tracker_.isStrokeNew());
+        }
 
         tracker_.clearNewStroke();
     }
+    else if (bAttract) {
+
+        //everything from the log that is due this frame
+        strokeEvent e;
+        while (playback_.getNextEvent(e)) {
+            if (e.flags & STROKE_FLAG_CLEAR) {
+                clearProjectedImage();
+                setCommonText("status: attract mode - playing " + playback_.getCurrentName());
+            }
+            else {
+                paintPoint(e.x, e.y, e.flags & STROKE_FLAG_NEW_STROKE);
+            }
+        }
+    }
 
     //idle our current brush
     for (int i = 0; i < NUM_BRUSHES; i++) {
         if (i == BRUSH_MODE) {
+            
+            //saving power a brush that isn't moving has nothing
+            //new to draw or upload - its last texture still holds
+            if (bPowerSave && !bBrushDirty && !brushes[i]->isAnimating()) {
+                continue;
+            }
+            bBrushDirty = false;
+            
             brushes[i]->update();
 
             //we need to update our brush style
@@ -453,6 +994,14 @@ void appController::managePainting() {
             //of brush styles
 
             BRUSH_NO = brushes[i]->getBrushNumber();
+
+            //brushes can come and go while we run - brushes
+            //that don't say get the old range of 25
+            int numStyles = brushes[i]->getNumBrushStyles();
+            int maxStyle  = numStyles > 0 ? numStyles - 1 : 25;
+            if (BRUSH_NO.getMax() != maxStyle) {
+                BRUSH_NO.setMax(maxStyle);
+            }
         }
     }
 
@@ -461,7 +1010,11 @@ void appController::managePainting() {
     setCommonText("brush: " + brushes[BRUSH_MODE]->getName() + " - " + brushes[BRUSH_MODE]->getDescription());
 
 
-    if (brushes[BRUSH_MODE]->getIsColor()) {
+    ofTexture * reveal = brushes[BRUSH_MODE]->getRevealTexture();
+    if (reveal != NULL) {
+        projection_.setRevealTextures(brushes[BRUSH_MODE]->getTexture(), *reveal);
+    }
+    else if (brushes[BRUSH_MODE]->getIsColor()) {
         projection_.setColorTexture(brushes[BRUSH_MODE]->getTexture());
     }
     else {
@@ -470,6 +1023,109 @@ void appController::managePainting() {
 
 }
 
+//----------------------------------------------------
+void appController::paintPoint(float x, float y, bool newStroke) {
+
+    //sparks live in canvas coords like the raster brushes
+    if (SPARKS) sparks_.addPoint(x, y, newStroke);
+
+    //if our brush is a vector brush we need
+    //to warp the coords as we are not
+    //texture warping
+    if (brushes[BRUSH_MODE]->getIsVector()) {
+        tracker_.warpCoordinates(projection_.getQuadPoints(), x, y, &x, &y);
+    }
+
+    brushes[BRUSH_MODE]->addPoint(x, y, newStroke);
+}
+
+//----------------------------------------------------
+void appController::manageAttract() {
+
+    //a real laser always wins - we stop in the same
+    //frame so it paints on a clean wall
+    if (tracker_.isLaserSeen()) {
+        lastLaserTime = ofGetElapsedTimef();
+        if (bAttract) stopAttract();
+        return;
+    }
+
+    if (bAttract && (!ATTRACT || !playback_.isPlaying())) {
+        stopAttract();
+    }
+    else if (!bAttract && ATTRACT && ofGetElapsedTimef() - lastLaserTime >= ATTRACT_DELAY) {
+        startAttract();
+    }
+
+    if (bAttract) {
+        playback_.setSpeed(ATTRACT_SPEED);
+        playback_.update(ofGetLastFrameTime());
+    }
+}
+
+//----------------------------------------------------
+void appController::managePowerSave() {
+    
+    float now = ofGetElapsedTimef();
+    
+    //attract mode is something to look at so we stay awake.
+    //a scan that woke us for nothing gets a few seconds before
+    //we go back to sleep
+    if (bPowerSave && (!POWER_SAVE || bAttract)) {
+        stopPowerSave();
+    }
+    else if (!bPowerSave && POWER_SAVE && !bAttract
+             && now - lastLaserTime >= POWER_SAVE_DELAY
+             && now - powerWakeTime >= POWER_SAVE_RECHECK) {
+        startPowerSave();
+    }
+    
+    if (bPowerSave && ofGetTargetFrameRate() != POWER_SAVE_FPS) {
+        ofSetFrameRate(POWER_SAVE_FPS);
+    }
+}
+
+//----------------------------------------------------
+void appController::startPowerSave() {
+    bPowerSave = true;
+    ofSetFrameRate(POWER_SAVE_FPS);
+    setCommonText("status: power save - scanning at " + ofToString(POWER_SAVE_FPS) + " fps");
+}
+
+//----------------------------------------------------
+void appController::stopPowerSave() {
+    if (!bPowerSave) return;
+    bPowerSave = false;
+    bBrushDirty = true;
+    powerWakeTime = ofGetElapsedTimef();
+    ofSetFrameRate(60);
+    setCommonText("status: awake");
+}
+
+//----------------------------------------------------
+void appController::startAttract() {
+
+    //look again each time so new pieces get played too
+    recorder_.endPiece();
+    if (playback_.loadFolder(ofToDataPath("strokes/")) > 0 && playback_.start()) {
+        bAttract = true;
+        clearProjectedImage();
+        setCommonText("status: attract mode - playing " + playback_.getCurrentName());
+    }
+    else {
+        //nothing to play - try again after another idle period
+        lastLaserTime = ofGetElapsedTimef();
+    }
+}
+
+//----------------------------------------------------
+void appController::stopAttract() {
+    playback_.stop();
+    clearProjectedImage();
+    bAttract = false;
+    setCommonText("status: attract mode stopped");
+}
+
 //----------------------------------------------------
 void appController::saveSettings() {
     
@@ -477,7 +1133,13 @@ void appController::saveSettings() {
     
     brush_panel->saveToFile(ofToDataPath("settings/brush_settings.xml"));
     drip_panel->saveToFile(ofToDataPath("settings/drip_settings.xml"));
+    lut_panel->saveToFile(ofToDataPath("settings/lut_settings.xml"));
+    snapshot_panel->saveToFile(ofToDataPath("settings/snapshot_settings.xml"));
+    attract_panel->saveToFile(ofToDataPath("settings/attract_settings.xml"));
+    spark_panel->saveToFile(ofToDataPath("settings/spark_settings.xml"));
+    scene_panel->saveToFile(ofToDataPath("settings/scene_settings.xml"));
     tracking_panel->saveToFile(ofToDataPath("settings/tracking_settings.xml"));
+    shadow_panel->saveToFile(ofToDataPath("settings/shadow_settings.xml"));
     clear_panel->saveToFile(ofToDataPath("settings/clear_settings.xml"));
     network_panel->saveToFile(ofToDataPath("settings/network_settings.xml"));
     music_panel->saveToFile(ofToDataPath("settings/music_settings.xml"));
@@ -495,7 +1157,13 @@ void appController::reloadSettings() {
     
     brush_panel->loadFromFile(ofToDataPath("settings/brush_settings.xml"));
     drip_panel->loadFromFile(ofToDataPath("settings/drip_settings.xml"));
+    lut_panel->loadFromFile(ofToDataPath("settings/lut_settings.xml"));
+    snapshot_panel->loadFromFile(ofToDataPath("settings/snapshot_settings.xml"));
+    attract_panel->loadFromFile(ofToDataPath("settings/attract_settings.xml"));
+    spark_panel->loadFromFile(ofToDataPath("settings/spark_settings.xml"));
+    scene_panel->loadFromFile(ofToDataPath("settings/scene_settings.xml"));
     tracking_panel->loadFromFile(ofToDataPath("settings/tracking_settings.xml"));
+    shadow_panel->loadFromFile(ofToDataPath("settings/shadow_settings.xml"));
     clear_panel->loadFromFile(ofToDataPath("settings/clear_settings.xml"));
     network_panel->loadFromFile(ofToDataPath("settings/network_settings.xml"));
     music_panel->loadFromFile(ofToDataPath("settings/music_settings.xml"));
@@ -509,12 +1177,14 @@ void appController::reloadSettings() {
 
 //----------------------------------------------------
 void appController::selectPoint(float x, float y) {
+    stopPowerSave();
     tracker_.QUAD.selectPoint(x, y, noticeImg.getWidth(), 10, 320, 240, 60);
     projection_.selectMiniQuad(x, y, 60);
     projection_.updateMiniQuad(x, y);
 }
 
 void appController::selectPointProjector(float x, float y, float width, float height){
+    stopPowerSave();
     projection_.selectQuad(x, y, 0, 0, width, height, 60);
 }
 
@@ -537,6 +1207,9 @@ void appController::releasePoint() {
 //----------------------------------------------------
 void appController::keyPress(int key) {
     
+    //someone is at the controls
+    stopPowerSave();
+    
     if (key == 's') {
         saveSettings();
     }
@@ -550,11 +1223,26 @@ void appController::keyPress(int key) {
     else if (key == ' ') {
         toggleGui = !toggleGui;
     }
+    else if (key == 'p') {
+        setCommonText("status: taking snapshot");
+        snapshot_.requestSnapshot();
+    }
+    else if (key >= '1' && key < '1' + SCENE_NUM_SLOTS) {
+        recallScene(key - '1');
+    }
+    else if (key >= OF_KEY_F1 && key < OF_KEY_F1 + SCENE_NUM_SLOTS) {
+        storeScene(key - OF_KEY_F1);
+    }
+    else if (key == OF_KEY_LEFT)  panMural(-1, 0);
+    else if (key == OF_KEY_RIGHT) panMural(1, 0);
+    else if (key == OF_KEY_UP)    panMural(0, -1);
+    else if (key == OF_KEY_DOWN)  panMural(0, 1);
     
 }
 
 //----------------------------------------------------
 void appController::keyPressProjector(int key) {
+    stopPowerSave();
     if (key == 'f') {
         ofToggleFullscreen();
         PROJECTION_W = ofGetWindowWidth();
@@ -567,6 +1255,85 @@ void appController::keyPressProjector(int key) {
          setCommonText("status: clearing projection");
          clearProjectedImage();
      }
+    else if (key == 'p') {
+        setCommonText("status: taking snapshot");
+        snapshot_.requestSnapshot();
+    }
+    else if (key >= '1' && key < '1' + SCENE_NUM_SLOTS) {
+        recallScene(key - '1');
+    }
+    else if (key >= OF_KEY_F1 && key < OF_KEY_F1 + SCENE_NUM_SLOTS) {
+        storeScene(key - OF_KEY_F1);
+    }
+    else if (key == OF_KEY_LEFT)  panMural(-1, 0);
+    else if (key == OF_KEY_RIGHT) panMural(1, 0);
+    else if (key == OF_KEY_UP)    panMural(0, -1);
+    else if (key == OF_KEY_DOWN)  panMural(0, 1);
+}
+
+//----------------------------------------------------
+void appController::storeScene(int slot) {
+    if (slot < 0 || slot >= SCENE_NUM_SLOTS) return;
+    
+    sceneBrushState state;
+    state.mode   = BRUSH_MODE;
+    state.number = BRUSH_NO;
+    state.color  = BRUSH_COLOR;
+    state.width  = BRUSH_WIDTH;
+    scenes_.store(slot, state);
+    
+    setCommonText("status: stored scene " + ofToString(slot + 1));
+}
+
+void appController::recallScene(int slot) {
+    if (MURAL) {
+        setCommonText("status: no scenes in mural mode");
+        return;
+    }
+    if (!scenes_.isUsed(slot)) {
+        setCommonText("status: scene " + ofToString(slot + 1) + " is empty");
+        return;
+    }
+    scenes_.recall(slot);
+}
+
+//the next stored scene after the one on the wall
+void appController::nextScene() {
+    if (MURAL) {
+        setCommonText("status: no scenes in mural mode");
+        return;
+    }
+    for (int i = 1; i <= SCENE_NUM_SLOTS; i++) {
+        int slot = (scenes_.getActive() + i + SCENE_NUM_SLOTS) % SCENE_NUM_SLOTS;
+        if (scenes_.isUsed(slot)) {
+            scenes_.recall(slot);
+            return;
+        }
+    }
+}
+
+//moves the wall a step across the mural
+void appController::panMural(int dirX, int dirY) {
+    if (!MURAL) return;
+    mural_.requestPan(dirX * MURAL_STEP * PROJECTION_W, dirY * MURAL_STEP * PROJECTION_H);
+}
+
+//the scene is on the wall - the brushes start again on top of it
+void appController::applyScene() {
+    sceneBrushState state = scenes_.getState(scenes_.getActive());
+    BRUSH_MODE  = state.mode;
+    BRUSH_NO    = state.number;
+    BRUSH_COLOR = state.color;
+    BRUSH_WIDTH = state.width;
+    
+    for (int i = 0; i < NUM_BRUSHES; i++) {
+        if (brushes[i] != NULL) brushes[i]->clear();
+    }
+    sparks_.clear();
+    recorder_.endPiece();
+    bBrushDirty = true;
+    
+    setCommonText("status: scene " + ofToString(scenes_.getActive() + 1));
 }
 
 //----------------------------------------------------
@@ -576,6 +1343,11 @@ void appController::keyRelease(int key) {
 
 //----------------------------------------------------
 void appController::drawProjector() {
+    if (prewarmNum < PREWARM_STEPS) {
+        drawPrewarm();
+        return;
+    }
+    
     ofBackground(0, 0, 0);
     ofPushStyle();
     ofSetColor(255, 255, 255, 255);
@@ -584,6 +1356,12 @@ void appController::drawProjector() {
     
     projection_.drawProjectionTex(0, 0, ofGetWindowWidth(), ofGetWindowHeight());
     
+    if (SPARKS) {
+        projection_.beginProjection(0, 0, ofGetWindowWidth(), ofGetWindowHeight());
+        sparks_.draw(ofGetWindowWidth() / (float)PROJECTION_W);
+        projection_.endProjection();
+    }
+    
     
     if (webMovieLoaded) {
         VP.draw(0, 0, ofGetWindowWidth(), ofGetWindowHeight());
@@ -625,6 +1403,22 @@ void appController::drawGUI() {
 
         drawText("Brush color", 10, 159);
         colorMgr_.drawColorPanel(10, 164, 128, 24, 5);
+
+        drawText("Activity", 10, 215);
+        heatmap_.draw(10, 221, 128, 72);
+        drawText("strokes " + ofToString(heatmap_.getNumStrokes()) + "  clears " + ofToString(heatmap_.getNumClears()), 10, 311);
+        drawText("active " + ofToString(heatmap_.getActiveMinutes(), 1) + " of " + ofToString(heatmap_.getSessionMinutes(), 0) + " mins", 10, 327);
+        drawText("coverage " + ofToString(heatmap_.getCoverage() * 100.0, 0) + "%", 10, 343);
+        
+        if (SHADOW) {
+            shadowStats s = shadow_.getStats();
+            drawText("Shadow tracker", 10, 375);
+            drawText("frames " + ofToString(s.numFrames) + "  skipped " + ofToString(s.numSkipped), 10, 391);
+            drawText("error " + ofToString(s.meanError, 1) + " avg " + ofToString(s.maxError, 1) + " max px", 10, 407);
+            drawText("live only " + ofToString(s.liveOnly) + "  shadow only " + ofToString(s.shadowOnly), 10, 423);
+            drawText("strokes " + ofToString(s.liveStrokes) + " live " + ofToString(s.shadowStrokes) + " shadow", 10, 439);
+            drawText("cost " + ofToString(s.liveMs, 2) + " live " + ofToString(s.shadowMs, 2) + " shadow ms", 10, 455);
+        }
     }
     ofPopMatrix();
 
@@ -641,7 +1435,7 @@ void appController::drawGUI() {
         VP.draw(0, 0, LOGICAL_WIDTH, LOGICAL_HEIGHT);
     }
     ofSetColor(255, 255, 255);
-    ofDrawBitmapString("Drag the second window to your projector screen and press F to go full screen\ns - saves\nr - loads\nd - clears screen\nspacebar - toggles checkerboard\nPlease reference the help guide for more information\n", noticeImg.getWidth()+10, LOGICAL_HEIGHT-noticeImg.getHeight()-16);
+    ofDrawBitmapString("Drag the second window to your projector screen and press F to go full screen\ns - saves\nr - loads\nd - clears screen\np - saves a snapshot\nspacebar - toggles checkerboard\nPlease reference the help guide for more information\n", noticeImg.getWidth()+10, LOGICAL_HEIGHT-noticeImg.getHeight()-16);
 
 
     ofPopStyle();
@@ -649,12 +1443,26 @@ void appController::drawGUI() {
 
 void appController::drawCheckerBoard(){
     
-    int width=ofGetWindowWidth();
-    int height=ofGetWindowHeight();
+    allocateCheckerBoard(ofGetWindowWidth(), ofGetWindowHeight());
+    
+    ofPushMatrix();
+    ofMultMatrix(projection_.matrix);
+    ofSetColor(255, 255, 255);
+    checkerboardFBO.draw(0, 0);
+    ofPopMatrix();
+}
+
+//only drawn again when the projector window changes size
+//----------------------------------------------------
+void appController::allocateCheckerBoard(int width, int height){
+    
+    if (checkerboardFBO.isAllocated() && checkerboardFBO.getWidth() == width && checkerboardFBO.getHeight() == height) {
+        return;
+    }
+    
     int squareSize = 120;
     int counter=0;
     
-    
     checkerboardFBO.allocate(width, height, GL_RGBA);
     checkerboardFBO.begin();
     ofClear(0, 0, 0);
@@ -677,12 +1485,114 @@ void appController::drawCheckerBoard(){
     }
     ofPopStyle();
     checkerboardFBO.end();
+}
+
+//----------------------------------------------------
+void appController::runPrewarm(int step) {
     
-    ofPushMatrix();
-    ofMultMatrix(projection_.matrix);
+    if (step < NUM_BRUSHES) {
+        //every style of every brush paints a short stroke, is
+        //updated, drawn through the projection and cleared again.
+        //with LT_LOW_MEMORY only the one we paint with is there
+        baseBrush * brush = brushes[step];
+        if (brush == NULL) return;
+        
+        setCommonText("status: warming up " + brush->getName());
+        
+        int number = brush->getBrushNumber();
+        int numStyles = MAX(1, brush->getNumBrushStyles());
+        
+        for (int s = 0; s < numStyles; s++) {
+            if (brush->getNumBrushStyles() > 0) brush->setBrushNumber(s);
+            
+            for (int i = 0; i < PREWARM_POINTS; i++) {
+                float x = 0.2 + 0.6 * i / (float)PREWARM_POINTS;
+                float y = 0.5 + 0.2 * sin(i * 0.5);
+                if (brush->getIsVector()) {
+                    tracker_.warpCoordinates(projection_.getQuadPoints(), x, y, &x, &y);
+                }
+                brush->addPoint(x, y, i == 0);
+                brush->update();
+            }
+            
+            ofTexture * reveal = brush->getRevealTexture();
+            if (reveal != NULL) {
+                projection_.setRevealTextures(brush->getTexture(), *reveal);
+            }
+            else if (brush->getIsColor()) {
+                projection_.setColorTexture(brush->getTexture());
+            }
+            else {
+                projection_.setGrayTexture(brush->getTexture());
+            }
+            
+            prewarmFbo.begin();
+            ofClear(0, 0, 0, 255);
+            projection_.drawCanvas(0, 0, PROJECTION_W, PROJECTION_H);
+            prewarmFbo.end();
+        }
+        
+        brush->clear();
+        brush->setBrushNumber(number);
+        bBrushDirty = true;
+    }
+    else if (step == NUM_BRUSHES) {
+        //the projection shaders, sparks and the readback buffers
+        setCommonText("status: warming up buffers");
+        
+        sparks_.addPoint(0.5, 0.5, true);
+        sparks_.update(1.0 / 60.0);
+        
+        prewarmFbo.begin();
+        ofClear(0, 0, 0, 255);
+        projection_.drawProjectionTex(0, 0, PROJECTION_W, PROJECTION_H);
+        projection_.beginProjection(0, 0, PROJECTION_W, PROJECTION_H);
+        sparks_.draw(1.0);
+        projection_.endProjection();
+        prewarmFbo.end();
+        
+        sparks_.clear();
+        snapshot_.prewarm(projection_);
+        wall_.prewarm(projection_);
+    }
+    else {
+        //every glyph we could print once in every font we use
+        setCommonText("status: warming up fonts");
+        
+        string glyphs;
+        for (char c = 32; c < 127; c++) glyphs += c;
+        
+        prewarmFbo.begin();
+        ofClear(0, 0, 0, 255);
+        statusBarFont.drawString(glyphs, 0, 20);
+        drawText(glyphs, 0, 40);
+        tracker_.drawText(glyphs, 0, 60);
+        ofDrawBitmapString(glyphs, 0, 80);
+        prewarmFbo.end();
+        
+        LT_LOG_NOTICE("appController") << "warmed up in " << ofGetElapsedTimeMillis() - prewarmStart << " ms";
+    }
+}
+
+//a bar along the bottom of the wall while we warm up
+//----------------------------------------------------
+void appController::drawPrewarm() {
+    ofBackground(0, 0, 0);
+    
+    //the projector window is current here - the checkerboard
+    //is made at its size now rather than the first time it's shown
+    allocateCheckerBoard(ofGetWindowWidth(), ofGetWindowHeight());
+    
+    float w = ofGetWindowWidth() * 0.5;
+    float x = ofGetWindowWidth() * 0.25;
+    float y = ofGetWindowHeight() - 40;
+    
+    ofPushStyle();
+    ofSetColor(40, 40, 40);
+    ofDrawRectangle(x, y, w, 6);
     ofSetColor(255, 255, 255);
-    checkerboardFBO.draw(0, 0);
-    ofPopMatrix();
+    ofDrawRectangle(x, y, w * prewarmNum / (float)PREWARM_STEPS, 6);
+    ofPopStyle();
 }
 
 
@@ -727,7 +1637,106 @@ void appController::onClear(bool & b){
     clearProjectedImage();
 }
 
+//the wall goes into the mural either way - turned off the wall is
+//blank and the mural waits for it to be turned back on
+void appController::onMural(bool & b){
+    scenes_.clearActive();
+    mural_.requestBake();
+}
+
+//the mural is kept from run to run - this is the only way to a new one
+void appController::onMuralNew(bool & b){
+    if(!MURAL_NEW) return;
+    MURAL_NEW = false;
+    mural_.reset();
+    setCommonText("status: new mural");
+    clearProjectedImage();
+}
+void appController::onSnapshot(bool & b){
+    if(!SNAPSHOT) return;
+    SNAPSHOT = false;
+    setCommonText("status: taking snapshot");
+    snapshot_.requestSnapshot();
+}
+
+//plays the regression scripts through every brush - returns how many failed.
+//bRecord saves the golden images that are missing
+int appController::runBrushRegression(bool bRecord){
+    brushRegression regression;
+    regression.setup(ofToDataPath("regression/"));
+    regression.setRecord(bRecord);
+#ifdef LT_LOW_MEMORY
+    //one brush in memory at a time
+    int failed = 0;
+    for (int i = 0; i < NUM_BRUSHES; i++) {
+        BRUSH_MODE = i;
+        selectBrush();
+        failed += regression.run(&brushes[i], 1);
+    }
+    return failed;
+#else
+    return regression.run(brushes, NUM_BRUSHES);
+#endif
+}
+
+//no camera in a soak - the tracker gets the synthetic laser
+//at the size the camera would be
+void appController::setupSoakSource(){
+    //nothing that waits on people, the clock or the disk
+    ATTRACT        = false;
+    POWER_SAVE     = false;
+    RECORD_STROKES = false;
+    SNAP_INTERVAL  = 0;
+    MUSIC          = false;
+    
+    //loading the settings may have asked for the camera
+    bSetupCamera = false;
+    bSetupVideo  = false;
+    
+    camWidth  = CAM_WIDTH;
+    camHeight = CAM_HEIGHT;
+    tracker_.setupFrameSize(camWidth, camHeight);
+    tracker_.setupCV(ofToDataPath("settings/quad.xml"));
+    soakFrame.allocate(camWidth, camHeight, OF_PIXELS_RGB);
+    
+    soak_.setup(soakHours, ofToDataPath("soak/"));
+}
+
+//once a frame from mainLoop - clears and brush changes in show time
+void appController::updateSoakTest(){
+    soak_.update();
+    
+    int frame = soak_.getFrameNum();
+    if (frame > 0 && frame % (SOAK_CLEAR_SECS * SOAK_FPS) == 0) {
+        clearProjectedImage();
+    }
+    if (frame > 0 && frame % (SOAK_BRUSH_SECS * SOAK_FPS) == 0) {
+        BRUSH_MODE = (BRUSH_MODE + 1) % NUM_BRUSHES;
+    }
+}
+
+bool appController::isSoakDone(){
+    return soakHours > 0 && soak_.isDone();
+}
+
+//writes the samples and checks the trends - returns how many failed
+int appController::finishSoakTest(){
+    soakHours = 0;
+    return soak_.finish();
+}
+
 void appController::exit(){
+    //a clean exit - the next start is a blank wall
+    wall_.remove();
+    mural_.close();
+    shadow_.close();
+    dmx_.close();
+    receiver_.close();
+    snapshot_.close();
+    threads_.close();
+    recorder_.close();
+    playback_.stop();
+    heatmap_.exportSession(ofToDataPath("analytics/"));
     if(MUSIC){
         player_.stop();
     }
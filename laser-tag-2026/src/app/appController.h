@@ -8,14 +8,27 @@
 #include "ofxGuiExtended.h"
 //our other app objects
 #include "laserTracking.h"
+#include "shadowTracker.h"
 #include "laserSending.h"
+#include "dmxSending.h"
+#include "oscReceiving.h"
+#include "canvasSnapshot.h"
+#include "strokeRecorder.h"
+#include "strokePlayback.h"
 #include "imageProjection.h"
 #include "baseGui.h"
 #include "trackPlayer.h"
 #include "colorManager.h"
+#include "activityHeatmap.h"
+#include "sparkParticles.h"
+#include "sceneSlots.h"
+#include "sharedCanvas.h"
+#include "pagedCanvas.h"
+#include "brushRegression.h"
+#include "soakTest.h"
 
 //our brushes
-#define NUM_BRUSHES 4
+#define NUM_BRUSHES 7
 
 #include "baseBrush.h"  	//our base brush class - you must inhereit this to add your own
 #include "basicVectorBrush.h"
@@ -23,8 +36,24 @@
 #include "graffLetter.h" 	//3D Looking bubble letters - by Zachary Lieberman
 #include "vectorBrush.h" 	//openGL brush - different drawing modes - by Theodore Watson
 #include "gestureBrush.h" 	//gesture machine brush - by Zachary Lieberman
+#include "fluidBrush.h" 	//ink in water - stable fluids on a small grid
+#include "reactionBrush.h" 	//reaction diffusion - strokes keep on growing
+#include "revealBrush.h" 	//paints away the wall to show a video underneath
 
 #define STATUS_SHOW_TIME 3000  //in ms - this sets the fade time for the status text 
+#define POWER_SAVE_RECHECK 5   //in secs - awake at least this long after power save ends
+#define PREWARM_POINTS 30      //points painted with each brush style while warming up
+#define PREWARM_STEPS (NUM_BRUSHES + 2)  //a frame per brush, one for gl and buffers, one for fonts
+#define MJPEG_MAX_FAILURES 2   //the mjpeg camera is opened again this many times before we use the grabber
+
+//small boards get a 720p canvas at most
+#ifdef LT_LOW_MEMORY
+#define CANVAS_MAX_W 1280
+#define CANVAS_MAX_H 720
+#else
+#define CANVAS_MAX_W 1920
+#define CANVAS_MAX_H 1080
+#endif
 
 class appController : public baseGui{
     
@@ -35,6 +64,14 @@ public:
     void setup();
     void mainLoop();
     void exit();
+    int runBrushRegression(bool bRecord);
+    void setRestoreWall(bool bRestore);
+
+    //set before setup - hours of synthetic painting run a frame at
+    //a time by mainLoop. the camera is never opened
+    void setSoakTest(float hours);
+    bool isSoakDone();
+    int finishSoakTest();
     void selectPoint(float x, float y);
     void selectPointProjector(float x, float y, float width, float height);
     void dragPoint(float x, float y);
@@ -58,26 +95,71 @@ protected:
     void clearProjectedImage();
     
     void setupNetwork();
+    void setupDmx();
+    void setupReceiving();
+    void setupTrackingThreads();
     void handleNetworkSending();
+    void handleNetworkReceiving();
     void trackLaser();
+    void setupSoakSource();
+    void updateSoakTest();
     void manageMusic();
     void updateBrushSettings(bool first);
     void managePainting();
+    void paintPoint(float x, float y, bool newStroke);
+    void manageAttract();
+    void startAttract();
+    void stopAttract();
+    void managePowerSave();
+    void startPowerSave();
+    void stopPowerSave();
     void drawStatusMessage();
     void drawCheckerBoard();
+    void allocateCheckerBoard(int w, int h);
+    void runPrewarm(int step);
+    void drawPrewarm();
+    void storeScene(int slot);
+    void recallScene(int slot);
+    void nextScene();
+    void applyScene();
+    void panMural(int dirX, int dirY);
     
     ofFbo checkerboardFBO;
+    ofFbo prewarmFbo;
+    int prewarmNum;
+    uint64_t prewarmStart;
     colorManager colorMgr_;
 
     ofVideoPlayer VP;
     bool webMovieLoaded;
 
-    //an array of our base brush class
+    //an array of our base brush class - with LT_LOW_MEMORY
+    //only the one we paint with is made, the rest are NULL
     baseBrush * brushes[NUM_BRUSHES];
+    baseBrush * createBrush(int which);
+    void selectBrush();
+    int activeBrush;
+    int brushW, brushH;
 
     //other stuff
     laserTracking tracker_;
+    shadowTracker shadow_;
+    threadPool    threads_;
     laserSending  sender_;
+    dmxSending    dmx_;
+    oscReceiving  receiver_;
+    canvasSnapshot snapshot_;
+    strokeRecorder recorder_;
+    strokePlayback playback_;
+    activityHeatmap heatmap_;
+    sparkParticles sparks_;
+    sceneSlots     scenes_;
+    sharedCanvas   wall_;
+    pagedCanvas    mural_;
+    bool bRestoreWall;
+    soakTest soak_;
+    float soakHours;
+    ofPixels soakFrame;
     imageProjection projection_;
     trackPlayer player_;
     
@@ -97,6 +179,47 @@ protected:
     ofParameter<int> LINE_RES;
     ofParameter<int> PROJ_BRIGHTNESS;
     
+    ofxGuiPanel* lut_panel;
+    ofParameterGroup LUT_SETTINGS;
+    ofParameter<bool> LUT_ENABLED;
+    ofParameter<int> LUT_NO;
+    ofParameter<float> LUT_GAMMA;
+    
+    ofxGuiPanel* snapshot_panel;
+    ofParameterGroup SNAPSHOT_SETTINGS;
+    ofParameter<bool> SNAP_JPEG;
+    ofParameter<int> SNAP_QUALITY;
+    ofParameter<int> SNAP_INTERVAL;
+    
+    ofxGuiPanel* attract_panel;
+    ofParameterGroup ATTRACT_SETTINGS;
+    ofParameter<bool> ATTRACT;
+    ofParameter<int> ATTRACT_DELAY;
+    ofParameter<float> ATTRACT_SPEED;
+    ofParameter<bool> RECORD_STROKES;
+    ofParameter<bool> POWER_SAVE;
+    ofParameter<int> POWER_SAVE_DELAY;
+    ofParameter<int> POWER_SAVE_FPS;
+    
+    ofxGuiPanel* spark_panel;
+    ofParameterGroup SPARK_SETTINGS;
+    ofParameter<bool> SPARKS;
+    ofParameter<float> SPARK_AMOUNT;
+    ofParameter<float> SPARK_LIFE;
+    ofParameter<float> SPARK_SIZE;
+    
+    ofxGuiPanel* scene_panel;
+    ofParameterGroup SCENE_SETTINGS;
+    ofParameter<bool> SCENE_ZONE;
+    ofParameter<float> SCENE_ZONE_X;
+    ofParameter<float> SCENE_ZONE_Y;
+    ofParameter<float> SCENE_ZONE_W;
+    ofParameter<float> SCENE_ZONE_H;
+    ofParameter<int> SCENE_BUDGET;
+    ofParameter<bool> MURAL;
+    ofParameter<float> MURAL_STEP;
+    ofParameter<bool> MURAL_NEW;
+    
     ofxGuiPanel* drip_panel;
     ofParameterGroup DRIPS_SETTINGS;
     ofParameter<bool> DRIPS;
@@ -114,6 +237,24 @@ protected:
     ofParameter<int> MIN_BLOB_SIZE;
     ofParameter<int> ACTIVITY;
     ofParameter<float> JUMP_DIST;
+    ofParameter<bool> STREAK_FIT;
+    ofParameter<float> HALO_GROWTH;
+    ofParameter<int> TRACK_THREADS;
+    
+    ofxGuiPanel* shadow_panel;
+    ofParameterGroup SHADOW_SETTINGS;
+    ofParameter<bool> SHADOW;
+    ofParameter<float> SHADOW_HUE_POINT;
+    ofParameter<float> SHADOW_HUE_WIDTH;
+    ofParameter<float> SHADOW_SAT_POINT;
+    ofParameter<float> SHADOW_VAL_POINT;
+    ofParameter<int> SHADOW_MIN_BLOB_SIZE;
+    ofParameter<int> SHADOW_ACTIVITY;
+    ofParameter<float> SHADOW_JUMP_DIST;
+    ofParameter<bool> SHADOW_STREAK_FIT;
+    ofParameter<float> SHADOW_HALO_GROWTH;
+    ofParameter<bool> SHADOW_COPY;
+    ofParameter<bool> SHADOW_PROMOTE;
     
     ofxGuiPanel* clear_panel;
     ofParameterGroup CLEAR_ZONE_SETTINGS;
@@ -134,6 +275,9 @@ protected:
     ofParameter<int> IP_PT3;
     ofParameter<int> IP_PT4;
     ofParameter<int> PORT;
+    ofParameter<bool> DMX_SEND;
+    ofParameter<bool> RECEIVE_OSC;
+    ofParameter<int> RECEIVE_PORT;
     
     ofxGuiPanel* music_panel;
     ofParameterGroup MUSIC_SETTINGS;
@@ -147,6 +291,8 @@ protected:
     ofParameter<int> CAM_ID;
     ofParameter<int> CAM_WIDTH;
     ofParameter<int> CAM_HEIGHT;
+    ofParameter<bool> CAM_MJPEG;
+    ofParameter<int> CAM_DECODE_SCALE;
     ofParameter<int> PROJECTION_W;
     ofParameter<int> PROJECTION_H;
     
@@ -154,20 +300,39 @@ protected:
     ofParameter<bool> SAVE;
     ofParameter<bool> LOAD;
     ofParameter<bool> CLEAR;
+    ofParameter<bool> SNAPSHOT;
     ofParameter<bool> SHOW_CHECKERBOARD;
     ofParameter<bool> FULLSCREEN;
     
     bool bSetupCamera;
     bool bSetupVideo;
+    int numMjpegFailures;
+    
+    bool bAttract;
+    float lastLaserTime;
+    
+    bool bPowerSave;
+    bool bBrushDirty;
+    float powerWakeTime;
     
     void onSave(bool & b);
     void onLoad(bool & b);
     void onClear(bool & b);
+    void onMural(bool & b);
+    void onMuralNew(bool & b);
     void onFullScreen(bool & b);
     void onBrushModeChange(int & i);
     void onEnableNetwork(bool & b);
+    void onEnableDmx(bool & b);
+    void onEnableReceive(bool & b);
+    void onSnapshot(bool & b);
     void onMusicChange(bool& b);
     void onTrackChange(int & i);
     void onCameraChange(bool & b);
+    void onLutChange(int & i);
+    void onTrackThreadsChange(int & i);
+    void onShadowChange(ofAbstractParameter & p);
+    void onShadowCopy(bool & b);
+    void onShadowPromote(bool & b);
 };
 #endif
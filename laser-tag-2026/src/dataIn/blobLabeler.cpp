@@ -0,0 +1,303 @@
+#include "blobLabeler.h"
+
+//-----------------------------------------------------
+blobLabeler::blobLabeler(){
+    width    = 0;
+    height   = 0;
+    numBands = 1;
+    nBlobs   = 0;
+}
+
+//-----------------------------------------------------
+void blobLabeler::setup(int w, int h){
+    width  = w;
+    height = h;
+
+    labels.assign(width * height, -1);
+    parent.assign(width * height, 0);
+
+    blobs.clear();
+    nBlobs = 0;
+
+    setNumBands(numBands);
+}
+
+//-----------------------------------------------------
+void blobLabeler::setNumBands(int bands){
+    if(bands < 1) bands = 1;
+
+    //a band needs at least one row
+    if(height > 0 && bands > height) bands = height;
+    numBands = bands;
+
+    bandStart.resize(numBands + 1);
+    for(int b = 0; b <= numBands; b++){
+        bandStart[b] = (height * b) / numBands;
+    }
+
+    bandBlobs.resize(numBands);
+}
+
+int blobLabeler::getNumBands(){
+    return numBands;
+}
+
+//-----------------------------------------------------
+int blobLabeler::findRoot(vector<int> & p, int i){
+    while(p[i] != i){
+        p[i] = p[p[i]];
+        i = p[i];
+    }
+    return i;
+}
+
+//the lowest index always wins so the roots don't
+//depend on the order things get joined in
+//-----------------------------------------------------
+static inline void joinRoots(vector<int> & p, int a, int b){
+    while(p[a] != a) a = p[a] = p[p[a]];
+    while(p[b] != b) b = p[b] = p[p[b]];
+    if(a < b)      p[b] = a;
+    else if(b < a) p[a] = b;
+}
+
+//-----------------------------------------------------
+void blobLabeler::labelBand(int band, const unsigned char * mask){
+
+    int y0 = bandStart[band];
+    int y1 = bandStart[band + 1];
+
+    vector<laserBlob> & found = bandBlobs[band];
+    found.clear();
+
+    //pass 1 - provisional labels are the pixel index
+    //we only look at neighbours inside our own band
+    for(int y = y0; y < y1; y++){
+        int row = y * width;
+        for(int x = 0; x < width; x++){
+            int i = row + x;
+
+            if(mask[i] == 0){
+                labels[i] = -1;
+                continue;
+            }
+
+            labels[i] = i;
+            parent[i] = i;
+
+            if(x > 0 && mask[i - 1]) joinRoots(parent, i, i - 1);
+
+            if(y > y0){
+                int up = i - width;
+                if(x > 0 && mask[up - 1])        joinRoots(parent, i, up - 1);
+                if(mask[up])                     joinRoots(parent, i, up);
+                if(x < width - 1 && mask[up + 1]) joinRoots(parent, i, up + 1);
+            }
+        }
+    }
+
+    //pass 2 - swap in compact ids and add up the stats
+    //the root is the lowest index in its blob so we always
+    //see it before the rest of the blob
+    for(int y = y0; y < y1; y++){
+        int row = y * width;
+        for(int x = 0; x < width; x++){
+            int i = row + x;
+            if(labels[i] < 0) continue;
+
+            int root = findRoot(parent, i);
+            int id;
+
+            if(root == i){
+                id = found.size();
+
+                laserBlob blob;
+                blob.area       = 0;
+                blob.sumX       = 0;
+                blob.sumY       = 0;
+                blob.sumXX      = 0;
+                blob.sumYY      = 0;
+                blob.sumXY      = 0;
+                blob.minX       = x;
+                blob.minY       = y;
+                blob.maxX       = x;
+                blob.maxY       = y;
+                blob.firstIndex = i;
+                blob.centroidX  = 0;
+                blob.centroidY  = 0;
+                blob.axisX      = 1;
+                blob.axisY      = 0;
+                blob.varMajor   = 0;
+                blob.varMinor   = 0;
+                found.push_back(blob);
+            }else{
+                id = labels[root];
+            }
+
+            labels[i] = id;
+
+            laserBlob & blob = found[id];
+            blob.area++;
+            blob.sumX += x;
+            blob.sumY += y;
+            blob.sumXX += x * x;
+            blob.sumYY += y * y;
+            blob.sumXY += x * y;
+            if(x < blob.minX) blob.minX = x;
+            if(x > blob.maxX) blob.maxX = x;
+            if(y > blob.maxY) blob.maxY = y;
+        }
+    }
+}
+
+//-----------------------------------------------------
+void blobLabeler::fillBands(threadPool * pool, const std::function<void(int, int, int)> & fillBand){
+    std::function<void(int)> job = [&](int band){
+        fillBand(band, bandStart[band], bandStart[band + 1]);
+    };
+
+    if(pool != NULL && numBands > 1){
+        pool->parallelFor(numBands, job);
+    }else{
+        for(int b = 0; b < numBands; b++) job(b);
+    }
+}
+
+//-----------------------------------------------------
+int blobLabeler::findBlobs(const unsigned char * mask, int minArea, int maxArea, int maxBlobs, threadPool * pool,
+                           const std::function<void(int, int, int)> & fillBand){
+
+    blobs.clear();
+    nBlobs = 0;
+
+    if(width == 0 || height == 0) return 0;
+
+    std::function<void(int)> job = [&](int band){
+        if(fillBand) fillBand(band, bandStart[band], bandStart[band + 1]);
+        labelBand(band, mask);
+    };
+
+    if(pool != NULL && numBands > 1){
+        pool->parallelFor(numBands, job);
+    }else{
+        for(int b = 0; b < numBands; b++) job(b);
+    }
+
+    //give every band blob a global id
+    vector<int> offset(numBands + 1, 0);
+    for(int b = 0; b < numBands; b++){
+        offset[b + 1] = offset[b] + bandBlobs[b].size();
+    }
+    int total = offset[numBands];
+
+    mergeParent.resize(total);
+    for(int i = 0; i < total; i++) mergeParent[i] = i;
+
+    //join blobs that touch across each band edge
+    for(int b = 1; b < numBands; b++){
+        int y = bandStart[b];
+        int row   = y * width;
+        int above = row - width;
+
+        for(int x = 0; x < width; x++){
+            int id = labels[row + x];
+            if(id < 0) continue;
+            id += offset[b];
+
+            for(int nx = x - 1; nx <= x + 1; nx++){
+                if(nx < 0 || nx >= width) continue;
+                int other = labels[above + nx];
+                if(other >= 0) joinRoots(mergeParent, id, other + offset[b - 1]);
+            }
+        }
+    }
+
+    //add the pieces together - roots come first here too
+    merged.clear();
+    vector<int> mergedIndex(total, -1);
+
+    for(int b = 0; b < numBands; b++){
+        for(int k = 0; k < (int)bandBlobs[b].size(); k++){
+            int g    = offset[b] + k;
+            int root = findRoot(mergeParent, g);
+            const laserBlob & piece = bandBlobs[b][k];
+
+            if(root == g){
+                mergedIndex[g] = merged.size();
+                merged.push_back(piece);
+                continue;
+            }
+
+            laserBlob & blob = merged[mergedIndex[root]];
+            blob.area += piece.area;
+            blob.sumX += piece.sumX;
+            blob.sumY += piece.sumY;
+            blob.sumXX += piece.sumXX;
+            blob.sumYY += piece.sumYY;
+            blob.sumXY += piece.sumXY;
+            blob.minX  = MIN(blob.minX, piece.minX);
+            blob.minY  = MIN(blob.minY, piece.minY);
+            blob.maxX  = MAX(blob.maxX, piece.maxX);
+            blob.maxY  = MAX(blob.maxY, piece.maxY);
+            blob.firstIndex = MIN(blob.firstIndex, piece.firstIndex);
+        }
+    }
+
+    for(int i = 0; i < (int)merged.size(); i++){
+        laserBlob & blob = merged[i];
+        if(blob.area < minArea || blob.area > maxArea) continue;
+
+        blob.centroidX = (float)((double)blob.sumX / blob.area);
+        blob.centroidY = (float)((double)blob.sumY / blob.area);
+
+        //the covariance and its eigenvectors - the big one is the long axis
+        double cx  = (double)blob.sumX / blob.area;
+        double cy  = (double)blob.sumY / blob.area;
+        double cxx = (double)blob.sumXX / blob.area - cx * cx;
+        double cyy = (double)blob.sumYY / blob.area - cy * cy;
+        double cxy = (double)blob.sumXY / blob.area - cx * cy;
+
+        double mid  = (cxx + cyy) * 0.5;
+        double diff = sqrt(MAX(0.0, (cxx - cyy) * (cxx - cyy) * 0.25 + cxy * cxy));
+        double angle = 0.5 * atan2(2.0 * cxy, cxx - cyy);
+
+        blob.varMajor = (float)(mid + diff);
+        blob.varMinor = (float)MAX(0.0, mid - diff);
+        blob.axisX    = (float)cos(angle);
+        blob.axisY    = (float)sin(angle);
+        blobs.push_back(blob);
+    }
+
+    //biggest first - ties go to the one that starts first
+    std::sort(blobs.begin(), blobs.end(), [](const laserBlob & a, const laserBlob & b){
+        if(a.area != b.area) return a.area > b.area;
+        return a.firstIndex < b.firstIndex;
+    });
+
+    if(maxBlobs > 0 && (int)blobs.size() > maxBlobs) blobs.resize(maxBlobs);
+
+    nBlobs = blobs.size();
+    return nBlobs;
+}
+
+//-----------------------------------------------------
+void blobLabeler::draw(float x, float y, float w, float h){
+    if(width == 0 || height == 0) return;
+
+    float sx = w / (float)width;
+    float sy = h / (float)height;
+
+    ofPushStyle();
+    ofNoFill();
+    for(int i = 0; i < nBlobs; i++){
+        laserBlob & blob = blobs[i];
+        ofDrawRectangle(x + blob.minX * sx, y + blob.minY * sy,
+                        (blob.maxX - blob.minX + 1) * sx, (blob.maxY - blob.minY + 1) * sy);
+
+        float cx = x + blob.centroidX * sx;
+        float cy = y + blob.centroidY * sy;
+        ofDrawLine(cx - 3, cy, cx + 3, cy);
+        ofDrawLine(cx, cy - 3, cx, cy + 3);
+    }
+    ofPopStyle();
+}
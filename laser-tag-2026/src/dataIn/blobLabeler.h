@@ -0,0 +1,77 @@
+#ifndef _BLOB_LABELER_H
+#define _BLOB_LABELER_H
+
+#include "ofMain.h"
+#include "threadPool.h"
+
+//finds connected blobs (8 way) in a 0 / 255 mask.
+//
+//the frame is cut into horizontal bands which are labeled in
+//parallel. each band does a classic two pass union-find labeling
+//of its own rows, then a short serial step joins labels that touch
+//across band edges and adds up their stats.
+//
+//all the stats are integer sums so the result is exactly the same
+//for any number of bands - one band is the plain serial version.
+//
+//the second moments give the blob's long axis - a fast laser
+//smears into a streak and the tracker fits a line to it.
+
+typedef struct{
+    int       area;			//in pixels
+    long long sumX, sumY;
+    long long sumXX, sumYY, sumXY;
+    int       minX, minY, maxX, maxY;
+    int       firstIndex;	//first pixel in raster order - used to break ties
+    float     centroidX, centroidY;
+    float     axisX, axisY;			//unit vector along the long axis
+    float     varMajor, varMinor;	//spread along the long and short axis - pixels squared
+}laserBlob;
+
+class blobLabeler{
+
+public:
+
+    blobLabeler();
+
+    void setup(int w, int h);
+    void setNumBands(int bands);
+    int  getNumBands();
+
+    //fillBand(band, y0, y1) is called on the band's own thread
+    //just before it is labeled - use it to build the mask rows
+    //y0 to y1 so they are still in cache
+    //returns the number of blobs - largest first
+    int findBlobs(const unsigned char * mask, int minArea, int maxArea, int maxBlobs, threadPool * pool,
+                  const std::function<void(int, int, int)> & fillBand = nullptr);
+
+    //just the fillBand part - for masks that need more work
+    //between being built and findBlobs()
+    void fillBands(threadPool * pool, const std::function<void(int, int, int)> & fillBand);
+
+    void draw(float x, float y, float w, float h);
+
+    vector<laserBlob> blobs;
+    int nBlobs;
+
+protected:
+
+    void labelBand(int band, const unsigned char * mask);
+    int  findRoot(vector<int> & p, int i);
+
+    int width, height, numBands;
+
+    //per pixel - provisional label then band local compact id, -1 for background
+    vector<int> labels;
+    vector<int> parent;		//union-find over provisional labels (pixel indices)
+
+    //per band results
+    vector<int> bandStart;
+    vector< vector<laserBlob> > bandBlobs;
+
+    //merge step
+    vector<int> mergeParent;
+    vector<laserBlob> merged;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "laserTracking.h"
+#include "asyncLogger.h"
 
 
 static int pnpoly(int npol, float* xp, float* yp, float x, float y)
@@ -15,10 +16,190 @@ static int pnpoly(int npol, float* xp, float* yp, float x, float y)
 }
 
 
+//the hsv window in whole numbers. the pixels are whole numbers so
+//testing against the rounded limits gives exactly what the float
+//tests did. hue can match in up to three ranges because of the wrap
+//---------------------------
+struct hsvWindow {
+	int sMin;
+	int vMin;
+	int numRanges;
+	unsigned char lo[3];
+	unsigned char span[3];
+};
+
+static hsvWindow makeHsvWindow(float hue, float hueThresh, float sat, float value) {
+	float h = hue * 255;
+	float ht = hueThresh * 255;
+	float s = sat * 255;
+	float v = value * 255;
+
+	float hueMax = h + ht * 0.5;
+	float hueMin = h - ht * 0.5;
+
+	hsvWindow w;
+	w.sMin = (int)ceilf(s);
+	w.vMin = (int)ceilf(v);
+	w.numRanges = 0;
+
+	//if saturation is zero then hue doesn't matter
+	float offsets[3] = { 0, 255, -255 };
+	for (int i = 0; i < 3; i++) {
+		int lo = (s == 0 && i == 0) ? 0 : MAX(0, (int)ceilf(hueMin + offsets[i]));
+		int hi = (s == 0 && i == 0) ? 255 : MIN(255, (int)floorf(hueMax + offsets[i]));
+		if (lo > hi) continue;
+		w.lo[w.numRanges] = lo;
+		w.span[w.numRanges] = hi - lo;
+		w.numRanges++;
+	}
+
+	//the row kernel always tests three - repeats don't change anything
+	for (int i = w.numRanges; i < 3 && w.numRanges > 0; i++) {
+		w.lo[i] = w.lo[0];
+		w.span[i] = w.span[0];
+	}
+	return w;
+}
+
+static inline bool inHsvWindow(int h, int s, int v, const hsvWindow & w) {
+	if (s < w.sMin || v < w.vMin) return false;
+	for (int i = 0; i < w.numRanges; i++) {
+		if ((unsigned char)(h - w.lo[i]) <= w.span[i]) return true;
+	}
+	return false;
+}
+
+//one row of hsv pixels to 0 / 255. no branches and no floats so it
+//vectorizes - ld3 on neon, pshufb on x86
+//---------------------------
+static void thresholdRow(const unsigned char * __restrict hsv, unsigned char * __restrict out, int n, const hsvWindow & w) {
+	if (w.numRanges == 0 || w.sMin > 255 || w.vMin > 255) {
+		memset(out, 0, n);
+		return;
+	}
+
+	const unsigned char sMin = w.sMin;
+	const unsigned char vMin = w.vMin;
+	const unsigned char lo0 = w.lo[0], lo1 = w.lo[1], lo2 = w.lo[2];
+	const unsigned char span0 = w.span[0], span1 = w.span[1], span2 = w.span[2];
+
+	for (int x = 0; x < n; x++) {
+		unsigned char h = hsv[x * 3];
+		unsigned char s = hsv[x * 3 + 1];
+		unsigned char v = hsv[x * 3 + 2];
+		unsigned char hueOk = ((unsigned char)(h - lo0) <= span0) | ((unsigned char)(h - lo1) <= span1) | ((unsigned char)(h - lo2) <= span2);
+		out[x] = (hueOk & (s >= sMin) & (v >= vMin)) * 255;
+	}
+}
+
+//the index of every set pixel in a row - most of a row is empty
+//so we skip 8 pixels at a time
+//---------------------------
+static void collectSeeds(const unsigned char * row, int n, int base, vector<int> & seeds) {
+	int x = 0;
+	for (; x + 8 <= n; x += 8) {
+		uint64_t word;
+		memcpy(&word, row + x, 8);
+		if (word == 0) continue;
+		for (int k = 0; k < 8; k++) {
+			if (row[x + k]) seeds.push_back(base + x + k);
+		}
+	}
+	for (; x < n; x++) {
+		if (row[x]) seeds.push_back(base + x);
+	}
+}
+
+//flood fills out from the seeds in the stack into neighbours that
+//pass the loose window. only pixels touching the laser are ever
+//tested so the work goes with the size of the laser, not the frame.
+//pixels that fail are marked 1 so they are only tested once and
+//put back to 0 at the end. returns how many pixels were added -
+//or -1 if it hit maxGrown. then the loose window is flooding the
+//wall and everything it added is taken out again, so only the
+//strict seeds are left for this frame
+//---------------------------
+static int growSeeds(unsigned char * mask, const unsigned char * hsv, int w, int h, const hsvWindow & loose,
+	vector<int> & stack, vector<int> & rejected, vector<int> & added, int maxGrown) {
+
+	int grown = 0;
+
+	while (!stack.empty() && grown < maxGrown) {
+		int i = stack.back();
+		stack.pop_back();
+
+		int x = i % w;
+		int y = i / w;
+
+		for (int ny = MAX(0, y - 1); ny <= MIN(h - 1, y + 1); ny++) {
+			for (int nx = MAX(0, x - 1); nx <= MIN(w - 1, x + 1); nx++) {
+				int n = ny * w + nx;
+				if (mask[n] != 0) continue;
+
+				const unsigned char * p = hsv + n * 3;
+				if (inHsvWindow(p[0], p[1], p[2], loose)) {
+					mask[n] = 255;
+					stack.push_back(n);
+					added.push_back(n);
+					grown++;
+				}
+				else {
+					mask[n] = 1;
+					rejected.push_back(n);
+				}
+			}
+		}
+	}
+
+	for (size_t k = 0; k < rejected.size(); k++) {
+		mask[rejected[k]] = 0;
+	}
+	rejected.clear();
+	stack.clear();
+
+	if (grown >= maxGrown) {
+		for (size_t k = 0; k < added.size(); k++) {
+			mask[added[k]] = 0;
+		}
+		grown = -1;
+	}
+	added.clear();
+
+	return grown;
+}
+
+//how far the dot moved to leave a streak with this spread along and
+//across it. the streak is a capsule - a box as long as the move with
+//half a dot on each end - and the dot size comes from the spread
+//across it. the spread along it only goes up with length so we
+//search for the length that gives it
+//---------------------------
+static float streakLength(float varMajor, float varMinor) {
+	double r  = sqrt(3.0 * varMinor);
+	double r2 = r * r;
+	auto spread = [&](double l) {
+		double box = 2.0 * r * l;
+		double dot = PI * r2;
+		return (box * l * l / 12.0 + dot * (r2 / 4.0 + l * l / 4.0)) / (box + dot);
+	};
+
+	double lo = 0;
+	double hi = 2.0 * sqrt(3.0 * varMajor) + 1.0;
+	if (r <= 0 || spread(lo) >= varMajor) return 0;
+
+	for (int i = 0; i < 24; i++) {
+		double mid = (lo + hi) * 0.5;
+		if (spread(mid) < varMajor) lo = mid;
+		else hi = mid;
+	}
+	return lo;
+}
+
 //---------------------------
 laserTracking::laserTracking() {
 
 	bCameraSetup = false;
+	bMjpegSetup = false;
 	bVideoSetup = false;
 	bCVSetup = false;
 	newStroke = true;
@@ -34,6 +215,13 @@ laserTracking::laserTracking() {
 	oldX = 0;
 	oldY = 0;
 	clearThresh = 6;
+	pool = NULL;
+	scannedFrame = NULL;
+	lastFrame = NULL;
+	processMs = 0;
+	bFitStreaks = true;
+	haloGrowth = 0;
+	lastFrameMs = 0;
 
 }
 
@@ -56,6 +244,18 @@ void laserTracking::setUseClearZone(bool useClearZone) {
 	clearZone.setActive(useClearZone);
 }
 
+//
+//---------------------------
+void laserTracking::setStreakFitting(bool fitStreaks) {
+	bFitStreaks = fitStreaks;
+}
+
+//
+//---------------------------
+void laserTracking::setHaloGrowth(float growth) {
+	haloGrowth = ofClamp(growth, 0, 1);
+}
+
 //---------------------------
 bool laserTracking::isClearZoneHit() {
 	if (shouldClear) {
@@ -69,6 +269,10 @@ bool laserTracking::isClearZoneHit() {
 //requires the app to be restarted - mabe we can change this?
 //---------------------------		
 void laserTracking::setupCamera(int deviceNumber, int width, int height) {
+	if (bMjpegSetup) {
+		MJ.close();
+		bMjpegSetup = false;
+	}
 	VG.setDeviceID(deviceNumber);
 	VG.setup(width, height);
 	VG.setUseTexture(true);
@@ -83,35 +287,73 @@ void laserTracking::setupCamera(int deviceNumber, int width, int height) {
     }
 }
 
+//---------------------------
+bool laserTracking::setupMjpegCamera(int deviceNumber, int width, int height, int scale) {
+	if (bCameraSetup && VG.isInitialized()) {
+		VG.close();
+	}
+	bCameraSetup = false;
+
+	bMjpegSetup = MJ.setup(deviceNumber, width, height, scale);
+	if (!bMjpegSetup) {
+		return false;
+	}
+
+	W = MJ.getWidth();
+	H = MJ.getHeight();
+	noLaserCounter = 0;
+	distDifference = 0.0;
+    if(bVideoSetup){
+        VP.stop();
+        bVideoSetup = false;
+    }
+	return true;
+}
+
 //same as above - from/to using test movies
 //requires a restart
 //---------------------------
 void laserTracking::setupVideo(string videoPath) {
 	// Check if video file exists before loading
 	if (!ofFile::doesFileExist(videoPath)) {
-		ofLogError("laserTracking") << "Video file not found: " << videoPath;
+		LT_LOG_ERROR("laserTracking") << "Video file not found: " << videoPath;
 		bVideoSetup = false;
 		return;
 	}
 
 	bool loaded = VP.load(videoPath);
 	if (!loaded || VP.getWidth() == 0) {
-		ofLogError("laserTracking") << "Failed to load video: " << videoPath;
+		LT_LOG_ERROR("laserTracking") << "Failed to load video: " << videoPath;
 		bVideoSetup = false;
 		return;
 	}
 
+	//no need to keep decoding the camera
+	if (bMjpegSetup) {
+		MJ.close();
+		bMjpegSetup = false;
+	}
+
 	VP.setVolume(0.0f);  // Mute video to prevent audio hardware conflict
 	VP.play();
 	VP.setUseTexture(true);
 	W = VP.getWidth();
 	H = VP.getHeight();
-	cout << "setupVideo" << W << H << endl;
+	LT_LOG_NOTICE("laserTracking") << "setupVideo " << W << "x" << H;
 	bVideoSetup = true;
 	noLaserCounter = 0;
 	distDifference = 0.0;
 }
 
+//no grabber or player - frames are handed to processPixels()
+//---------------------------
+void laserTracking::setupFrameSize(int width, int height) {
+	W = width;
+	H = height;
+	noLaserCounter = 0;
+	distDifference = 0.0;
+}
+
 //good for adjusting the color balance, brightness etc
 //---------------------------		
 void laserTracking::openCameraSettings() {
@@ -129,11 +371,12 @@ void laserTracking::setupCV(string filePath) {
 	WarpedFrame.allocate(W, H);
 	PresenceFrame.allocate(W, H);
     hsvFrame.allocate(W, H);
-	cout << W << " " << H << endl;
+	LT_LOG_NOTICE("laserTracking") << "setupCV " << W << "x" << H;
 	//we do all our tracking at 320 240 - regardless 
 	//of camera size - larger cameras get scaled down to
 	//these dimensions - otherwise 'shit would be slow'
 	pre = new unsigned char[W * H * 3];
+	Blobs.setup(W, H);
 
 	//this is so we can select a sub region of the 
 	//camera image and warp it to full 320 by 240
@@ -186,258 +429,381 @@ void laserTracking::processFrame(float hue, float hueThresh, float sat, float va
 	// Part 1 - get the video data
 	///////////////////////////////////////////////////////////
 
-	//pointer to our incoming video pixels
-	ofPixels pixCam;
-	bool newFrame = false;
+	//the frame scanFrame() just said yes to - or a new one
+	ofPixels * pixCam = scannedFrame != NULL ? scannedFrame : grabFrame();
+	scannedFrame = NULL;
+	lastFrame = pixCam;
+
+	if (pixCam != NULL) {
+		processPixels(*pixCam, hue, hueThresh, sat, value, minSize, deadCount, jumpDist);
+	}
+}
+
+//---------------------------
+bool laserTracking::hasCameraFailed() {
+	return bMjpegSetup && MJ.hasFailed();
+}
+
+//pointer to our incoming video pixels - NULL if nothing new
+//---------------------------
+ofPixels * laserTracking::grabFrame() {
+	ofPixels * pixCam = NULL;
 	//either grab pixels from video or grab from camera
 	if (bVideoSetup) {
 		VP.update();
 		if (VP.isFrameNew() && VP.isLoaded() && VP.getWidth() > 0) {
-			pixCam = VP.getPixels();
-			if (pixCam.isAllocated() && pixCam.getWidth() > 0) {
-				newFrame = true;
-			}
+			pixCam = &VP.getPixels();
+		}
+	}
+	else if (bMjpegSetup) {
+		if (MJ.update()) {
+			pixCam = &MJ.getPixels();
 		}
 	}
 	else if (bCameraSetup) {
 		VG.update();
 		if (VG.isFrameNew() && VG.isInitialized() && VG.getWidth() > 0) {
-			pixCam = VG.getPixels();
-			if (pixCam.isAllocated() && pixCam.getWidth() > 0) {
-				newFrame = true;
-			}
+			pixCam = &VG.getPixels();
 		}
 	}
 
+	if (pixCam != NULL && pixCam->isAllocated() && pixCam->getWidth() > 0 && pixCam->getHeight() > 0) {
+		return pixCam;
+	}
+	return NULL;
+}
+
+//same numbers as opencv's 8 bit rgb to hsv that processPixels
+//thresholds - hue is 0 - 180
+static inline void rgbToHsv8(const unsigned char * p, int & h, int & s, int & v) {
+	int r = p[0];
+	int g = p[1];
+	int b = p[2];
+	int mx = MAX(r, MAX(g, b));
+	int mn = MIN(r, MIN(g, b));
+	int d = mx - mn;
+
+	v = mx;
+	s = mx == 0 ? 0 : (d * 255 + mx / 2) / mx;
+	if (d == 0) {
+		h = 0;
+		return;
+	}
 
+	//in sixths of the circle scaled by d - then to 0 - 180 rounded
+	int num;
+	if (mx == r) num = g - b;
+	else if (mx == g) num = b - r + 2 * d;
+	else num = r - g + 4 * d;
+	if (num < 0) num += 6 * d;
 
-	if (newFrame && pixCam.getWidth() > 0 && pixCam.getHeight() > 0) {
+	h = (num * 60 + d) / (2 * d);
+	if (h >= 180) h -= 180;
+}
 
-		///////////////////////////////////////////////////////////
-		// Part 2 - warp the video based on our quad
-		///////////////////////////////////////////////////////////
+//the raw frame on a sparse grid - no warp, no hsv image, no blobs.
+//it only has to be close, the full pass on the same frame decides
+//---------------------------
+bool laserTracking::scanFrame(float hue, float hueThresh, float sat, float value, int minSize) {
+	scannedFrame = NULL;
+	if (!bCVSetup) {
+		return false;
+	}
 
-		//add to openCV and warp to our dst image
-		VideoFrame.setFromPixels(pixCam);
-		WarpedFrame.warpIntoMe(VideoFrame, QUAD.getScaledQuadPoints(W, H), warpDst);
+	ofPixels * pixCam = grabFrame();
+	if (pixCam == NULL) {
+		return false;
+	}
 
-		//WarpedFrame.wao hsv and search for matching pixels
-		////////////////////////////////////////////////////////////
-		//Get pixels and convert to hue sat and value;
-		hsvFrame = WarpedFrame;
-		hsvFrame.convertRgbToHsv();
+	//can't scan it - let the full pass have a look
+	if ((int)pixCam->getWidth() != W || (int)pixCam->getHeight() != H || pixCam->getNumChannels() != 3) {
+		scannedFrame = pixCam;
+		return true;
+	}
 
+	hsvWindow window = makeHsvWindow(hue, hueThresh, sat, value);
 
-		//okay time to look for our laser!
-		//based on hue sat and val
-		int totalPixels = W * H * 3;
+	ofPoint * pts = QUAD.getScaledQuadPoints(W, H);
+	float ptsx[4] = { pts[0].x, pts[1].x, pts[2].x, pts[3].x };
+	float ptsy[4] = { pts[0].y, pts[1].y, pts[2].y, pts[3].y };
 
-		ofPixels pix = hsvFrame.getPixels();
+	int x0 = ofClamp(MIN(MIN(ptsx[0], ptsx[1]), MIN(ptsx[2], ptsx[3])), 0, W);
+	int x1 = ofClamp(MAX(MAX(ptsx[0], ptsx[1]), MAX(ptsx[2], ptsx[3])), 0, W);
+	int y0 = ofClamp(MIN(MIN(ptsy[0], ptsy[1]), MIN(ptsy[2], ptsy[3])), 0, H);
+	int y1 = ofClamp(MAX(MAX(ptsy[0], ptsy[1]), MAX(ptsy[2], ptsy[3])), 0, H);
 
-		float h = hue * 255;
-		float ht = hueThresh * 255;
-		float s = sat * 255;
-		float v = value * 255;
+	//a blob big enough to count covers about this many grid points
+	int needed = MAX(1, minSize / (TRACK_SCAN_STEP * TRACK_SCAN_STEP));
+	int found = 0;
 
-		//here we figure out what is the max allowed hue 
-		//and the minimum allowed hue. because hue is 
-		//continious we have to make sure we handle what happens 
-		//if hueMax goes over 255
-		//or hueMin goes less than 0
+	const unsigned char * pix = pixCam->getData();
 
-		float hueMax = h + ht * 0.5;
-		float hueMin = h - ht * 0.5;
+	for (int y = y0; y < y1; y += TRACK_SCAN_STEP) {
+		const unsigned char * row = pix + y * W * 3;
+		for (int x = x0; x < x1; x += TRACK_SCAN_STEP) {
 
-		int k = 0;
-		int x = 0;
-		int y = 0;
+			int ph, ps, pv;
+			rgbToHsv8(row + x * 3, ph, ps, pv);
 
-		//our clear zone stuff
-		//back to being able to use any area of the camera
-		//as the clear zone - even if it is outide of the quad
+			if (inHsvWindow(ph, ps, pv, window) && pnpoly(4, ptsx, ptsy, x, y) && ++found >= needed) {
+				scannedFrame = pixCam;
+				return true;
+			}
+		}
+	}
 
-		int   clearCount = 0;
-		bool  clearActive = clearZone.getActive();
-		float clearXMin = clearZone.points[0].x * (float)W;
-		float clearYMin = clearZone.points[0].y * (float)H;
-		float clearXMax = clearZone.points[1].x * (float)W;
-		float clearYMax = clearZone.points[2].y * (float)H;
+	return false;
+}
 
+//---------------------------
+void laserTracking::processPixels(ofPixels & pixCam, float hue, float hueThresh, float sat, float value, int minSize, int deadCount, float jumpDist) {
+	if (!bCVSetup) {
+		return;
+	}
 
+	uint64_t startUs = ofGetElapsedTimeMicros();
 
+	///////////////////////////////////////////////////////////
+	// Part 2 - warp the video based on our quad
+	///////////////////////////////////////////////////////////
 
-		int i, stride;
-		for (int y = clearYMin; y < clearYMax; y++) {
+	//add to openCV and warp to our dst image
+	VideoFrame.setFromPixels(pixCam);
+	WarpedFrame.warpIntoMe(VideoFrame, QUAD.getScaledQuadPoints(W, H), warpDst);
 
-			stride = y * W * 3;
-			for (int x = clearXMin; x < clearXMax; x++) {
+	///////////////////////////////////////////////////////////
+	// Part 3 - convert to hsv and search for matching pixels
+	////////////////////////////////////////////////////////////
 
-				i = stride + x * 3;
+	//Get pixels and convert to hue sat and value;
+	hsvFrame = WarpedFrame;
+	hsvFrame.convertRgbToHsv();
 
-				if (pix[i + 1] >= s && pix[i + 2] >= v) {
+	//okay time to look for our laser!
+	//based on hue sat and val
+	const unsigned char * pix = hsvFrame.getPixels().getData();
 
-					//we do this to check the cases when the
-					//hue min could have wrapped
-					//or the hue max could have wrapped
-					//also if saturation is zero
-					//then hue doesn't matter hence (s == 0)         
-					float pixHue = pix[i];
+	//here we figure out what is the max allowed hue 
+	//and the minimum allowed hue. because hue is 
+	//continious we have to make sure we handle what happens 
+	//if hueMax goes over 255
+	//or hueMin goes less than 0
+	hsvWindow window = makeHsvWindow(hue, hueThresh, sat, value);
 
-					if ((s == 0) || (pixHue >= hueMin && pixHue <= hueMax) ||
-						(pixHue - 255 >= hueMin && pixHue - 255 <= hueMax) ||
-						(pixHue + 255 >= hueMin && pixHue + 255 <= hueMax)) {
+	//the halo around the laser only has to pass this one. a sat
+	//of 0 would let any hue in so it stops just above
+	bool bGrow = haloGrowth > 0;
+	float looseSat = sat > 0 ? MAX(1 / 255.0f, sat * (1 - haloGrowth)) : 0;
+	hsvWindow looseWindow = makeHsvWindow(hue, MIN(1.0f, hueThresh * (1 + haloGrowth)), looseSat, value * (1 - haloGrowth));
 
+	//our clear zone stuff
+	//back to being able to use any area of the camera
+	//as the clear zone - even if it is outide of the quad
 
-						if (clearActive && x > clearXMin && x < clearXMax) {
-							if (y > clearYMin && y < clearYMax) {
-								clearCount++;
-							}
-						}
-					}
-				}
-			}
-		}
+	bool  clearActive = clearZone.getActive();
+	float clearYMin = clearZone.points[0].y * (float)H;
+	float clearYMax = clearZone.points[2].y * (float)H;
 
+	//the columns strictly inside the zone
+	int clearX0 = ofClamp((int)floorf(clearZone.points[0].x * (float)W) + 1, 0, W);
+	int clearX1 = ofClamp((int)ceilf(clearZone.points[1].x * (float)W), 0, W);
 
-		//Get pixels and convert to hue sat and value;
-		hsvFrame = WarpedFrame;
-		hsvFrame.convertRgbToHsv();
-		pix = hsvFrame.getPixels();
+	bandClearCount.assign(Blobs.getNumBands(), 0);
+	bandSeeds.resize(Blobs.getNumBands());
 
-		k = 0;
+	//each band of rows is thresholded right before it is
+	//labeled - the clear zone is counted in the same pass
+	auto thresholdBand = [&](int band, int y0, int y1) {
 
-		for (int i = 0; i < totalPixels; i += 3) {
+		int clearCount = 0;
+		bandSeeds[band].clear();
 
-			float pixHue = pix[i];
+		for (int y = y0; y < y1; y++) {
 
-			if (pix[i + 1] >= s && pix[i + 2] >= v) {
+			unsigned char * row = pre + y * W;
+			thresholdRow(pix + y * W * 3, row, W, window);
 
-				//we do this to check the cases when the
-				//hue min could have wrapped
-				//or the hue max could have wrapped
-				//also if saturation is zero
-				//then hue doesn't matter hence (s == 0)               
-				if ((s == 0) || (pixHue >= hueMin && pixHue <= hueMax) ||
-					(pixHue - 255 >= hueMin && pixHue - 255 <= hueMax) ||
-					(pixHue + 255 >= hueMin && pixHue + 255 <= hueMax)) {
+			if (bGrow) collectSeeds(row, W, y * W, bandSeeds[band]);
 
-					//we have a white pixel
-					pre[k] = 255;
+			if (clearActive && y > clearYMin && y < clearYMax) {
+				for (int x = clearX0; x < clearX1; x++) {
+					clearCount += row[x] != 0;
 				}
-				else pre[k] = 0;
 			}
-			else pre[k] = 0;
-
-			k++;
-		}
-
-		if (clearActive && clearCount >= clearThresh) {
-			shouldClear = true;
 		}
 
-		///////////////////////////////////////////////////////////
-		// Part 4 - find the largest blob of possible candidates 
-		////////////////////////////////////////////////////////////
+		bandClearCount[band] = clearCount;
+	};
 
-		PresenceFrame.setFromPixels(pre, W, H);
+	///////////////////////////////////////////////////////////
+	// Part 4 - find the largest blob of possible candidates 
+	////////////////////////////////////////////////////////////
 
-		//max blob size - our laser shouldn't be bigger
-		//than 20 pixels by 20 pixels right?
-		//so lets make our max blob rpIntoMe(VideoFrame, QUAD.getScaledQuadPoints(W,H), warpDst);
+	int maxSize = 999999999;
 
-		///////////////////////////////////////////////////////////
-		// Part 3 - convert tsize 400
+	if (bGrow) {
+		//the strict pass on every band first - the halo can grow
+		//across band edges so it has to be done before labeling
+		Blobs.fillBands(pool, thresholdBand);
 
-		int maxSize = 999999999;
-		Contour.findContours(PresenceFrame, minSize, maxSize, 150, false, true);
+		growStack.clear();
+		for (int b = 0; b < (int)bandSeeds.size(); b++) {
+			growStack.insert(growStack.end(), bandSeeds[b].begin(), bandSeeds[b].end());
+		}
+		if (growSeeds(pre, pix, W, H, looseWindow, growStack, growRejected, growAdded, W * H * HALO_MAX_GROWN) < 0) {
+			LT_LOG_LIMITED(OF_LOG_NOTICE, "laserTracking") << "the halo grew over " << HALO_MAX_GROWN * 100
+				<< "% of the frame - the loose window is too wide, only the strict pixels are used";
+		}
 
-		///////////////////////////////////////////////////////////
-		// Part 5 - finally calculate our laser coordinates
-		////////////////////////////////////////////////////////////
+		Blobs.findBlobs(pre, minSize, maxSize, 150, pool);
+	}
+	else {
+		Blobs.findBlobs(pre, minSize, maxSize, 150, pool, thresholdBand);
+	}
 
-		//okay so we found some blobs that matched our criteria
-		//we are only really interested in the largest one
-		if (Contour.nBlobs > 0) {
+	int clearCount = 0;
+	for (int i = 0; i < (int)bandClearCount.size(); i++) {
+		clearCount += bandClearCount[i];
+	}
 
-			//get the center pos of the largest blob in 0 - 1 range
-			float tmpX = Contour.blobs[0].centroid.x / (float)W;
-			float tmpY = Contour.blobs[0].centroid.y / (float)H;
+	if (clearActive && clearCount >= clearThresh) {
+		shouldClear = true;
+	}
 
-			ofPoint dst[4];
+	//only for the debug view
+	PresenceFrame.setFromPixels(pre, W, H);
 
-			dst[0].x = 0;
-			dst[0].y = 0;
+	///////////////////////////////////////////////////////////
+	// Part 5 - finally calculate our laser coordinates
+	////////////////////////////////////////////////////////////
+
+	//the points we find get times spread over the
+	//time since the last frame
+	uint64_t nowMs   = ofGetElapsedTimeMillis();
+	uint64_t frameMs = lastFrameMs > 0 ? nowMs - lastFrameMs : 0;
+	lastFrameMs = nowMs;
+
+	//we can only tell which way a streak went if we saw the last frame
+	bool bSeenLast = !newPoints.empty();
+	newPoints.clear();
+
+	//okay so we found some blobs that matched our criteria
+	//we are only really interested in the largest one
+	if (Blobs.nBlobs > 0) {
+		const laserBlob & blob = Blobs.blobs[0];
+
+		//get the center pos of the largest blob in 0 - 1 range
+		float tmpX = blob.centroidX / (float)W;
+		float tmpY = blob.centroidY / (float)H;
+
+		//a fast laser smears into a streak while the shutter is
+		//open - its ends are where the frame started and finished
+		float halfLength = streakLength(blob.varMajor, blob.varMinor) * 0.5f;
+		bool bStreak = bFitStreaks && bSeenLast
+			&& halfLength * 2 >= STREAK_MIN_LENGTH
+			&& blob.varMajor >= STREAK_MIN_RATIO * MAX(blob.varMinor, 0.25f);
+
+		if (bStreak) {
+			float x0 = blob.centroidX - blob.axisX * halfLength;
+			float y0 = blob.centroidY - blob.axisY * halfLength;
+			float x1 = blob.centroidX + blob.axisX * halfLength;
+			float y1 = blob.centroidY + blob.axisY * halfLength;
+
+			//it started at the end nearer to where we last saw it
+			float lastX = laserX * W;
+			float lastY = laserY * H;
+			if (ofDist(x0, y0, lastX, lastY) > ofDist(x1, y1, lastX, lastY)) {
+				std::swap(x0, x1);
+				std::swap(y0, y1);
+			}
 
-			dst[1].x = 1;
-			dst[1].y = 0;
+			trackedPoint start = { ofClamp(x0 / W, 0, 1), ofClamp(y0 / H, 0, 1), nowMs - frameMs / 2 };
+			trackedPoint end   = { ofClamp(x1 / W, 0, 1), ofClamp(y1 / H, 0, 1), nowMs };
+			newPoints.push_back(start);
+			newPoints.push_back(end);
+		}
+		else {
+			trackedPoint p = { tmpX, tmpY, nowMs };
+			newPoints.push_back(p);
+		}
 
-			dst[2].x = 1;
-			dst[2].y = 1;
+		//calculate the horizontal and vertical distance 
+		//between the last point
+		oldX = laserX;
+		oldY = laserY;
 
-			dst[3].x = 0;
-			dst[3].y = 1;
+		distX = newPoints.back().x - laserX;
+		distY = newPoints.back().y - laserY;
 
+		if (distX == 0 && distY == 0)newPos = false;
+		else newPos = true;
 
-			//calculate the horizontal and vertical distance 
-			//between the last point
-			oldX = laserX;
-			oldY = laserY;
+		//for a streak the jump is the gap to its start - not how long it is
+		distDifference = ofDist(newPoints[0].x, newPoints[0].y, laserX, laserY);
 
-			distX = tmpX - laserX;
-			distY = tmpY - laserY;
+		//now update our laser position with this new position
+		noLaserCounter = 0;
+        
+        for (size_t i = 0; i < newPoints.size(); i++) {
+            stroke.addVertex(newPoints[i].x, newPoints[i].y);
+        }
+        ofPoint p = stroke.getVertices()[stroke.getVertices().size()-1];
+        laserX = p.x;
+        laserY = p.y;
 
-			if (distX == 0 && distY == 0)newPos = false;
-			else newPos = true;
+	}
+	else {
+		//we are waiting for a laser!
+		newPos = false;
+		noLaserCounter++;
 
-			distDifference = sqrt(pow(distX, 2) + pow(distY, 2));
+		distX = 0;
+		distY = 0;
+	}
 
-			//now update our laser position with this new position
-			laserX = tmpX;
-			laserY = tmpY;
-			noLaserCounter = 0;
-            
-            stroke.addVertex(laserX, laserY);
-            ofPoint p = stroke.getVertices()[stroke.getVertices().size()-1];
-            laserX = p.x;
-            laserY = p.y;
+	///////////////////////////////////////////////////////////
+	// Part 6 - calculate related variables, smoothing etc
+	////////////////////////////////////////////////////////////
 
-		}
-		else {
-			//we are waiting for a laser!
-			newPos = false;
-			noLaserCounter++;
+	// we need to store if a new stroke has occured
+	// this is so we can no when to start a new line 
+	if (!newStroke) newStroke = (noLaserCounter >= deadCount) || (distDifference >= jumpDist);
 
-			distX = 0;
-			distY = 0;
-		}
+	if (newStroke) {
 
-		///////////////////////////////////////////////////////////
-		// Part 6 - calculate related variables, smoothing etc
-		////////////////////////////////////////////////////////////
+		oldX = laserX;
+		oldY = laserY;
+		smoothPos.x = laserX;
+		smoothPos.y = laserY;
+		distX = 0;
+		distY = 0;
+		smoothVel.x = 0;
+		smoothVel.y = 0;
+        stroke.clear();
 
-		// we need to store if a new stroke has occured
-		// this is so we can no when to start a new line 
-		if (!newStroke) newStroke = (noLaserCounter >= deadCount) || (distDifference >= jumpDist);
+	}
 
-		if (newStroke) {
+	processMs = (ofGetElapsedTimeMicros() - startUs) / 1000.0f;
+}
 
-			oldX = laserX;
-			oldY = laserY;
-			smoothPos.x = laserX;
-			smoothPos.y = laserY;
-			distX = 0;
-			distY = 0;
-			smoothVel.x = 0;
-			smoothVel.y = 0;
-            stroke.clear();
+//---------------------------
+void laserTracking::setThreadPool(threadPool * _pool) {
+	pool = _pool;
+}
 
-		}
-	}
+//---------------------------
+void laserTracking::setNumBands(int bands) {
+	Blobs.setNumBands(bands);
 }
 
 //if you want to warp the coords to another quad
 //-----------------------------------------------------------------------
 void laserTracking::getWarpedCoordinates(ofPoint* dst, float* warpedX, float* warpedY) {
+	warpCoordinates(dst, laserX, laserY, warpedX, warpedY);
+}
+
+//---------------------------
+void laserTracking::warpCoordinates(ofPoint* dst, float x, float y, float* warpedX, float* warpedY) {
 
 	ofPoint srcTmp[4];
 
@@ -455,7 +821,7 @@ void laserTracking::getWarpedCoordinates(ofPoint* dst, float* warpedX, float* wa
 
 
 	CW.calculateMatrix(srcTmp, dst);
-	ofVec2f out = CW.transform(laserX, laserY);
+	ofVec2f out = CW.transform(x, y);
 
 	*warpedX = out.x;
 	*warpedY = out.y;
@@ -467,6 +833,26 @@ bool laserTracking::newData() {
 	return newPos;
 }
 
+//---------------------------
+const vector<trackedPoint> & laserTracking::getNewPoints() {
+	return newPoints;
+}
+
+//---------------------------
+ofPixels * laserTracking::getLastFrame() {
+	return lastFrame;
+}
+
+//---------------------------
+float laserTracking::getProcessMs() {
+	return processMs;
+}
+
+//---------------------------
+bool laserTracking::isLaserSeen() {
+	return Blobs.nBlobs > 0;
+}
+
 //---------------------------
 void laserTracking::clearNewStroke() {
 	newStroke = false;
@@ -573,13 +959,9 @@ void laserTracking::draw(float x, float y) {
 	ofDrawRectangle(320, 0, 320, 240);
 	
 
-	//lets draw the contours to show our blobs!
-	ofPushMatrix();
-	ofTranslate(320, 0, 0);
-	ofScale(320.0 / (float)W, 240.0 / (float)H, 1);
+	//lets draw the blobs we found!
 	ofSetHexColor(0xFF00FF);
-	Contour.draw();
-	ofPopMatrix();
+	Blobs.draw(320, 0, 320, 240);
 
 	if (clearZone.getActive())drawClearZone(0, 0, 320, 240);
 
@@ -8,6 +8,28 @@
 #include "laserUtils.h"
 #include "coordWarping.h"
 #include "hitZone.h"
+#include "blobLabeler.h"
+#include "threadPool.h"
+#include "mjpegCapture.h"
+
+//while scanning for a laser we only look at every nth pixel and row
+#define TRACK_SCAN_STEP 2
+
+//a fast flick smears into a streak while the shutter is open - a
+//blob this much longer than it is wide has a line fitted to it
+#define STREAK_MIN_RATIO    4.0     //long axis spread over short axis spread
+#define STREAK_MIN_LENGTH   6       //in pixels - shorter than this is just a dot
+
+//the halo can grow over at most this much of the frame - a loose
+//setting that floods a wall nearly the laser's color gets no halo
+//at all that frame
+#define HALO_MAX_GROWN      0.1
+
+//a point the tracker found - a streak gives two per frame
+typedef struct{
+    float    x, y;      //0 - 1 like laserX and laserY
+    uint64_t timeMs;    //ofGetElapsedTimeMillis() time - streak ends are spread over the frame
+}trackedPoint;
 
 //inhereits base gui - for status message functionality
 class laserTracking : public baseGui{
@@ -22,16 +44,38 @@ public:
     void setUseClearZone(bool useClearZone);
     bool isClearZoneHit();
     
+    //paint both ends of a streak instead of its middle
+    void setStreakFitting(bool fitStreaks);
+    
+    //pixels that pass the hsv settings are seeds - the laser's halo
+    //grows out from them under a looser window. 0 is off, 1 doubles
+    //the hue width and lets sat and value go down to nearly 0
+    void setHaloGrowth(float growth);
+    
     //changing cameras or switching from/to the camera mode
     //requires the app to be restarted - mabe we can change this?
     //---------------------------
     void setupCamera(int deviceNumber, int width, int height);
     
+    //same again but straight from v4l2 mjpeg - decoded at 1 / scale
+    //of the camera size so W and H are the scaled size. false if
+    //the camera or the build can't do it - use setupCamera then
+    //---------------------------
+    bool setupMjpegCamera(int deviceNumber, int width, int height, int scale);
+
+    //the mjpeg camera stopped sending - set it up again
+    bool hasCameraFailed();
+    
     //same as above - from/to using test movies
     //requires a restart
     //---------------------------
     void setupVideo(string videoPath);
     
+    //no camera or video of our own - frames come in through
+    //processPixels(). call setupCV() after
+    //---------------------------
+    void setupFrameSize(int width, int height);
+    
     //good for adjusting the color balance, brightness etc
     //---------------------------
     void openCameraSettings();
@@ -46,13 +90,47 @@ public:
     //---------------------------
     void processFrame(float hue, float hueThresh, float sat, float value, int minSize, int deadCount, float jumpDist);
     
+    //a cheap look at the new frame for anything laser colored inside
+    //the quad - for when nobody is painting. if it says yes the next
+    //processFrame() works on that same frame instead of a new one
+    //---------------------------
+    bool scanFrame(float hue, float hueThresh, float sat, float value, int minSize);
+    
+    //same as above but for a frame that came from somewhere
+    //else - it has to be the same size as the camera / video
+    //---------------------------
+    void processPixels(ofPixels & pixCam, float hue, float hueThresh, float sat, float value, int minSize, int deadCount, float jumpDist);
+    
+    //the frame processFrame() just worked on - NULL if there
+    //wasn't a new one. good until the next processFrame()
+    ofPixels * getLastFrame();
+    
+    //how long the last processPixels() took
+    float getProcessMs();
+    
+    //thresholding and blob finding is split into bands
+    //of rows which run on the pool - 1 band is serial
+    //---------------------------
+    void setThreadPool(threadPool * pool);
+    void setNumBands(int bands);
+    
     //if you want to warp the coords to another quad - give the four points
     //-----------------------------------------------------------------------
     void getWarpedCoordinates(ofPoint * dst, float *warpedX, float *warpedY);
     
+    //same as above for any point in 0 - 1 tracker coords
+    void warpCoordinates(ofPoint * dst, float x, float y, float *warpedX, float *warpedY);
+    
+    //true if the last frame had a laser in it - even if it didn't move
+    bool isLaserSeen();
+    
     //tells you if new points have arrived
     bool newData();
     
+    //the points from the last frame - oldest first. laserX and
+    //laserY are the last one
+    const vector<trackedPoint> & getNewPoints();
+    
     //tells you if a new stroke has been detected
     bool isStrokeNew();
     
@@ -78,6 +156,7 @@ public:
     
     ofVideoPlayer  	VP;
     ofVideoGrabber 	VG;
+    mjpegCapture	MJ;
     guiQuad			QUAD;
     coordWarping	CW;
     
@@ -94,15 +173,29 @@ public:
     ofxCvColorImage 	WarpedFrame;
     ofxCvColorImage 	hsvFrame;
     ofxCvGrayscaleImage PresenceFrame;
-    ofxCvContourFinder	Contour;
+    blobLabeler			Blobs;
+    threadPool *		pool;
+    vector<int>			bandClearCount;
+    vector< vector<int> > bandSeeds;
+    vector<int>			growStack;
+    vector<int>			growRejected;
+    vector<int>			growAdded;
     
     ofImage				resizeMe;
     
     unsigned char * pre;
+    ofPixels *		scannedFrame;
+    ofPixels *		lastFrame;
+    float			processMs;
     
     string sendStr;
     
-    bool bCameraSetup, bVideoSetup, bCVSetup, newPos, newStroke, shouldClear;
+    bool bCameraSetup, bMjpegSetup, bVideoSetup, bCVSetup, newPos, newStroke, shouldClear;
+    bool bFitStreaks;
+    float haloGrowth;
+    
+    vector<trackedPoint> newPoints;
+    uint64_t lastFrameMs;
     
     int W;
     int H;
@@ -123,6 +216,10 @@ public:
     ofPolyline stroke;
     
     int r0Min, r0Max, g0Min, g0Max, b0Min, b0Max, r1Min, r1Max, g1Min, g1Max, b1Min, b1Max;
+    
+protected:
+    
+    ofPixels * grabFrame();
 };
 
 #endif
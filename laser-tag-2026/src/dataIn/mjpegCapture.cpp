@@ -0,0 +1,319 @@
+#include "mjpegCapture.h"
+#include "asyncLogger.h"
+
+#if defined(TARGET_LINUX) && defined(LT_USE_TURBOJPEG)
+#include <turbojpeg.h>
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+
+//retries when a signal gets in the way
+static int xioctl(int fd, unsigned long request, void * arg){
+    int r;
+    do{
+        r = ioctl(fd, request, arg);
+    }while(r == -1 && errno == EINTR);
+    return r;
+}
+#endif
+
+//-----------------------------------------------------
+mjpegCapture::mjpegCapture(){
+    back       = 0;
+    ready      = 1;
+    front      = 2;
+    bNew       = false;
+    camW       = 0;
+    camH       = 0;
+    outW       = 0;
+    outH       = 0;
+    numDropped = 0;
+    bFailed    = false;
+    bSetup     = false;
+#if defined(TARGET_LINUX) && defined(LT_USE_TURBOJPEG)
+    fd      = -1;
+    decoder = NULL;
+#endif
+}
+
+//-----------------------------------------------------
+mjpegCapture::~mjpegCapture(){
+    close();
+}
+
+#if defined(TARGET_LINUX) && defined(LT_USE_TURBOJPEG)
+
+//-----------------------------------------------------
+bool mjpegCapture::setup(int deviceNumber, int width, int height, int scale){
+    close();
+
+    string device = "/dev/video" + ofToString(deviceNumber);
+    fd = ::open(device.c_str(), O_RDWR | O_NONBLOCK);
+    if(fd < 0){
+        LT_LOG_WARNING("mjpegCapture") << "can't open " << device;
+        return false;
+    }
+
+    v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type                = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width       = width;
+    fmt.fmt.pix.height      = height;
+    fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_MJPEG;
+    fmt.fmt.pix.field       = V4L2_FIELD_ANY;
+
+    if(xioctl(fd, VIDIOC_S_FMT, &fmt) < 0 || fmt.fmt.pix.pixelformat != V4L2_PIX_FMT_MJPEG){
+        LT_LOG_WARNING("mjpegCapture") << device << " doesn't do mjpeg";
+        close();
+        return false;
+    }
+    camW = fmt.fmt.pix.width;
+    camH = fmt.fmt.pix.height;
+
+    //not every driver lets us pick - not a problem if it doesn't
+    v4l2_streamparm parm;
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parm.parm.capture.timeperframe.numerator   = 1;
+    parm.parm.capture.timeperframe.denominator = MJPEG_FPS;
+    xioctl(fd, VIDIOC_S_PARM, &parm);
+
+    v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count  = MJPEG_NUM_BUFFERS;
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if(xioctl(fd, VIDIOC_REQBUFS, &req) < 0 || req.count < 2){
+        LT_LOG_ERROR("mjpegCapture") << "no capture buffers on " << device;
+        close();
+        return false;
+    }
+
+    for(unsigned int i = 0; i < req.count; i++){
+        v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = i;
+        if(xioctl(fd, VIDIOC_QUERYBUF, &buf) < 0){
+            close();
+            return false;
+        }
+
+        mappedBuffer mb;
+        mb.length = buf.length;
+        mb.start  = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buf.m.offset);
+        if(mb.start == MAP_FAILED){
+            LT_LOG_ERROR("mjpegCapture") << "mmap failed on " << device;
+            close();
+            return false;
+        }
+        mapped.push_back(mb);
+
+        if(xioctl(fd, VIDIOC_QBUF, &buf) < 0){
+            close();
+            return false;
+        }
+    }
+
+    //the biggest divisor turbojpeg offers that isn't more than asked for
+    int num = 0;
+    tjscalingfactor * factors = tjGetScalingFactors(&num);
+    tjscalingfactor factor = {1, 1};
+    for(int i = 0; i < num; i++){
+        if(factors[i].num == 1 && factors[i].denom <= MAX(1, scale) && factors[i].denom > factor.denom){
+            factor = factors[i];
+        }
+    }
+    outW = TJSCALED(camW, factor);
+    outH = TJSCALED(camH, factor);
+
+    for(int i = 0; i < 3; i++){
+        buffers[i].allocate(outW, outH, OF_PIXELS_RGB);
+        buffers[i].set(0);
+    }
+    back  = 0;
+    ready = 1;
+    front = 2;
+    bNew  = false;
+    numDropped = 0;
+    bFailed    = false;
+
+    decoder = tjInitDecompress();
+    if(decoder == NULL){
+        LT_LOG_ERROR("mjpegCapture") << "turbojpeg: " << tjGetErrorStr2(NULL);
+        close();
+        return false;
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if(xioctl(fd, VIDIOC_STREAMON, &type) < 0){
+        LT_LOG_ERROR("mjpegCapture") << "can't start streaming " << device;
+        close();
+        return false;
+    }
+
+    LT_LOG_NOTICE("mjpegCapture") << device << " mjpeg " << camW << "x" << camH << " decoding at " << outW << "x" << outH;
+
+    bSetup = true;
+    startThread();
+    return true;
+}
+
+//-----------------------------------------------------
+void mjpegCapture::close(){
+    if(isThreadRunning()){
+        waitForThread(true);
+    }
+
+    if(fd >= 0){
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(fd, VIDIOC_STREAMOFF, &type);
+    }
+    for(auto & mb : mapped){
+        munmap(mb.start, mb.length);
+    }
+    mapped.clear();
+
+    if(fd >= 0){
+        ::close(fd);
+        fd = -1;
+    }
+    if(decoder != NULL){
+        tjDestroy(decoder);
+        decoder = NULL;
+    }
+    bSetup = false;
+}
+
+//-----------------------------------------------------
+void mjpegCapture::threadedFunction(){
+    while(isThreadRunning()){
+
+        //wake up now and then to see if we should stop
+        pollfd pfd;
+        pfd.fd     = fd;
+        pfd.events = POLLIN;
+        if(poll(&pfd, 1, 100) <= 0) continue;
+
+        v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if(xioctl(fd, VIDIOC_DQBUF, &buf) < 0){
+            if(errno != EAGAIN){
+                LT_LOG_ERROR("mjpegCapture") << "lost the camera - errno " << errno;
+                bFailed = true;
+                break;
+            }
+            continue;
+        }
+
+        bool bDecoded = false;
+        if(buf.index < mapped.size() && !(buf.flags & V4L2_BUF_FLAG_ERROR)){
+            bDecoded = decode((const unsigned char *)mapped[buf.index].start, buf.bytesused);
+        }
+
+        //back to the driver as soon as we are done with it
+        xioctl(fd, VIDIOC_QBUF, &buf);
+
+        if(!bDecoded){
+            numDropped++;
+            continue;
+        }
+
+        lock();
+        if(bNew) numDropped++;    //the tracker never saw the last one
+        std::swap(back, ready);
+        bNew = true;
+        unlock();
+    }
+}
+
+//cameras send the odd broken frame - those are dropped, but
+//a warning still gives us a whole picture so we keep it
+//-----------------------------------------------------
+bool mjpegCapture::decode(const unsigned char * jpeg, unsigned long size){
+    if(size == 0) return false;
+
+    int w, h, subsamp, colorspace;
+    if(tjDecompressHeader3(decoder, jpeg, size, &w, &h, &subsamp, &colorspace) < 0) return false;
+    if(w != camW || h != camH) return false;
+
+    int r = tjDecompress2(decoder, jpeg, size, buffers[back].getData(), outW, 0, outH, TJPF_RGB, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE);
+    return r == 0 || tjGetErrorCode(decoder) == TJERR_WARNING;
+}
+
+#else
+
+//-----------------------------------------------------
+bool mjpegCapture::setup(int, int, int, int){
+    LT_LOG_NOTICE("mjpegCapture") << "not built with turbojpeg - using the regular grabber";
+    return false;
+}
+
+void mjpegCapture::close(){
+    bSetup = false;
+}
+
+void mjpegCapture::threadedFunction(){
+}
+
+bool mjpegCapture::decode(const unsigned char *, unsigned long){
+    return false;
+}
+
+#endif
+
+//-----------------------------------------------------
+bool mjpegCapture::isSetup(){
+    return bSetup;
+}
+
+bool mjpegCapture::hasFailed(){
+    return bFailed;
+}
+
+//-----------------------------------------------------
+bool mjpegCapture::update(){
+    if(!bSetup) return false;
+
+    bool bSwapped = false;
+    lock();
+    if(bNew){
+        std::swap(ready, front);
+        bNew = false;
+        bSwapped = true;
+    }
+    unlock();
+    return bSwapped;
+}
+
+ofPixels & mjpegCapture::getPixels(){
+    return buffers[front];
+}
+
+//-----------------------------------------------------
+int mjpegCapture::getCameraWidth(){
+    return camW;
+}
+
+int mjpegCapture::getCameraHeight(){
+    return camH;
+}
+
+int mjpegCapture::getWidth(){
+    return outW;
+}
+
+int mjpegCapture::getHeight(){
+    return outH;
+}
+
+int mjpegCapture::getNumDropped(){
+    return numDropped;
+}
@@ -0,0 +1,83 @@
+#ifndef _MJPEG_CAPTURE_H
+#define _MJPEG_CAPTURE_H
+
+#include "ofMain.h"
+
+//grabs mjpeg straight from a v4l2 camera and decodes it on its own
+//thread with libjpeg-turbo.
+//
+//1080p60 mjpeg is most of a core to decode at full size - but the
+//tracker doesn't need full size. turbojpeg can stop the idct early
+//and hand back 1/2, 1/4 or 1/8 of the image for a fraction of the
+//work, so we decode at the tracking size and skip the resize too.
+//
+//frames are decoded into a back buffer and swapped with the ready
+//one under the lock - update() swaps that to the front so the
+//tracker reads it with no copy. if the tracker is slow we just drop
+//the older frame.
+//
+//only built on linux with LT_USE_TURBOJPEG (config.make turns it on
+//when pkg-config finds libturbojpeg) - everywhere else setup() says
+//no and the tracker uses ofVideoGrabber like before.
+
+#define MJPEG_NUM_BUFFERS   4     //v4l2 mmap buffers
+#define MJPEG_FPS           60    //what we ask for - the driver picks the closest
+
+class mjpegCapture : public ofThread{
+
+public:
+
+    mjpegCapture();
+    ~mjpegCapture();
+
+    //scale is the decode divisor - 1, 2, 4 or 8. anything else
+    //rounds down to the nearest one turbojpeg can do
+    bool setup(int deviceNumber, int width, int height, int scale);
+    void close();
+
+    bool isSetup();
+
+    //the camera went away and our thread stopped - setup() again
+    //or use something else
+    bool hasFailed();
+
+    //true if a new frame was swapped in - then getPixels() has it
+    bool update();
+    ofPixels & getPixels();
+
+    //what the camera sends and what we decode to
+    int getCameraWidth();
+    int getCameraHeight();
+    int getWidth();
+    int getHeight();
+
+    int getNumDropped();
+
+protected:
+
+    void threadedFunction();
+    bool decode(const unsigned char * jpeg, unsigned long size);
+
+    ofPixels buffers[3];
+    int back, ready, front;
+    bool bNew;
+
+    int camW, camH;
+    int outW, outH;
+    std::atomic<int> numDropped;
+    std::atomic<bool> bFailed;
+    bool bSetup;
+
+#if defined(TARGET_LINUX) && defined(LT_USE_TURBOJPEG)
+    struct mappedBuffer{
+        void * start;
+        size_t length;
+    };
+
+    int fd;
+    vector<mappedBuffer> mapped;
+    void * decoder;
+#endif
+};
+
+#endif
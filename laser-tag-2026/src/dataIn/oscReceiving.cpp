@@ -0,0 +1,36 @@
+#include "oscReceiving.h"
+#include "asyncLogger.h"
+
+// ------------------------
+oscReceiving::oscReceiving(){
+    bSetup = false;
+    port = 0;
+}
+
+oscReceiving::~oscReceiving(){
+    close();
+}
+
+//-------------------------
+void oscReceiving::close(){
+    if(bSetup) OSC.stop();
+    bSetup = false;
+}
+
+bool oscReceiving::setup(int port){
+    close();
+    this->port = port;
+    bSetup = OSC.setup(port);
+    if(!bSetup) LT_LOG_ERROR("oscReceiving") << "couldn't listen on port " << port;
+    return bSetup;
+}
+
+bool oscReceiving::isSetup(){
+    return bSetup;
+}
+
+// ------------------------
+bool oscReceiving::getNextMessage(ofxOscMessage & m){
+    if(!bSetup || !OSC.hasWaitingMessages()) return false;
+    return OSC.getNextMessage(m);
+}
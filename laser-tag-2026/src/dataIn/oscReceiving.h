@@ -0,0 +1,33 @@
+#ifndef _OSC_RECEIVING_
+#define _OSC_RECEIVING_
+
+#include "ofMain.h"
+#include "ofxOsc.h"
+
+//remote control - the other half of laserSending.
+//messages are read on the main thread by the app controller
+//which decides what to do with them.
+
+class oscReceiving{
+public:
+    
+    // ------------------------
+    oscReceiving();
+    ~oscReceiving();
+    
+    bool setup(int port);
+    
+    void close();
+    
+    bool isSetup();
+    
+    //call until it returns false - once per frame
+    bool getNextMessage(ofxOscMessage & m);
+    
+protected:
+    bool bSetup;
+    int  port;
+    ofxOscReceiver OSC;
+};
+
+#endif
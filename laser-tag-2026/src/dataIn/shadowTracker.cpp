@@ -0,0 +1,168 @@
+#include "shadowTracker.h"
+#include "asyncLogger.h"
+
+//-----------------------------------------------------
+shadowTracker::shadowTracker(){
+    numInFlight = 0;
+
+    config.hue        = 0;
+    config.hueThresh  = 0;
+    config.sat        = 0;
+    config.value      = 0;
+    config.minSize    = 1;
+    config.deadCount  = 10;
+    config.jumpDist   = 1;
+    config.fitStreaks = false;
+    config.haloGrowth = 0;
+
+    resetStats();
+}
+
+shadowTracker::~shadowTracker(){
+    close();
+}
+
+//-----------------------------------------------------
+void shadowTracker::setup(string _quadFile){
+    quadFile = _quadFile;
+
+    //the worker has no gl context - nothing of ours gets drawn
+    tracker.VideoFrame.setUseTexture(false);
+    tracker.WarpedFrame.setUseTexture(false);
+    tracker.hsvFrame.setUseTexture(false);
+    tracker.PresenceFrame.setUseTexture(false);
+
+    resetStats();
+    if(!isThreadRunning()) startThread();
+}
+
+//-----------------------------------------------------
+void shadowTracker::close(){
+    if(isThreadRunning()){
+        toTrack.close();
+        waitForThread(false);
+    }
+}
+
+bool shadowTracker::isSetup(){
+    return isThreadRunning();
+}
+
+//-----------------------------------------------------
+void shadowTracker::setConfig(const trackingConfig & _config){
+    config = _config;
+}
+
+//-----------------------------------------------------
+void shadowTracker::submit(const ofPixels & frame, ofPoint * quad, laserTracking & live){
+    if(!isThreadRunning()) return;
+
+    //never queue up behind ourselves
+    if(numInFlight > 0){
+        lock();
+        stats.numSkipped++;
+        unlock();
+        return;
+    }
+
+    shadowJob job;
+    if(!recycled.tryReceive(job.pixels) || job.pixels.getWidth() != frame.getWidth() || job.pixels.getHeight() != frame.getHeight()){
+        job.pixels.allocate(frame.getWidth(), frame.getHeight(), frame.getPixelFormat());
+    }
+    memcpy(job.pixels.getData(), frame.getData(), frame.size());
+
+    for(int i = 0; i < 4; i++) job.quad[i] = quad[i];
+    job.config        = config;
+    job.liveSeen      = live.isLaserSeen();
+    job.liveNewStroke = live.newData() && live.isStrokeNew();
+    job.liveX         = live.laserX;
+    job.liveY         = live.laserY;
+    job.liveMs        = live.getProcessMs();
+
+    numInFlight++;
+    toTrack.send(std::move(job));
+}
+
+//-----------------------------------------------------
+shadowStats shadowTracker::getStats(){
+    lock();
+    shadowStats s = stats;
+    unlock();
+    return s;
+}
+
+void shadowTracker::resetStats(){
+    lock();
+    memset(&stats, 0, sizeof(stats));
+    sumError    = 0;
+    sumLiveMs   = 0;
+    sumShadowMs = 0;
+    unlock();
+}
+
+//-----------------------------------------------------
+void shadowTracker::threadedFunction(){
+
+    shadowJob job;
+    int trackW = 0;
+    int trackH = 0;
+
+    while(toTrack.receive(job)){
+
+        //first frame or the camera changed size
+        int w = job.pixels.getWidth();
+        int h = job.pixels.getHeight();
+        if(w != trackW || h != trackH){
+            tracker.setupFrameSize(w, h);
+            tracker.setupCV(quadFile);
+            trackW = w;
+            trackH = h;
+            LT_LOG_NOTICE("shadowTracker") << "shadowing " << w << "x" << h;
+        }
+
+        const trackingConfig & c = job.config;
+        tracker.QUAD.setQuadPoints(job.quad);
+        tracker.setStreakFitting(c.fitStreaks);
+        tracker.setHaloGrowth(c.haloGrowth);
+        tracker.processPixels(job.pixels, c.hue, c.hueThresh, c.sat, c.value, c.minSize, c.deadCount, c.jumpDist);
+
+        compare(job);
+
+        //nobody paints our points - we clear the flag like the app does
+        if(tracker.newData()) tracker.clearNewStroke();
+
+        recycled.send(std::move(job.pixels));
+        numInFlight--;
+    }
+}
+
+//-----------------------------------------------------
+void shadowTracker::compare(const shadowJob & job){
+    bool shadowSeen      = tracker.isLaserSeen();
+    bool shadowNewStroke = tracker.newData() && tracker.isStrokeNew();
+
+    lock();
+
+    stats.numFrames++;
+    if(job.liveNewStroke) stats.liveStrokes++;
+    if(shadowNewStroke)   stats.shadowStrokes++;
+
+    if(job.liveSeen && shadowSeen){
+        float error = ofDist(job.liveX * tracker.W, job.liveY * tracker.H, tracker.laserX * tracker.W, tracker.laserY * tracker.H);
+        stats.numBothSeen++;
+        sumError += error;
+        stats.meanError = sumError / stats.numBothSeen;
+        stats.maxError  = MAX(stats.maxError, error);
+    }else if(job.liveSeen){
+        stats.liveOnly++;
+    }else if(shadowSeen){
+        stats.shadowOnly++;
+    }
+
+    sumLiveMs   += job.liveMs;
+    sumShadowMs += tracker.getProcessMs();
+    stats.liveMs   = sumLiveMs / stats.numFrames;
+    stats.shadowMs = sumShadowMs / stats.numFrames;
+
+    unlock();
+}
@@ -0,0 +1,87 @@
+#ifndef _SHADOW_TRACKER_H
+#define _SHADOW_TRACKER_H
+
+#include "ofMain.h"
+#include "laserTracking.h"
+
+//a second tracker that follows the live one on its own thread so a
+//new set of tracking settings can be tried on the real wall without
+//touching the show.
+//
+//every frame the live tracker works on is copied over with what the
+//live tracker found. the shadow tracks it with its own settings on a
+//spare core - nothing it finds is painted - and adds up how far apart
+//the two were. if it is still busy with the last frame the new one is
+//skipped so it never holds the live tracker up.
+//
+//the shadow is single threaded - its cost is only comparable with the
+//live one when that runs with one tracking thread too.
+
+struct trackingConfig{
+    float hue, hueThresh, sat, value;
+    int   minSize, deadCount;
+    float jumpDist;
+    bool  fitStreaks;
+    float haloGrowth;
+};
+
+struct shadowStats{
+    int   numFrames;        //frames both trackers did
+    int   numSkipped;       //frames the shadow was too busy for
+    int   numBothSeen;
+    int   liveOnly;         //live saw a laser - the shadow didn't
+    int   shadowOnly;       //the other way round
+    int   liveStrokes, shadowStrokes;
+    float meanError, maxError;  //in camera pixels - when both saw it
+    float liveMs, shadowMs;     //mean time per frame
+};
+
+class shadowTracker : public ofThread{
+
+public:
+
+    shadowTracker();
+    ~shadowTracker();
+
+    void setup(string quadFile);
+    void close();
+    bool isSetup();
+
+    void setConfig(const trackingConfig & config);
+
+    //a frame the live tracker just did - quad is its four 0 - 1 points
+    void submit(const ofPixels & frame, ofPoint * quad, laserTracking & live);
+
+    shadowStats getStats();
+    void resetStats();
+
+protected:
+
+    struct shadowJob{
+        ofPixels pixels;
+        ofPoint  quad[4];
+        trackingConfig config;
+        bool  liveSeen, liveNewStroke;
+        float liveX, liveY;
+        float liveMs;
+    };
+
+    void threadedFunction();
+    void compare(const shadowJob & job);
+
+    //only touched by the worker
+    laserTracking tracker;
+
+    string quadFile;
+    trackingConfig config;
+
+    ofThreadChannel<shadowJob> toTrack;
+    ofThreadChannel<ofPixels>  recycled;
+    std::atomic<int> numInFlight;
+
+    //under the lock
+    shadowStats stats;
+    double sumError, sumLiveMs, sumShadowMs;
+};
+
+#endif
@@ -0,0 +1,237 @@
+#include "strokePlayback.h"
+#include "asyncLogger.h"
+
+#ifdef TARGET_WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//-----------------------------------------------------
+strokePlayback::strokePlayback(){
+    currentLog = -1;
+
+    data = NULL;
+    size = 0;
+#ifdef TARGET_WIN32
+    fileHandle = NULL;
+    mapHandle  = NULL;
+#else
+    fd = -1;
+#endif
+
+    cursor      = 0;
+    playTime    = 0;
+    timeOffset  = 0;
+    lastTime    = 0;
+    bFirstEvent = true;
+
+    speed    = 1.0;
+    holdTime = 0;
+}
+
+strokePlayback::~strokePlayback(){
+    stop();
+}
+
+//-----------------------------------------------------
+int strokePlayback::loadFolder(string folder){
+
+    ofDirectory dir;
+    dir.allowExt(STROKE_LOG_EXTENSION);
+    dir.listDir(folder);
+    dir.sort();
+
+    logs.clear();
+    for(int i = 0; i < (int)dir.size(); i++){
+        logs.push_back(dir.getPath(i));
+    }
+
+    if(currentLog >= (int)logs.size()) currentLog = -1;
+    return logs.size();
+}
+
+int strokePlayback::getNumLogs(){
+    return logs.size();
+}
+
+//-----------------------------------------------------
+bool strokePlayback::start(){
+
+    //try each log once - bad ones are skipped
+    for(int i = 0; i < (int)logs.size(); i++){
+        currentLog = (currentLog + 1) % logs.size();
+        if(openLog(currentLog)) return true;
+    }
+    return false;
+}
+
+void strokePlayback::stop(){
+    closeLog();
+}
+
+bool strokePlayback::isPlaying(){
+    return data != NULL;
+}
+
+void strokePlayback::setSpeed(float _speed){
+    speed = MAX(_speed, 0.01);
+}
+
+string strokePlayback::getCurrentName(){
+    if(currentLog < 0 || currentLog >= (int)logs.size()) return "";
+    return ofFilePath::getFileName(logs[currentLog]);
+}
+
+//-----------------------------------------------------
+bool strokePlayback::openLog(int which){
+
+    closeLog();
+
+    string path = ofToDataPath(logs[which], true);
+    const void * mapped = NULL;
+    size_t mappedSize = 0;
+
+#ifdef TARGET_WIN32
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if(f == INVALID_HANDLE_VALUE){
+        LT_LOG_ERROR("strokePlayback") << "couldn't open " << path;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(f, &fileSize);
+    mappedSize = (size_t)fileSize.QuadPart;
+
+    HANDLE m = mappedSize > 0 ? CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    if(m != NULL) mapped = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+
+    if(mapped == NULL){
+        if(m != NULL) CloseHandle(m);
+        CloseHandle(f);
+        LT_LOG_ERROR("strokePlayback") << "couldn't map " << path;
+        return false;
+    }
+    fileHandle = f;
+    mapHandle  = m;
+#else
+    int f = open(path.c_str(), O_RDONLY);
+    if(f < 0){
+        LT_LOG_ERROR("strokePlayback") << "couldn't open " << path;
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(f, &st) == 0) mappedSize = st.st_size;
+
+    if(mappedSize > 0){
+        mapped = mmap(NULL, mappedSize, PROT_READ, MAP_PRIVATE, f, 0);
+        if(mapped == MAP_FAILED) mapped = NULL;
+    }
+
+    if(mapped == NULL){
+        ::close(f);
+        LT_LOG_ERROR("strokePlayback") << "couldn't map " << path;
+        return false;
+    }
+
+    //we only ever read forwards
+    madvise((void *)mapped, mappedSize, MADV_SEQUENTIAL);
+    fd = f;
+#endif
+
+    data = (const unsigned char *)mapped;
+    size = mappedSize;
+
+    uint32_t version = 0;
+    if(size >= STROKE_LOG_HEADER_SIZE) memcpy(&version, data + 4, 4);
+
+    if(size < STROKE_LOG_HEADER_SIZE || memcmp(data, STROKE_LOG_MAGIC, 4) != 0 || version != STROKE_LOG_VERSION){
+        LT_LOG_ERROR("strokePlayback") << "not a stroke log " << path;
+        closeLog();
+        return false;
+    }
+
+    cursor      = STROKE_LOG_HEADER_SIZE;
+    playTime    = 0;
+    timeOffset  = 0;
+    lastTime    = 0;
+    bFirstEvent = true;
+    holdTime    = 0;
+    return true;
+}
+
+//-----------------------------------------------------
+void strokePlayback::closeLog(){
+    if(data == NULL) return;
+
+#ifdef TARGET_WIN32
+    UnmapViewOfFile(data);
+    CloseHandle((HANDLE)mapHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mapHandle  = NULL;
+    fileHandle = NULL;
+#else
+    munmap((void *)data, size);
+    ::close(fd);
+    fd = -1;
+#endif
+
+    data = NULL;
+    size = 0;
+}
+
+//-----------------------------------------------------
+void strokePlayback::update(float dt){
+    if(data == NULL) return;
+
+    playTime += dt * 1000.0 * speed;
+
+    //finished - hold the piece for a bit
+    if(cursor + sizeof(strokeEvent) > size){
+        holdTime += dt;
+    }
+}
+
+//-----------------------------------------------------
+bool strokePlayback::getNextEvent(strokeEvent & e){
+    if(data == NULL) return false;
+
+    if(cursor + sizeof(strokeEvent) > size){
+        if(holdTime < STROKE_PLAYBACK_HOLD) return false;
+
+        //on to the next piece - clean wall first
+        if(!start()) return false;
+
+        e.timeMs = 0;
+        e.x      = 0;
+        e.y      = 0;
+        e.flags  = STROKE_FLAG_CLEAR;
+        return true;
+    }
+
+    strokeEvent next;
+    memcpy(&next, data + cursor, sizeof(strokeEvent));
+
+    //don't sit there for ages if the painter took a break
+    double cut = 0;
+    if(!bFirstEvent && next.timeMs > lastTime + STROKE_PLAYBACK_MAX_GAP){
+        cut = next.timeMs - lastTime - STROKE_PLAYBACK_MAX_GAP;
+    }else if(bFirstEvent){
+        cut = next.timeMs;
+    }
+
+    if(next.timeMs - timeOffset - cut > playTime) return false;
+
+    timeOffset += cut;
+    lastTime    = next.timeMs;
+    cursor     += sizeof(strokeEvent);
+
+    e = next;
+    if(bFirstEvent) e.flags |= STROKE_FLAG_NEW_STROKE;
+    bFirstEvent = false;
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef _STROKE_PLAYBACK_H
+#define _STROKE_PLAYBACK_H
+
+#include "ofMain.h"
+#include "strokeRecorder.h"
+
+//plays back the stroke logs written by strokeRecorder - one piece
+//after the other, looping through the folder.
+//
+//logs are memory mapped and read one event at a time as they come
+//due, so nothing is loaded up front and a frame only touches the
+//few bytes it plays.
+
+#define STROKE_PLAYBACK_MAX_GAP		1500	//ms - longer pauses in a log get cut down to this
+#define STROKE_PLAYBACK_HOLD		4.0		//seconds to show a finished piece before the next one
+
+class strokePlayback{
+
+public:
+
+    strokePlayback();
+    ~strokePlayback();
+
+    //returns the number of logs found
+    int loadFolder(string folder);
+    int getNumLogs();
+
+    //starts playing from the next log in the folder
+    bool start();
+    void stop();
+    bool isPlaying();
+
+    void setSpeed(float speed);
+
+    //advances the playback clock - call once per frame
+    void update(float dt);
+
+    //returns true for every event that is due - a clear
+    //event is sent between pieces
+    bool getNextEvent(strokeEvent & e);
+
+    string getCurrentName();
+
+protected:
+
+    bool openLog(int which);
+    void closeLog();
+
+    vector<string> logs;
+    int currentLog;
+
+    //the mapped file
+    const unsigned char * data;
+    size_t size;
+#ifdef TARGET_WIN32
+    void * fileHandle;
+    void * mapHandle;
+#else
+    int fd;
+#endif
+
+    size_t   cursor;		//byte offset of the next event
+    double   playTime;		//ms into the log
+    double   timeOffset;	//ms cut out of long pauses
+    uint32_t lastTime;
+    bool     bFirstEvent;
+
+    float speed;
+    float holdTime;
+};
+
+#endif
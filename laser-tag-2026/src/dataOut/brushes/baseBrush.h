@@ -2,6 +2,8 @@
 #define _BASE_BRUSH_H
 
 #include "ofMain.h"
+#include "asyncLogger.h"
+#include "brushRandom.h"
 
 
 //inhereit me to add your own brush
@@ -9,6 +11,10 @@ class baseBrush{
     
 public:
     
+    //brushes can be deleted through this class - free your buffers
+    //in your own destructor
+    virtual ~baseBrush(){}
+    
     //------------------------------------------------
     //------------------------------------------------
     //=======   things you need to overide   =========
@@ -38,6 +44,13 @@ public:
     //if you need to animate inbetween when points come in
     virtual void update(){};
     
+    //while the app is saving power update() is only called if this
+    //says so - return false when there is nothing to redraw or upload
+    //until new points come in
+    virtual bool isAnimating(){
+        return true;
+    }
+    
     //clear code here
     virtual void clear(){};
     
@@ -47,7 +60,7 @@ public:
     //only for pixel brushes
     virtual unsigned char * getImageAsPixels(){
         
-        printf("you should never see this message!\n- you need to make your own getImageAsPixels function\n");
+        LT_LOG_ERROR("baseBrush") << "you should never see this message! - you need to make your own getImageAsPixels function";
         
         //we have to return something - so here is some garbage
         unsigned char tmp[3];
@@ -61,6 +74,12 @@ public:
     //only for vector brushes
     virtual void draw(int x, int y, int w, int h){};
     
+    //only for brushes that reveal a picture - getTexture() is then
+    //the mask which is multiplied with this texture when projected
+    virtual ofTexture * getRevealTexture(){
+        return NULL;
+    }
+    
     //------------------------------------------------
     //------------------------------------------------
     //==== things that you can overide but need  =====
@@ -130,6 +149,12 @@ public:
         return brushNumber;
     }
     
+    //how many styles setBrushNumber can pick from
+    //0 if the brush doesn't know
+    virtual int getNumBrushStyles(){
+        return 0;
+    }
+    
     virtual string getName(){
         return name;
     }
@@ -146,6 +171,16 @@ public:
         return isColor;
     }
     
+    //same seed + same strokes = same picture
+    //override if you hand the generator to anything else
+    virtual void setRandomSeed(uint64_t seed){
+        random.setSeed(seed);
+    }
+    
+    brushRandom & getRandom(){
+        return random;
+    }
+    
     
 protected:
     string 	name;
@@ -173,6 +208,9 @@ protected:
     float	dripsSpeed;
     int   dripsWidth;
     
+    //use this instead of rand() / ofRandom()
+    brushRandom random;
+    
 };
 
 
@@ -74,7 +74,7 @@ public:
     void addPoint(float _x, float _y, bool isNewStroke){
         
         if(whichStroke >= MAX_NUM_STROKES){
-            printf("vectorBrush::addPoint() - maxStrokes reached\n");
+            LT_LOG_LIMITED(OF_LOG_NOTICE, "basicVectorBrush") << "addPoint - maxStrokes reached";
             return;
         }
         
@@ -82,7 +82,7 @@ public:
             whichStroke++;
             
             if(whichStroke >= MAX_NUM_STROKES){
-                printf("vectorBrush::addPoint() - maxStrokes reached\n");
+                LT_LOG_LIMITED(OF_LOG_NOTICE, "basicVectorBrush") << "addPoint - maxStrokes reached";
                 return;
             }
             
@@ -92,7 +92,7 @@ public:
             
             stroke[whichStroke].num = 0;
             
-            printf("new vec Stroke\n");
+            LT_LOG_LIMITED(OF_LOG_VERBOSE, "basicVectorBrush") << "new stroke";
         }
         
         //scale up to our dimensions
@@ -106,7 +106,7 @@ public:
         stroke[whichStroke].num++;
         
         
-        printf("stroke[%i] pos %i \n", whichStroke, pos);
+        LT_LOG_LIMITED(OF_LOG_VERBOSE, "basicVectorBrush") << "stroke[" << whichStroke << "] pos " << pos;
         
     }
     
@@ -0,0 +1,178 @@
+#include "brushLibrary.h"
+#include "asyncLogger.h"
+#include <filesystem>
+#include <set>
+
+#ifdef TARGET_LINUX
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+//-----------------------------------------------------
+brushLibrary::brushLibrary(){
+    current = make_shared<const brushList>();
+    version = 0;
+#ifdef TARGET_LINUX
+    watchFd = -1;
+#endif
+}
+
+//-----------------------------------------------------
+brushLibrary::~brushLibrary(){
+    close();
+}
+
+//-----------------------------------------------------
+void brushLibrary::setup(string brushDir){
+    close();
+
+    folder = brushDir;
+    stamps.clear();
+    images.clear();
+
+    //the first lot are decoded straight away so there is
+    //something to paint with from the first frame
+    scan();
+    publish();
+
+#ifdef TARGET_LINUX
+    watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(watchFd >= 0 && inotify_add_watch(watchFd, folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0){
+        ::close(watchFd);
+        watchFd = -1;
+    }
+    if(watchFd < 0){
+        LT_LOG_WARNING("brushLibrary") << "no inotify on " << folder << " - polling instead";
+    }
+#endif
+
+    startThread();
+}
+
+//-----------------------------------------------------
+void brushLibrary::close(){
+    if(isThreadRunning()){
+        waitForThread(true);
+    }
+#ifdef TARGET_LINUX
+    if(watchFd >= 0){
+        ::close(watchFd);
+        watchFd = -1;
+    }
+#endif
+}
+
+//-----------------------------------------------------
+shared_ptr<const brushList> brushLibrary::getBrushes(){
+    return std::atomic_load(&current);
+}
+
+int brushLibrary::getVersion(){
+    return version;
+}
+
+//-----------------------------------------------------
+void brushLibrary::threadedFunction(){
+    while(isThreadRunning()){
+
+#ifdef TARGET_LINUX
+        if(watchFd >= 0){
+            //wake up now and then to see if we should stop
+            pollfd pfd;
+            pfd.fd     = watchFd;
+            pfd.events = POLLIN;
+            if(poll(&pfd, 1, 250) <= 0) continue;
+
+            //we rescan the folder so the events themselves don't matter
+            char buffer[4096];
+            while(read(watchFd, buffer, sizeof(buffer)) > 0){}
+
+            sleep(BRUSH_SETTLE_MS);
+            while(read(watchFd, buffer, sizeof(buffer)) > 0){}
+        }else
+#endif
+        {
+            sleep(BRUSH_POLL_MS);
+        }
+
+        if(isThreadRunning() && scan()){
+            publish();
+        }
+    }
+}
+
+//decodes anything new or changed - true if the list is different
+//-----------------------------------------------------
+bool brushLibrary::scan(){
+    ofDirectory DL;
+    DL.allowExt("png");
+    int num = DL.listDir(folder);
+
+    bool bChanged = false;
+    set<string> seen;
+
+    for(int i = 0; i < num; i++){
+        string name = DL.getName(i);
+        string path = DL.getPath(i);
+        seen.insert(name);
+
+        std::error_code ec;
+        fileStamp stamp;
+        stamp.time = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        stamp.size = std::filesystem::file_size(path, ec);
+        if(ec) continue;
+
+        auto it = stamps.find(name);
+        bool bNew = it == stamps.end();
+        if(!bNew && it->second.time == stamp.time && it->second.size == stamp.size){
+            continue;
+        }
+
+        //a file that doesn't decode is tried again when it changes
+        stamps[name] = stamp;
+
+        //we use the image as a mask - no need for color
+        ofPixels pix;
+        if(!ofLoadImage(pix, path)){
+            LT_LOG_ERROR("brushLibrary") << "couldn't decode " << path;
+            if(images.erase(name) > 0) bChanged = true;
+            continue;
+        }
+        pix.setImageType(OF_IMAGE_GRAYSCALE);
+
+        auto image = make_shared<brushImage>();
+        image->name   = name;
+        image->pixels = std::move(pix);
+        images[name]  = image;
+        bChanged = true;
+
+        LT_LOG_NOTICE("brushLibrary") << (bNew ? "added " : "reloaded ") << name;
+    }
+
+    //gone from the folder
+    for(auto it = stamps.begin(); it != stamps.end(); ){
+        if(seen.count(it->first) == 0){
+            if(images.erase(it->first) > 0) bChanged = true;
+            LT_LOG_NOTICE("brushLibrary") << "removed " << it->first;
+            it = stamps.erase(it);
+        }else{
+            ++it;
+        }
+    }
+
+    return bChanged;
+}
+
+//images is a map so the list is always sorted by file name
+//-----------------------------------------------------
+void brushLibrary::publish(){
+    auto list = make_shared<brushList>();
+    list->reserve(images.size());
+    for(auto & image : images){
+        list->push_back(image.second);
+    }
+
+    std::atomic_store(&current, shared_ptr<const brushList>(list));
+    version++;
+}
@@ -0,0 +1,67 @@
+#ifndef _BRUSH_LIBRARY_H
+#define _BRUSH_LIBRARY_H
+
+#include "ofMain.h"
+
+//the png brush images - kept up to date while the app runs.
+//
+//a thread watches the brush folder (inotify on linux, a directory
+//poll everywhere else) and decodes new or changed pngs itself. each
+//change publishes a whole new list with one atomic pointer swap, so
+//the render thread just picks up the newest list when the version
+//goes up - it never waits for a decode and a list it holds never
+//changes under it.
+
+#define BRUSH_POLL_MS     1000   //directory poll without inotify
+#define BRUSH_SETTLE_MS   150    //wait after an event so a batch copy is one change
+
+struct brushImage{
+    string   name;      //file name - how a brush is found again when the list changes
+    ofPixels pixels;    //greyscale
+};
+
+typedef vector<shared_ptr<const brushImage>> brushList;
+
+class brushLibrary : public ofThread{
+
+public:
+
+    brushLibrary();
+    ~brushLibrary();
+
+    //decodes what is there now then watches for changes
+    void setup(string brushDir);
+    void close();
+
+    //the newest list - cheap enough to call every frame
+    shared_ptr<const brushList> getBrushes();
+
+    //goes up every time a new list is published
+    int getVersion();
+
+protected:
+
+    struct fileStamp{
+        int64_t  time;
+        uint64_t size;
+    };
+
+    void threadedFunction();
+    bool scan();
+    void publish();
+
+    string folder;
+
+    //only touched by whoever is scanning - setup() and then the thread
+    map<string, fileStamp> stamps;
+    map<string, shared_ptr<const brushImage>> images;
+
+    shared_ptr<const brushList> current;
+    std::atomic<int> version;
+
+#ifdef TARGET_LINUX
+    int watchFd;
+#endif
+};
+
+#endif
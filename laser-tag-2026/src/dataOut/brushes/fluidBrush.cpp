@@ -0,0 +1,406 @@
+#include "fluidBrush.h"
+
+#define FLUID_VEL_FADE		0.99	//velocity left after each step
+#define FLUID_SMOKE_FADE	0.995	//dye left after each step for smoke
+#define FLUID_BUOYANCY		0.04
+#define FLUID_FORCE			0.6		//how much of the laser's movement goes into the fluid
+#define FLUID_MAX_VEL		6.0		//cells per step
+#define FLUID_DYE_AMOUNT	0.5
+#define FLUID_SLEEP_VEL		0.01	//tiles slower than this go to sleep
+#define FLUID_SLEEP_DYE		0.004
+
+//-----------------------------------------------------
+fluidBrush::fluidBrush(){
+    pool = NULL;
+}
+
+//-----------------------------------------------------
+void fluidBrush::setupCustom(){
+
+    //we are a raster brush
+    isVector = false;
+
+    //we are color
+    isColor = true;
+
+    setName("fluidBrush");
+    setShortDescription("ink in water - strokes keep flowing");
+
+    brushNumber = 0;
+    brushWidth  = 18;
+
+    red   = 255;
+    green = 255;
+    blue  = 255;
+
+    int numCells = (FLUID_GRID_W + 2) * (FLUID_GRID_H + 2);
+    u.assign(numCells, 0);
+    v.assign(numCells, 0);
+    uTmp.assign(numCells, 0);
+    vTmp.assign(numCells, 0);
+    dyeR.assign(numCells, 0);
+    dyeG.assign(numCells, 0);
+    dyeB.assign(numCells, 0);
+    dyeTmp.assign(numCells, 0);
+    pressure.assign(numCells, 0);
+    pressureTmp.assign(numCells, 0);
+    divergence.assign(numCells, 0);
+
+    gridPixels.allocate(FLUID_GRID_W, FLUID_GRID_H, OF_PIXELS_RGBA);
+    gridTex.allocate(FLUID_GRID_W, FLUID_GRID_H, GL_RGBA);
+
+    //the upsampling to the canvas is just linear filtering
+    gridTex.setTextureMinMagFilter(GL_LINEAR, GL_LINEAR);
+    gridTex.setTextureWrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+
+    fbo.allocate(width, height, GL_RGBA);
+
+    lastX = 0;
+    lastY = 0;
+
+    clear();
+}
+
+//-----------------------------------------------------
+void fluidBrush::clear(){
+    std::fill(u.begin(), u.end(), 0);
+    std::fill(v.begin(), v.end(), 0);
+    std::fill(dyeR.begin(), dyeR.end(), 0);
+    std::fill(dyeG.begin(), dyeG.end(), 0);
+    std::fill(dyeB.begin(), dyeB.end(), 0);
+
+    memset(alive, 0, sizeof(alive));
+    memset(awake, 0, sizeof(awake));
+    numAwake = 0;
+
+    bDirty = true;
+}
+
+//-----------------------------------------------------
+void fluidBrush::setBrushNumber(int _num){
+    brushNumber = ofClamp(_num, 0, FLUID_NUM_STYLES - 1);
+}
+
+void fluidBrush::setThreadPool(threadPool * _pool){
+    pool = _pool;
+}
+
+ofTexture & fluidBrush::getTexture(){
+    return fbo.getTexture();
+}
+
+//still flowing somewhere
+bool fluidBrush::isAnimating(){
+    return numAwake > 0;
+}
+
+//-----------------------------------------------------
+void fluidBrush::splat(float gx, float gy, float vx, float vy, float radius){
+
+    int reach = ceil(radius * 2.0);
+    int iMin = MAX(1, (int)gx - reach);
+    int iMax = MIN(FLUID_GRID_W, (int)gx + reach);
+    int jMin = MAX(1, (int)gy - reach);
+    int jMax = MIN(FLUID_GRID_H, (int)gy + reach);
+
+    float r = red   / 255.0 * FLUID_DYE_AMOUNT;
+    float g = green / 255.0 * FLUID_DYE_AMOUNT;
+    float b = blue  / 255.0 * FLUID_DYE_AMOUNT;
+    float invR2 = 1.0 / (radius * radius);
+
+    for(int j = jMin; j <= jMax; j++){
+        for(int i = iMin; i <= iMax; i++){
+            float dx = i - gx;
+            float dy = j - gy;
+            float w  = exp(-(dx * dx + dy * dy) * invR2);
+            int ix   = IX(i, j);
+
+            dyeR[ix] += r * w;
+            dyeG[ix] += g * w;
+            dyeB[ix] += b * w;
+
+            //pull the fluid towards the laser's speed rather than
+            //adding to it - overlapping splats can't blow up
+            u[ix] += (vx - u[ix]) * w;
+            v[ix] += (vy - v[ix]) * w;
+        }
+    }
+
+    for(int ty = (jMin - 1) / FLUID_TILE_SIZE; ty <= (jMax - 1) / FLUID_TILE_SIZE; ty++){
+        for(int tx = (iMin - 1) / FLUID_TILE_SIZE; tx <= (iMax - 1) / FLUID_TILE_SIZE; tx++){
+            alive[ty * FLUID_TILES_X + tx] = true;
+        }
+    }
+
+    bDirty = true;
+}
+
+//-----------------------------------------------------
+void fluidBrush::addPoint(float _x, float _y, bool newStroke){
+
+    //to grid cells - the grid starts at 1
+    float gx = 0.5 + _x * FLUID_GRID_W;
+    float gy = 0.5 + _y * FLUID_GRID_H;
+
+    float radius = MAX(1.0, brushWidth * 0.5 * FLUID_GRID_W / (float)width);
+
+    if(newStroke){
+        lastX = gx;
+        lastY = gy;
+        splat(gx, gy, 0, 0, radius);
+        return;
+    }
+
+    float dx = gx - lastX;
+    float dy = gy - lastY;
+    float vx = ofClamp(dx * FLUID_FORCE, -FLUID_MAX_VEL, FLUID_MAX_VEL);
+    float vy = ofClamp(dy * FLUID_FORCE, -FLUID_MAX_VEL, FLUID_MAX_VEL);
+
+    //enough splats along the way to make a line
+    int steps = MAX(1, (int)ceil(sqrt(dx * dx + dy * dy) / (radius * 0.5)));
+    for(int s = 1; s <= steps; s++){
+        float t = s / (float)steps;
+        splat(lastX + dx * t, lastY + dy * t, vx, vy, radius);
+    }
+
+    lastX = gx;
+    lastY = gy;
+}
+
+//-----------------------------------------------------
+void fluidBrush::forAwakeRows(const std::function<void(int, int, int)> & fn){
+
+    int numBands = pool != NULL ? pool->getNumThreads() : 1;
+
+    std::function<void(int)> job = [&](int band){
+        int j0 = 1 + (FLUID_GRID_H * band) / numBands;
+        int j1 = 1 + (FLUID_GRID_H * (band + 1)) / numBands;
+
+        for(int j = j0; j < j1; j++){
+            const bool * row = awake + ((j - 1) / FLUID_TILE_SIZE) * FLUID_TILES_X;
+
+            //join neighbouring awake tiles into one span
+            int tx = 0;
+            while(tx < FLUID_TILES_X){
+                if(!row[tx]){
+                    tx++;
+                    continue;
+                }
+                int start = tx;
+                while(tx < FLUID_TILES_X && row[tx]) tx++;
+                fn(j, 1 + start * FLUID_TILE_SIZE, 1 + tx * FLUID_TILE_SIZE);
+            }
+        }
+    };
+
+    if(numBands > 1){
+        pool->parallelFor(numBands, job);
+    }else{
+        job(0);
+    }
+}
+
+//semi-lagrangian - look back along the velocity and
+//take what was there
+//-----------------------------------------------------
+void fluidBrush::advect(float * dst, const float * src, float fade){
+
+    const float * vu = u.data();
+    const float * vv = v.data();
+
+    forAwakeRows([&](int j, int i0, int i1){
+        for(int i = i0; i < i1; i++){
+            int ix = IX(i, j);
+
+            float x = ofClamp(i - vu[ix], 0.5, FLUID_GRID_W + 0.5);
+            float y = ofClamp(j - vv[ix], 0.5, FLUID_GRID_H + 0.5);
+
+            int   xi = (int)x;
+            int   yi = (int)y;
+            float s1 = x - xi;
+            float s0 = 1.0 - s1;
+            float t1 = y - yi;
+            float t0 = 1.0 - t1;
+
+            int k = IX(xi, yi);
+            dst[ix] = fade * (s0 * (t0 * src[k]     + t1 * src[k + FLUID_GRID_W + 2]) +
+                              s1 * (t0 * src[k + 1] + t1 * src[k + FLUID_GRID_W + 3]));
+        }
+    });
+}
+
+//make the velocity divergence free so it swirls
+//instead of bunching up
+//-----------------------------------------------------
+void fluidBrush::project(){
+
+    const int stride = FLUID_GRID_W + 2;
+
+    //sleeping tiles count as still water
+    std::fill(pressure.begin(), pressure.end(), 0);
+    std::fill(pressureTmp.begin(), pressureTmp.end(), 0);
+
+    float * vu  = u.data();
+    float * vv  = v.data();
+    float * div = divergence.data();
+
+    forAwakeRows([&](int j, int i0, int i1){
+        for(int i = i0; i < i1; i++){
+            int ix = IX(i, j);
+            div[ix] = -0.5 * (vu[ix + 1] - vu[ix - 1] + vv[ix + stride] - vv[ix - stride]);
+        }
+    });
+
+    for(int k = 0; k < FLUID_ITERATIONS; k++){
+        const float * p = pressure.data();
+        float * pNew    = pressureTmp.data();
+
+        forAwakeRows([&](int j, int i0, int i1){
+            int row = IX(0, j);
+            //plain contiguous loop so the compiler can vectorize it
+            for(int i = row + i0; i < row + i1; i++){
+                pNew[i] = (div[i] + p[i - 1] + p[i + 1] + p[i - stride] + p[i + stride]) * 0.25f;
+            }
+        });
+
+        pressure.swap(pressureTmp);
+    }
+
+    const float * p = pressure.data();
+    forAwakeRows([&](int j, int i0, int i1){
+        int row = IX(0, j);
+        for(int i = row + i0; i < row + i1; i++){
+            vu[i] -= 0.5f * (p[i + 1] - p[i - 1]);
+            vv[i] -= 0.5f * (p[i + stride] - p[i - stride]);
+        }
+    });
+}
+
+//-----------------------------------------------------
+void fluidBrush::updateTiles(){
+
+    bool smoke = brushNumber == 1;
+
+    for(int ty = 0; ty < FLUID_TILES_Y; ty++){
+        for(int tx = 0; tx < FLUID_TILES_X; tx++){
+            int t = ty * FLUID_TILES_X + tx;
+            if(!awake[t]) continue;
+
+            float maxVel = 0;
+            float maxDye = 0;
+            for(int j = 1 + ty * FLUID_TILE_SIZE; j < 1 + (ty + 1) * FLUID_TILE_SIZE; j++){
+                for(int i = 1 + tx * FLUID_TILE_SIZE; i < 1 + (tx + 1) * FLUID_TILE_SIZE; i++){
+                    int ix = IX(i, j);
+                    maxVel = MAX(maxVel, fabs(u[ix]) + fabs(v[ix]));
+                    if(smoke) maxDye = MAX(maxDye, dyeR[ix] + dyeG[ix] + dyeB[ix]);
+                }
+            }
+
+            alive[t] = maxVel > FLUID_SLEEP_VEL || maxDye > FLUID_SLEEP_DYE;
+
+            //stop it dead so it doesn't creep
+            if(!alive[t]){
+                for(int j = 1 + ty * FLUID_TILE_SIZE; j < 1 + (ty + 1) * FLUID_TILE_SIZE; j++){
+                    memset(&u[IX(1 + tx * FLUID_TILE_SIZE, j)], 0, FLUID_TILE_SIZE * sizeof(float));
+                    memset(&v[IX(1 + tx * FLUID_TILE_SIZE, j)], 0, FLUID_TILE_SIZE * sizeof(float));
+                }
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------
+void fluidBrush::updatePixels(){
+
+    unsigned char * pix = gridPixels.getData();
+
+    for(int j = 1; j <= FLUID_GRID_H; j++){
+        unsigned char * out = pix + (j - 1) * FLUID_GRID_W * 4;
+        for(int i = 1; i <= FLUID_GRID_W; i++){
+            int ix = IX(i, j);
+            float r = MIN(dyeR[ix], 1.0f);
+            float g = MIN(dyeG[ix], 1.0f);
+            float b = MIN(dyeB[ix], 1.0f);
+            out[0] = r * 255;
+            out[1] = g * 255;
+            out[2] = b * 255;
+            out[3] = MAX(r, MAX(g, b)) * 255;
+            out += 4;
+        }
+    }
+}
+
+//-----------------------------------------------------
+void fluidBrush::update(){
+
+    //simulate what moved last step and what was painted
+    //since - plus a tile around it
+    numAwake = 0;
+    for(int ty = 0; ty < FLUID_TILES_Y; ty++){
+        for(int tx = 0; tx < FLUID_TILES_X; tx++){
+            bool on = false;
+            for(int y = MAX(0, ty - 1); y <= MIN(FLUID_TILES_Y - 1, ty + 1) && !on; y++){
+                for(int x = MAX(0, tx - 1); x <= MIN(FLUID_TILES_X - 1, tx + 1) && !on; x++){
+                    on = alive[y * FLUID_TILES_X + x];
+                }
+            }
+            awake[ty * FLUID_TILES_X + tx] = on;
+            if(on) numAwake++;
+        }
+    }
+
+    if(numAwake > 0){
+        bool smoke = brushNumber == 1;
+
+        //smoke rises
+        if(smoke){
+            forAwakeRows([&](int j, int i0, int i1){
+                for(int i = IX(i0, j); i < IX(i1, j); i++){
+                    v[i] -= FLUID_BUOYANCY * (dyeR[i] + dyeG[i] + dyeB[i]);
+                }
+            });
+        }
+
+        //velocity moves itself
+        advect(uTmp.data(), u.data(), FLUID_VEL_FADE);
+        advect(vTmp.data(), v.data(), FLUID_VEL_FADE);
+        forAwakeRows([&](int j, int i0, int i1){
+            memcpy(&u[IX(i0, j)], &uTmp[IX(i0, j)], (i1 - i0) * sizeof(float));
+            memcpy(&v[IX(i0, j)], &vTmp[IX(i0, j)], (i1 - i0) * sizeof(float));
+        });
+
+        project();
+
+        //then carries the dye
+        float fade = smoke ? FLUID_SMOKE_FADE : 1.0;
+        vector<float> * channels[3] = {&dyeR, &dyeG, &dyeB};
+        for(int c = 0; c < 3; c++){
+            vector<float> & dye = *channels[c];
+            advect(dyeTmp.data(), dye.data(), fade);
+            forAwakeRows([&](int j, int i0, int i1){
+                memcpy(&dye[IX(i0, j)], &dyeTmp[IX(i0, j)], (i1 - i0) * sizeof(float));
+            });
+        }
+
+        //which tiles are still going
+        updateTiles();
+
+        bDirty = true;
+    }
+
+    //nothing moved - the texture is still good
+    if(!bDirty) return;
+    bDirty = false;
+
+    updatePixels();
+    gridTex.loadData(gridPixels);
+
+    fbo.begin();
+    ofPushStyle();
+    ofClear(0, 0, 0, 0);
+    ofDisableAlphaBlending();
+    ofSetColor(255, 255, 255);
+    gridTex.draw(0, 0, width, height);
+    ofPopStyle();
+    fbo.end();
+}
@@ -0,0 +1,80 @@
+#ifndef _FLUID_BRUSH_H
+#define _FLUID_BRUSH_H
+
+#include "ofMain.h"
+#include "baseBrush.h"
+#include "threadPool.h"
+
+//ink in water - the laser pushes dye and velocity into a small
+//stable fluids grid (semi-lagrangian advection and a jacobi
+//pressure solve) which is stretched over the canvas with linear
+//filtering.
+//
+//the grid is cut into tiles and only tiles that are moving - plus
+//one tile around them - get simulated. still ink costs nothing.
+//each pass is split into bands of rows on the thread pool.
+//
+//brush styles  0 - ink    dye stays where it settles
+//              1 - smoke  dye rises and slowly fades
+
+#define FLUID_GRID_W		256
+#define FLUID_GRID_H		144
+#define FLUID_TILE_SIZE		16
+#define FLUID_TILES_X		(FLUID_GRID_W / FLUID_TILE_SIZE)
+#define FLUID_TILES_Y		(FLUID_GRID_H / FLUID_TILE_SIZE)
+#define FLUID_ITERATIONS	20		//jacobi iterations for the pressure
+#define FLUID_NUM_STYLES	2
+
+class fluidBrush : public baseBrush{
+
+public:
+
+    fluidBrush();
+
+    void setupCustom();
+    void clear();
+
+    void addPoint(float _x, float _y, bool newStroke);
+    void update();
+    bool isAnimating();
+
+    void setBrushNumber(int _num);
+    void setThreadPool(threadPool * _pool);
+
+    ofTexture & getTexture();
+
+protected:
+
+    inline int IX(int i, int j){ return i + (FLUID_GRID_W + 2) * j; }
+
+    void splat(float gx, float gy, float vx, float vy, float radius);
+
+    //calls fn(row, i0, i1) for every awake span of every row
+    void forAwakeRows(const std::function<void(int, int, int)> & fn);
+
+    void advect(float * dst, const float * src, float fade);
+    void project();
+    void updateTiles();
+    void updatePixels();
+
+    threadPool * pool;
+
+    //the grid has a one cell border all round
+    vector<float> u, v, uTmp, vTmp;
+    vector<float> dyeR, dyeG, dyeB, dyeTmp;
+    vector<float> pressure, pressureTmp, divergence;
+
+    //tiles that moved last step - and the ones we simulate
+    bool alive[FLUID_TILES_X * FLUID_TILES_Y];
+    bool awake[FLUID_TILES_X * FLUID_TILES_Y];
+    int  numAwake;
+
+    float lastX, lastY;
+    bool  bDirty;
+
+    ofPixels  gridPixels;
+    ofTexture gridTex;
+    ofFbo     fbo;
+};
+
+#endif
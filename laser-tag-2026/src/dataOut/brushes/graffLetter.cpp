@@ -1,6 +1,12 @@
 
 #include "graffLetter.h"
 
+//fast x / 255 for x in 0 - 65025
+static inline unsigned char div255(int x){
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
 //----------------------------------------------
 void graffLetter::setupCustom(){
 
@@ -18,25 +24,16 @@ void graffLetter::setupCustom(){
 	oldX = 0;
 	oldY = 0;
 		
-	//opencv stuff
-	cvImgWhite.allocate(width,height);
-	cvImgWhite.set(0);
-	cvImgBlack.allocate(width,height);
-	cvImgBlack.set(0);
-	
-	cvImgBottom.allocate(width,height);
-	cvImgBottom.set(0);
-	cvImgTop.allocate(width,height);
-    cvImgTop.set(0);
-	
-	cvImgMix.allocate(width,height);
-	cvImgMix.set(0);
-	
-	cvTopLayerMask.allocate(width,height);
-	cvTopLayerMask.set(0);
-	cvBottomLayerMask.allocate(width,height);
-	cvBottomLayerMask.set(0);
-
+	//our layers - padded out to whole tiles
+	tilesX = (width  + GRAFF_TILE_SIZE - 1) / GRAFF_TILE_SIZE;
+	tilesY = (height + GRAFF_TILE_SIZE - 1) / GRAFF_TILE_SIZE;
+	
+	layers.assign(tilesX * tilesY * GRAFF_TILE_SIZE * GRAFF_TILE_SIZE, graffPixel());
+	dirtyTiles.assign(tilesX * tilesY, 0);
+	letterTiles.assign(tilesX * tilesY, 0);
+	
+	mixPixels.allocate(width, height, OF_PIXELS_GRAY);
+	
 	setBrushWidth(40);
 	dripsSettings(false, 10, 0.5, 0, 16);
 	
@@ -49,6 +46,7 @@ void graffLetter::setupCustom(){
 	nDrip = 0;
 	//-------------------------------------------	
 	
+	clear();
 }
 
 ofTexture & graffLetter::getTexture(){
@@ -84,15 +82,14 @@ void graffLetter::setupBrush(ofxCvGrayscaleImage &brush, int width){
 		for (int j = 0; j < width; j++){
 			float dist = (sqrt((midPt-i)*(midPt-i) + (midPt-j)*(midPt-j)) / radius);
 			if (dist < 1){
-				float shape = powf((1-dist), 2.0f);
-				temp[j*width + i] = 255;//(shape) * 100.0f;	
+				temp[j*width + i] = 255;
 			} else {
 				temp[j*width + i] = 0;
 			}
 		}
 	}
 	brush.setFromPixels(temp, width, width);
-	delete temp;
+	delete [] temp;
 }
 
 //----------------------------------------------
@@ -116,7 +113,7 @@ void graffLetter::setupShadowBrush(ofxCvGrayscaleImage &brush, int width){
 	}
 	brush.setFromPixels(temp, width, width);
 	brush.blurHeavily();
-	delete temp;
+	delete [] temp;
 }
 
 //----------------------------------------------
@@ -142,62 +139,97 @@ void graffLetter::update(){
 		}
 	}
 	
-	cvImgBottom.set(0);
-	cvImgBottom += cvImgWhite;
-	cvImgBottom -= cvImgBlack;
-
-	cvImgMix = cvImgTop;
-    // toDo
-	composite(cvImgMix, cvImgBottom, cvBottomLayerMask);
-    
-    texture.loadData(cvImgMix.getPixels().getData(), width, height, GL_LUMINANCE);
+	compositeDirtyTiles();
+	
+	//nothing changed - nothing to upload
+	if(bTextureDirty){
+		texture.loadData(mixPixels.getData(), width, height, GL_LUMINANCE);
+		bTextureDirty = false;
+	}
 }
 
-void graffLetter::composite(ofxCvGrayscaleImage & src, ofxCvGrayscaleImage & mom, ofxCvGrayscaleImage & momsAlpha) {
+//one pass over each dirty tile does what used to be
+//bottom = white - black  and  mix = top ATOP bottom
+//----------------------------------------------
+void graffLetter::compositeDirtyTiles(){
+	
 	// for now just mode ATOP...
 	// but we should add, over, in etc...
 	// http://www.gamedev.net/reference/articles/article320.asp
-
-	if (mom.width == width && mom.height == height) {
-		if (momsAlpha.width == width && momsAlpha.height == height) {
-			int pos;
-            unsigned char alphaVal;
-            unsigned char  val;
-			unsigned char* momData = (unsigned char*)mom.getCvImage()->imageData;
-			unsigned char* momAlphaData = (unsigned char*)momsAlpha.getCvImage()->imageData;
-			unsigned char* meData = (unsigned char*)src.getCvImage()->imageData;
-
-			int result = 0;
-			pos = 0;
-			for (int i = 0; i < height; i++) {
-				for (int j = 0; j < width; j++) {
-					alphaVal = *(momAlphaData + pos);
-					*(meData + pos) = ((*(meData + pos) * (255 - alphaVal)) +
-						(*(momData + pos) * alphaVal)) >> 8;
-					pos++;
+	
+	unsigned char * mixData = mixPixels.getData();
+	
+	for (int ty = 0; ty < tilesY; ty++){
+		for (int tx = 0; tx < tilesX; tx++){
+			
+			unsigned char & dirty = dirtyTiles[ty * tilesX + tx];
+			if (!dirty) continue;
+			dirty = 0;
+			
+			//edge tiles are only partly on screen
+			int x0 = tx * GRAFF_TILE_SIZE;
+			int y0 = ty * GRAFF_TILE_SIZE;
+			int w  = MIN(GRAFF_TILE_SIZE, width  - x0);
+			int h  = MIN(GRAFF_TILE_SIZE, height - y0);
+			
+			graffPixel * tile = getTile(tx, ty);
+			
+			for (int j = 0; j < h; j++){
+				const graffPixel * p = tile + j * GRAFF_TILE_SIZE;
+				unsigned char * mix = mixData + (y0 + j) * width + x0;
+				for (int i = 0; i < w; i++){
+					int bottom = p[i].white - p[i].black;
+					if (bottom < 0) bottom = 0;
+					int alpha = p[i].mask;
+					mix[i] = div255(p[i].top * (255 - alpha) + bottom * alpha);
 				}
-				pos = i * src.getCvImage()->widthStep;
 			}
+			
+			bTextureDirty = true;
 		}
 	}
 }
 
 //----------------------------------------------
 unsigned char * graffLetter::getImageAsPixels(){
-	return cvImgMix.getPixels().getData();
+	return mixPixels.getData();
 }
 
 //----------------------------------------------
 void graffLetter::newLetter(){
-		
-	cvImgBottom.set(0);
-	cvImgBottom += cvImgWhite;
-	cvImgBottom -= cvImgBlack;
 	
-	composite(cvImgTop, cvImgBottom, cvBottomLayerMask);
-	cvImgWhite.set(0);
-	cvImgBlack.set(0);
-	cvBottomLayerMask.set(0);
+	//bake the current letter into top - mix is already
+	//top with the letter on it so we just copy it across
+	compositeDirtyTiles();
+	
+	const unsigned char * mixData = mixPixels.getData();
+	
+	for (int ty = 0; ty < tilesY; ty++){
+		for (int tx = 0; tx < tilesX; tx++){
+			
+			unsigned char & touched = letterTiles[ty * tilesX + tx];
+			if (!touched) continue;
+			touched = 0;
+			
+			int x0 = tx * GRAFF_TILE_SIZE;
+			int y0 = ty * GRAFF_TILE_SIZE;
+			int w  = MIN(GRAFF_TILE_SIZE, width  - x0);
+			int h  = MIN(GRAFF_TILE_SIZE, height - y0);
+			
+			graffPixel * tile = getTile(tx, ty);
+			
+			for (int j = 0; j < h; j++){
+				graffPixel * p = tile + j * GRAFF_TILE_SIZE;
+				const unsigned char * mix = mixData + (y0 + j) * width + x0;
+				for (int i = 0; i < w; i++){
+					p[i].top   = mix[i];
+					p[i].white = 0;
+					p[i].black = 0;
+					p[i].mask  = 0;
+				}
+			}
+		}
+	}
 	
 	for (int i = 0; i < MAX_DRIP_PARTICLES; i++){
 		particles[i].bOn = false;
@@ -206,11 +238,12 @@ void graffLetter::newLetter(){
 
 //----------------------------------------------
 void graffLetter::clear(){
-	cvImgBottom.set(0);
-	cvImgTop.set(0);
-	cvImgWhite.set(0);
-	cvImgBlack.set(0);
-	cvBottomLayerMask.set(0);
+	graffPixel blank = {0, 0, 0, 0};
+	std::fill(layers.begin(), layers.end(), blank);
+	std::fill(dirtyTiles.begin(), dirtyTiles.end(), 0);
+	std::fill(letterTiles.begin(), letterTiles.end(), 0);
+	mixPixels.set(0);
+	bTextureDirty = true;
 	
 	for (int i = 0; i < MAX_DRIP_PARTICLES; i++){
 		particles[i].bOn = false;
@@ -224,8 +257,6 @@ void graffLetter::addPoint(float x1, float y1, bool newStroke){
 	x1 *= (float)width;
 	y1 *= (float)height;
 	
-	//printf("addingPoint(%i, %i)\n", (int)x1, (int)y1);
-	
 	if(newStroke){
 		
 		newLetter();
@@ -249,17 +280,16 @@ void graffLetter::addLine(float x1, float y1, float x2, float y2){
 	float dy 	= (float)(y2 - y1)/(float)nDivs;
 	
 	if(dripsEnabled){
-		if (ofRandom(0,dripsFrequency) > dripsFrequency-1){
-			float pct = ofRandom(0,1);
-			//printf("here pickin \n");
+		if (random.uniform(0,dripsFrequency) > dripsFrequency-1){
+			float pct = random.uniform(0,1);
 			float x = x1 + (x2-x1)*pct;
 			float y = y1 + (y2-y1)*pct;
 			
 			particles[nDrip].bOn = true;
 			particles[nDrip].x = x;
 			particles[nDrip].y = y;
-			particles[nDrip].vx =  ofRandom(-0.05, 0.05);; //// 0.0002;
-			particles[nDrip].vy = ofRandom(0.8, 1.0);
+			particles[nDrip].vx =  random.uniform(-0.05, 0.05);; //// 0.0002;
+			particles[nDrip].vy = random.uniform(0.8, 1.0);
 			nDrip++;
 			nDrip %= MAX_DRIP_PARTICLES;
 		}
@@ -267,67 +297,72 @@ void graffLetter::addLine(float x1, float y1, float x2, float y2){
 	
 	// white
 	for (int j = 0; j < nDivs; j++){
-		addIntoMe(cvImgWhite, cvWhiteBrush, x1 + dx*j-(brushWidth*0.5f), y1 + dy*j-(brushWidth*0.5f));
-		addIntoMe(cvBottomLayerMask, cvWhiteBrush, x1 + dx*j-(brushWidth*0.5f), y1 + dy*j-(brushWidth*0.5f));
+		stamp(cvWhiteBrush, &graffPixel::white, x1 + dx*j-(brushWidth*0.5f), y1 + dy*j-(brushWidth*0.5f));
+		stamp(cvWhiteBrush, &graffPixel::mask, x1 + dx*j-(brushWidth*0.5f), y1 + dy*j-(brushWidth*0.5f));
 	}
-//
-//	// offset!
+
+	// offset!
 	for (int j = 0; j < nDivs; j++){
-		addIntoMe(cvImgWhite, cvWhiteBrush, x1 + dx*j-(brushWidth*0.75f), y1 + dy*j-(brushWidth*0.75f));
-		addIntoMe(cvBottomLayerMask, cvWhiteBrush, x1 + dx*j-(brushWidth*0.75f), y1 + dy*j-(brushWidth*0.75f));
+		stamp(cvWhiteBrush, &graffPixel::white, x1 + dx*j-(brushWidth*0.75f), y1 + dy*j-(brushWidth*0.75f));
+		stamp(cvWhiteBrush, &graffPixel::mask, x1 + dx*j-(brushWidth*0.75f), y1 + dy*j-(brushWidth*0.75f));
 	}
-//
-	addIntoMe(cvBottomLayerMask, cvDropShadowBrush, x1 -(brushWidth*1.5f), y1 -(brushWidth*1.5f));
-//
-//
-//
-//	// black
+
+	stamp(cvDropShadowBrush, &graffPixel::mask, x1 -(brushWidth*1.5f), y1 -(brushWidth*1.5f));
+
+	// black
 	for (int j = 0; j < nDivs; j++){
-		addIntoMe(cvImgBlack, cvBlackBrush, x1 + dx*j-(brushWidth*(17.0/40.0)), y1 + dy*j-(brushWidth*(17.0/40.0)));
+		stamp(cvBlackBrush, &graffPixel::black, x1 + dx*j-(brushWidth*(17.0/40.0)), y1 + dy*j-(brushWidth*(17.0/40.0)));
 	}
 		
 }
 
-
-void graffLetter::addIntoMe(ofxCvGrayscaleImage& target, ofxCvGrayscaleImage mom, int x, int y) {
-	IplImage* cvImageTemp = cvCreateImage(cvSize(target.getWidth(), target.getHeight()), IPL_DEPTH_8U, 1);
+//adds a brush into one of our layers - saturating like cvAdd
+//----------------------------------------------
+void graffLetter::stamp(ofxCvGrayscaleImage & brush, unsigned char graffPixel::* layer, int x, int y) {
+	
+	int bw = brush.width;
+	int bh = brush.height;
+	if (bw <= 0 || bh <= 0) return;
+	
+	// the intersection is the rectangle { xmin, ymin, xmax, ymax }
 	int ymin = MAX(0, y);
-	int ymax = MIN(0 + height, y + mom.height);
-	if (ymin >= ymax) {
-		return;
-	}
-	int xmax = MIN(0 + width, x + mom.width);
+	int ymax = MIN(height, y + bh);
 	int xmin = MAX(0, x);
-	if (xmin >= xmax) {
+	int xmax = MIN(width, x + bw);
+	if (ymin >= ymax || xmin >= xmax) {
 		return;
 	}
-
-
-	// there is an intersection which is the rectangle  { xmin, ymin, xmax, ymax } 	
-	//value->setValues(xmin,ymin,xmax-xmin,ymax-ymin);  
-	//printf("rectangle: %i %i %i %i \n", xmin,ymin,xmax-xmin,ymax-ymin);
-
-	// roi for ME = this  xmin,ymin,xmax-xmin,ymax-ymin
-	// pos for ME = xmin, ymin
-
-	// for them...
-
-	//if (x > 0)
-	int posThemX = x >= 0 ? 0 : abs(x);
-	int posThemY = y >= 0 ? 0 : abs(y);
-	int widthThem = xmax - xmin;
-	int heightThem = ymax - ymin;
-	//printf("rectangle them: %i %i %i %i \n", posThemX, posThemY, widthThem, heightThem);
-	cvSetImageROI(target.getCvImage(), cvRect(xmin, ymin, xmax - xmin, ymax - ymin));
-	cvSetImageROI(cvImageTemp, cvRect(xmin, ymin, xmax - xmin, ymax - ymin));
-	cvSetImageROI(mom.getCvImage(), cvRect(posThemX, posThemY, widthThem, heightThem));
-
-	cvAdd(target.getCvImage(), mom.getCvImage(), cvImageTemp);
-	cvCopy(cvImageTemp, target.getCvImage(), 0);
-
-	cvSetImageROI(target.getCvImage(), cvRect(0, 0, width, height));
-	cvSetImageROI(cvImageTemp, cvRect(0, 0, width, height));
-	cvSetImageROI(mom.getCvImage(), cvRect(0, 0, width, height));
+	
+	const unsigned char * brushData = brush.getPixels().getData();
+	
+	//walk the tiles the brush covers
+	for (int ty = ymin / GRAFF_TILE_SIZE; ty <= (ymax - 1) / GRAFF_TILE_SIZE; ty++){
+		for (int tx = xmin / GRAFF_TILE_SIZE; tx <= (xmax - 1) / GRAFF_TILE_SIZE; tx++){
+			
+			int tileX = tx * GRAFF_TILE_SIZE;
+			int tileY = ty * GRAFF_TILE_SIZE;
+			int x0 = MAX(xmin, tileX);
+			int x1 = MIN(xmax, tileX + GRAFF_TILE_SIZE);
+			int y0 = MAX(ymin, tileY);
+			int y1 = MIN(ymax, tileY + GRAFF_TILE_SIZE);
+			
+			graffPixel * tile = getTile(tx, ty);
+			
+			for (int py = y0; py < y1; py++){
+				const unsigned char * b = brushData + (py - y) * bw + (x0 - x);
+				graffPixel * p = tile + (py - tileY) * GRAFF_TILE_SIZE + (x0 - tileX);
+				for (int px = x0; px < x1; px++){
+					int v = (*p).*layer + *b;
+					(*p).*layer = v > 255 ? 255 : v;
+					p++;
+					b++;
+				}
+			}
+			
+			dirtyTiles[ty * tilesX + tx]  = 1;
+			letterTiles[ty * tilesX + tx] = 1;
+		}
+	}
 }
 
 
@@ -344,23 +379,23 @@ void graffLetter::addDrip(float x1, float y1, float x2, float y2){
 	
 	// white
 	for (int j = 0; j < nDivs; j++){
-		addIntoMe(cvImgWhite, cvDripWhiteBrush, x1 + dx*j-(brushWidth*(5.0/40.0)), y1 + dy*j-(brushWidth*(5.0/40.0)));
-		addIntoMe(cvBottomLayerMask, cvDripWhiteBrush, x1 + dx*j-(brushWidth*(5.0/40.0)), y1 + dy*j-(brushWidth*(5.0/40.0)));
+		stamp(cvDripWhiteBrush, &graffPixel::white, x1 + dx*j-(brushWidth*(5.0/40.0)), y1 + dy*j-(brushWidth*(5.0/40.0)));
+		stamp(cvDripWhiteBrush, &graffPixel::mask, x1 + dx*j-(brushWidth*(5.0/40.0)), y1 + dy*j-(brushWidth*(5.0/40.0)));
 	}
 	
 	// offset!
 	for (int j = 0; j < nDivs; j++){
-		addIntoMe(cvImgWhite, cvDripWhiteBrush, x1 + dx*j-(brushWidth*(10.5/40.0)), y1 + dy*j-(brushWidth*(10.5/40.0)));
-		addIntoMe(cvBottomLayerMask, cvDripWhiteBrush, x1 + dx*j-(brushWidth*(7.5/40.0)), y1 + dy*j-(brushWidth*(7.5/40.0)));
+		stamp(cvDripWhiteBrush, &graffPixel::white, x1 + dx*j-(brushWidth*(10.5/40.0)), y1 + dy*j-(brushWidth*(10.5/40.0)));
+		stamp(cvDripWhiteBrush, &graffPixel::mask, x1 + dx*j-(brushWidth*(7.5/40.0)), y1 + dy*j-(brushWidth*(7.5/40.0)));
 	}
 	
-	addIntoMe(cvBottomLayerMask, cvDripDropShadowBrush, x1 -(brushWidth*(15/40.0)), y1 -(brushWidth*(15/40.0)));
+	stamp(cvDripDropShadowBrush, &graffPixel::mask, x1 -(brushWidth*(15/40.0)), y1 -(brushWidth*(15/40.0)));
 	
 	
 	
 	// black 
 	for (int j = 0; j < nDivs; j++){
-		addIntoMe(cvImgBlack, cvDripBlackBrush, x1 + dx*j-(brushWidth*(4.25/40.0)), y1 + dy*j-(brushWidth*(4.25/40.0)));
+		stamp(cvDripBlackBrush, &graffPixel::black, x1 + dx*j-(brushWidth*(4.25/40.0)), y1 + dy*j-(brushWidth*(4.25/40.0)));
 	}
 	
 }
@@ -22,6 +22,20 @@ typedef struct{
     bool 	bOn;
 }dripParticle;
 
+//all our layers for one pixel side by side - so a stamp or
+//the composite touches one cache line instead of six images
+typedef struct{
+    unsigned char white;	//letter fill
+    unsigned char black;	//letter outline - cut out of white
+    unsigned char mask;		//where the letter covers what is below
+    unsigned char top;		//all the finished letters
+}graffPixel;
+
+//layers are stored in square tiles so a brush stamp stays
+//in a few small blocks of memory. only tiles touched since
+//the last frame are composited.
+#define GRAFF_TILE_SIZE 		32
+
 
 class graffLetter : public baseBrush{
     
@@ -42,8 +56,13 @@ protected:
     void setupBrush(ofxCvGrayscaleImage &brush, int width);
     void setupShadowBrush(ofxCvGrayscaleImage &brush, int width);
     void addDrip(float x1, float y1, float x2, float y2);
-    void addIntoMe(ofxCvGrayscaleImage& target, ofxCvGrayscaleImage mom, int x, int y);
-    void composite(ofxCvGrayscaleImage& src, ofxCvGrayscaleImage & mom, ofxCvGrayscaleImage& momsAlpha);
+    void stamp(ofxCvGrayscaleImage & brush, unsigned char graffPixel::* layer, int x, int y);
+    void compositeDirtyTiles();
+    
+    inline graffPixel * getTile(int tx, int ty){
+        return &layers[(ty * tilesX + tx) * GRAFF_TILE_SIZE * GRAFF_TILE_SIZE];
+    }
+    
     dripParticle		particles[MAX_DRIP_PARTICLES];
     
     int 				borderSize;
@@ -58,12 +77,14 @@ protected:
     
     ofTexture texture;
     
-    ofxCvGrayscaleImage	cvImgWhite;
-    ofxCvGrayscaleImage	cvImgBlack;
-    ofxCvGrayscaleImage	cvImgBottom;
-    ofxCvGrayscaleImage	cvImgTop;
-    ofxCvGrayscaleImage	cvImgMix;
+    int tilesX, tilesY;
+    vector<graffPixel> layers;
+    vector<unsigned char> dirtyTiles;		//needs compositing
+    vector<unsigned char> letterTiles;	//touched by the current letter
+    bool bTextureDirty;
     
+    //what we show - top with the current letter on top of it
+    ofPixels mixPixels;
     
     ofxCvGrayscaleImage	cvWhiteBrush;
     ofxCvGrayscaleImage	cvBlackBrush;
@@ -74,10 +95,6 @@ protected:
     
     ofxCvGrayscaleImage	cvDropShadowBrush;
     
-    ofxCvGrayscaleImage	cvTopLayerMask;
-    ofxCvGrayscaleImage cvBottomLayerMask;
-    
-    
 };
 
 #endif	
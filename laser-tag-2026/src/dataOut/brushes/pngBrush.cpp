@@ -1,4 +1,31 @@
 #include "pngBrush.h"
+#include "asyncLogger.h"
+
+#ifdef LT_FIXED_POINT
+//one row of the brush into rgba pixels with whole numbers - no
+//branch for empty mask pixels (they leave the pixel as it was)
+//so it vectorizes on neon
+//--------------------------
+static void blendRow(unsigned char * __restrict dst, const unsigned char * __restrict mask, int n, int r, int g, int b, int a){
+    for(int i = 0; i < n; i++){
+        int v  = mask[i];
+        int iv = 255 - v;
+        dst[i*4    ] = (dst[i*4    ] * iv + r * v) / 255;
+        dst[i*4 + 1] = (dst[i*4 + 1] * iv + g * v) / 255;
+        dst[i*4 + 2] = (dst[i*4 + 2] * iv + b * v) / 255;
+        dst[i*4 + 3] = (dst[i*4 + 3] * iv + a * v) / 255;
+    }
+}
+#endif
+
+//--------------------------
+pngBrush::pngBrush(){
+    pixels = NULL;
+}
+
+pngBrush::~pngBrush(){
+    delete [] pixels;
+}
 
 //--------------------------
 void pngBrush::setupCustom(){
@@ -21,6 +48,7 @@ void pngBrush::setupCustom(){
     //other vars
     numBrushes      = 0;
     brushNumber        = -1;
+    brushSetVersion = -1;
     numSteps        = 15;
     brushWidth        = 18;
     
@@ -33,17 +61,19 @@ void pngBrush::setupCustom(){
     dripsSettings(false, 8, 0.05, 0, 2);
     
     //setup up our image buffer
+    delete [] pixels;
     pixels = new unsigned char[width * height * imageNumBytes];
     clear();
     
     DRIPS.setup(width, height);
+    DRIPS.setRandom(&random);
     
     drip = false;
     dripCount = 0;
     dripPattern = 10;
     
     //load brushes
-    cout<<ofToDataPath("brushes/")<<endl;
+    LT_LOG_NOTICE("pngBrush") << "loading brushes from " << ofToDataPath("brushes/");
     loadbrushes(ofToDataPath("brushes/"));
 }
 
@@ -58,58 +88,87 @@ void pngBrush::clear(){
 //reads a directoty for png files
 //loads them into imagebrushNumber as the different brushes
 //format should be b&w 16 by 16 png with white being the
-//brushNumber shape
+//brushNumber shape - pngs dropped in later show up by themselves
 //------------------------
 int pngBrush::loadbrushes(string brushDir){
     
-    DL.allowExt("png");
-    numBrushes = DL.listDir(brushDir);
+    library.setup(brushDir);
+    syncBrushes();
+    
+    LT_LOG_NOTICE("pngBrush") << numBrushes << " brushes";
+    return numBrushes;
+}
+
+//takes the newest list from the library - we stay on the
+//same brush if it is still there
+//-----------------------------------------------------
+void pngBrush::syncBrushes(){
+    
+    int version = library.getVersion();
+    if(version == brushSetVersion) return;
+    
+    brushSetVersion = version;
+    brushSet   = library.getBrushes();
+    numBrushes = brushSet->size();
     
-    //set a default brush
-    if(numBrushes > 0){
-        brushNumber = 0;
-        cout<<ofToString(numBrushes)<<endl;
-        setBrushNumber(brushNumber);
+    if(numBrushes == 0){
+        brushNumber  = -1;
+        currentBrush = nullptr;
+        return;
     }
     
-    return numBrushes;
+    int num = 0;
+    if(currentBrush){
+        num = MIN(MAX(brushNumber, 0), numBrushes-1);
+        for(int i = 0; i < numBrushes; i++){
+            if((*brushSet)[i]->name == currentBrush->name){
+                num = i;
+                break;
+            }
+        }
+    }
+    setBrushNumber(num);
 }
 
 //-----------------------------------------------------
 void pngBrush::setBrushNumber(int _num){
     
     if(numBrushes == 0){
-        cout<<"no brushes"<<endl;
+        LT_LOG_LIMITED(OF_LOG_NOTICE, "pngBrush") << "no brushes";
         return;
     }
     
     if(_num >= numBrushes){
         _num = numBrushes-1;
     }
+    if(_num < 0){
+        _num = 0;
+    }
     
     brushNumber = _num;
     
-    IMG.load(DL.getPath(brushNumber));
+    //already decoded - and already a greyscale mask
+    //that we multiply with our drawing color
+    shared_ptr<const brushImage> image = (*brushSet)[brushNumber];
+    if(image == currentBrush) return;
     
-    //no need for color
-    //we will use the image as a mask to
-    //draw with and multiply it with
-    //our drawing color.
-    IMG.setImageType(OF_IMAGE_GRAYSCALE);
-    TMP.setImageType(OF_IMAGE_GRAYSCALE);
+    currentBrush = image;
+    IMG.setFromPixels(currentBrush->pixels);
     updateTmpImage(brushWidth);
     
 }
 
+int pngBrush::getNumBrushStyles(){
+    return numBrushes;
+}
+
 //-----------------------------------------------------
 void pngBrush::setBrushWidth(int width){
     
-    if(numBrushes == 0)return;
-    
     //only resize the brushNumber when its size has changed
     if(brushWidth != width){
         brushWidth = width;
-        updateTmpImage(brushWidth);
+        if(currentBrush) updateTmpImage(brushWidth);
     }
     
 }
@@ -154,16 +213,24 @@ void pngBrush::setBrushColor(int r, int g, int b){
 
 //-----------------------------------------------------
 string pngBrush::getbrushName(){
-    return DL.getName(brushNumber);
+    return currentBrush ? currentBrush->name : "";
 }
 
 //-----------------------------------------------------
 void pngBrush::update(){
     
+    //new or changed pngs in the brush folder
+    syncBrushes();
+    
     DRIPS.updateDrips(pixels);
     texture.loadData(pixels, width, height, GL_RGBA);
 }
 
+//only the drips move once the laser is gone
+bool pngBrush::isAnimating(){
+    return DRIPS.isDripping();
+}
+
 ofTexture& pngBrush::getTexture(){
     return texture;
 }
@@ -183,11 +250,11 @@ void pngBrush::addPoint(float _x, float _y, bool newStroke){
     
     //make sure we have a brush to use
     if(brushNumber < 0){
-        printf("pngBrush - no brushes found to draw with\n");
+        LT_LOG_LIMITED(OF_LOG_NOTICE, "pngBrush") << "no brushes found to draw with";
         return;
     }
-    int temp = ofRandom(9);
-    if ( (dripsEnabled && ofRandom(0,dripsFrequency) > dripsFrequency-1) ){
+    int temp = random.uniform(9);
+    if ( (dripsEnabled && random.uniform(0,dripsFrequency) > dripsFrequency-1) ){
         DRIPS.addDrip(_x, _y);
         for(int i = -temp; i < temp; i++){
             DRIPS.addDrip(_x+temp, _y+temp);
@@ -269,6 +336,13 @@ void pngBrush::addPoint(float _x, float _y, bool newStroke){
         int offSetCorrectionRight = ((TMP.getWidth() + tx) -  destX);
         tPix += offSetCorrectionLeft;
         
+#ifdef LT_FIXED_POINT
+        int rowLength = MAX(0, destX - tx);
+        for(int y = ty; y < destY; y++){
+            blendRow(pixels + y*stride + tx*imageNumBytes, brushPix + tPix, rowLength, red, green, blue, alpha);
+            tPix += rowLength + offSetCorrectionRight;
+        }
+#else
         //some vars we are going to need
         //put here to optimise?
         float r, g, b, a, value, ival;
@@ -303,6 +377,7 @@ void pngBrush::addPoint(float _x, float _y, bool newStroke){
             }
             tPix += offSetCorrectionRight;
         }
+#endif
         
     }
     
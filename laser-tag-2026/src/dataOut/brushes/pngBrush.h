@@ -6,6 +6,7 @@
 
 #include "drips.h"
 #include "baseBrush.h"
+#include "brushLibrary.h"
 
 //for small speed improvement?
 #define ONE_OVER_255 0.00392157
@@ -14,6 +15,9 @@ class pngBrush : public baseBrush{
     
 public:
     
+    pngBrush();
+    ~pngBrush();
+    
     //stuff we have overidden from baseBrush
     
     void setupCustom();
@@ -21,6 +25,7 @@ public:
     
     void addPoint(float _x, float _y, bool newStroke);
     void update();
+    bool isAnimating();
     
     unsigned char * getImageAsPixels();
     void drawTool(int x, int y, int w, int h);
@@ -31,6 +36,7 @@ public:
     void drawBrushColor(float x, float y, int w, int h);
     int  loadbrushes(string brushDir);
     void setBrushNumber(int _num);
+    int  getNumBrushStyles();
     
     ofTexture & getTexture();
     
@@ -38,13 +44,19 @@ protected:
     
     
     void updateTmpImage(float _brushWidth);
+    void syncBrushes();
     string getbrushName();
     
     
     ofTexture texture;
-    ofDirectory DL;
     drips DRIPS;
     
+    //decoded on another thread - we take the newest list in update()
+    brushLibrary library;
+    shared_ptr<const brushList> brushSet;
+    shared_ptr<const brushImage> currentBrush;
+    int brushSetVersion;
+    
     ofImage IMG;
     ofImage TMP;
     
@@ -0,0 +1,313 @@
+#include "reactionBrush.h"
+
+#define RD_DIFFUSE_A	1.0f
+#define RD_DIFFUSE_B	0.5f
+#define RD_ACTIVE_EPS	0.0001	//change in b over a frame that keeps a tile going
+
+//feed and kill rates for each style
+static const float rdFeed[RD_NUM_STYLES] = {0.0545, 0.0367, 0.029};
+static const float rdKill[RD_NUM_STYLES] = {0.062,  0.0649, 0.057};
+
+//one gray-scott step over a span of n cells in a row.
+//restrict tells the compiler the buffers don't overlap - without it
+//the loop doesn't get vectorized.
+//3x3 laplacian - the plain 4 neighbour one kills most patterns.
+//-----------------------------------------------------
+static void stepSpan(const float * __restrict a, const float * __restrict b,
+                     float * __restrict aNew, float * __restrict bNew,
+                     int n, int stride, float feed, float kill){
+
+    for(int i = 0; i < n; i++){
+        float av = a[i];
+        float bv = b[i];
+        float lapA = 0.2f  * (a[i - 1] + a[i + 1] + a[i - stride] + a[i + stride])
+                   + 0.05f * (a[i - stride - 1] + a[i - stride + 1] + a[i + stride - 1] + a[i + stride + 1]) - av;
+        float lapB = 0.2f  * (b[i - 1] + b[i + 1] + b[i - stride] + b[i + stride])
+                   + 0.05f * (b[i - stride - 1] + b[i - stride + 1] + b[i + stride - 1] + b[i + stride + 1]) - bv;
+        float abb  = av * bv * bv;
+
+        aNew[i] = av + (RD_DIFFUSE_A * lapA - abb + feed * (1.0f - av));
+        bNew[i] = bv + (RD_DIFFUSE_B * lapB + abb - (kill + feed) * bv);
+    }
+}
+
+//-----------------------------------------------------
+reactionBrush::reactionBrush(){
+    pool = NULL;
+}
+
+//-----------------------------------------------------
+void reactionBrush::setupCustom(){
+
+    //we are a raster brush
+    isVector = false;
+
+    //greyscale - tinted by the projection color
+    isColor = false;
+
+    setName("reactionBrush");
+    setShortDescription("strokes grow by themselves");
+
+    brushNumber = 0;
+    brushWidth  = 12;
+
+    gridW  = width  / RD_SCALE;
+    gridH  = height / RD_SCALE;
+    tilesX = (gridW + RD_TILE_SIZE - 1) / RD_TILE_SIZE;
+    tilesY = (gridH + RD_TILE_SIZE - 1) / RD_TILE_SIZE;
+
+    int numCells = (gridW + 2) * (gridH + 2);
+    A.assign(numCells, 1);
+    B.assign(numCells, 0);
+    ATmp.assign(numCells, 1);
+    BTmp.assign(numCells, 0);
+    BStart.assign(numCells, 0);
+
+    quietFrames.assign(tilesX * tilesY, -1);
+    simulate.assign(tilesX * tilesY, 0);
+
+    gridPixels.allocate(gridW, gridH, OF_PIXELS_GRAY);
+    gridTex.allocate(gridW, gridH, GL_LUMINANCE);
+    gridTex.setTextureMinMagFilter(GL_LINEAR, GL_LINEAR);
+
+    fbo.allocate(width, height, GL_RGB);
+
+    lastX = 0;
+    lastY = 0;
+
+    clear();
+}
+
+//-----------------------------------------------------
+void reactionBrush::clear(){
+    std::fill(A.begin(), A.end(), 1);
+    std::fill(B.begin(), B.end(), 0);
+
+    std::fill(quietFrames.begin(), quietFrames.end(), -1);
+    std::fill(simulate.begin(), simulate.end(), 0);
+    numActive = 0;
+
+    gridPixels.set(0);
+    bDirty = true;
+}
+
+//-----------------------------------------------------
+void reactionBrush::setBrushNumber(int _num){
+    brushNumber = ofClamp(_num, 0, RD_NUM_STYLES - 1);
+}
+
+void reactionBrush::setThreadPool(threadPool * _pool){
+    pool = _pool;
+}
+
+ofTexture & reactionBrush::getTexture(){
+    return fbo.getTexture();
+}
+
+int reactionBrush::getNumActiveTiles(){
+    return numActive;
+}
+
+//still growing somewhere
+bool reactionBrush::isAnimating(){
+    return numActive > 0;
+}
+
+//-----------------------------------------------------
+void reactionBrush::wakeTile(int tx, int ty){
+    if(tx < 0 || ty < 0 || tx >= tilesX || ty >= tilesY) return;
+    quietFrames[ty * tilesX + tx] = 0;
+}
+
+//-----------------------------------------------------
+void reactionBrush::seed(float gx, float gy, float radius){
+
+    int iMin = MAX(1, (int)(gx - radius));
+    int iMax = MIN(gridW, (int)(gx + radius));
+    int jMin = MAX(1, (int)(gy - radius));
+    int jMax = MIN(gridH, (int)(gy + radius));
+
+    float r2 = radius * radius;
+
+    for(int j = jMin; j <= jMax; j++){
+        for(int i = iMin; i <= iMax; i++){
+            float dx = i - gx;
+            float dy = j - gy;
+            if(dx * dx + dy * dy > r2) continue;
+
+            int ix = IX(i, j);
+            A[ix] = 0.5;
+            B[ix] = 1.0;
+        }
+    }
+
+    for(int ty = (jMin - 1) / RD_TILE_SIZE; ty <= (jMax - 1) / RD_TILE_SIZE; ty++){
+        for(int tx = (iMin - 1) / RD_TILE_SIZE; tx <= (iMax - 1) / RD_TILE_SIZE; tx++){
+            wakeTile(tx, ty);
+        }
+    }
+}
+
+//-----------------------------------------------------
+void reactionBrush::addPoint(float _x, float _y, bool newStroke){
+
+    //to grid cells - the grid starts at 1
+    float gx = 1 + _x * gridW;
+    float gy = 1 + _y * gridH;
+
+    float radius = MAX(1.5, brushWidth * 0.5 / RD_SCALE);
+
+    if(newStroke){
+        lastX = gx;
+        lastY = gy;
+    }
+
+    float dx = gx - lastX;
+    float dy = gy - lastY;
+
+    int steps = MAX(1, (int)ceil(sqrt(dx * dx + dy * dy) / (radius * 0.5)));
+    for(int s = 1; s <= steps; s++){
+        float t = s / (float)steps;
+        seed(lastX + dx * t, lastY + dy * t, radius);
+    }
+
+    lastX = gx;
+    lastY = gy;
+}
+
+//-----------------------------------------------------
+void reactionBrush::forActiveRows(const std::function<void(int, int, int)> & fn){
+
+    int numBands = pool != NULL ? pool->getNumThreads() : 1;
+
+    std::function<void(int)> job = [&](int band){
+        int j0 = 1 + (gridH * band) / numBands;
+        int j1 = 1 + (gridH * (band + 1)) / numBands;
+
+        for(int j = j0; j < j1; j++){
+            const unsigned char * row = &simulate[((j - 1) / RD_TILE_SIZE) * tilesX];
+
+            //join neighbouring tiles into one span
+            int tx = 0;
+            while(tx < tilesX){
+                if(!row[tx]){
+                    tx++;
+                    continue;
+                }
+                int start = tx;
+                while(tx < tilesX && row[tx]) tx++;
+                fn(j, 1 + start * RD_TILE_SIZE, MIN(1 + tx * RD_TILE_SIZE, gridW + 1));
+            }
+        }
+    };
+
+    if(numBands > 1){
+        pool->parallelFor(numBands, job);
+    }else{
+        job(0);
+    }
+}
+
+//-----------------------------------------------------
+void reactionBrush::step(float feed, float kill){
+
+    const int stride = gridW + 2;
+
+    forActiveRows([&](int j, int i0, int i1){
+        int start = IX(i0, j);
+        stepSpan(&A[start], &B[start], &ATmp[start], &BTmp[start], i1 - i0, stride, feed, kill);
+    });
+
+    forActiveRows([&](int j, int i0, int i1){
+        memcpy(&A[IX(i0, j)], &ATmp[IX(i0, j)], (i1 - i0) * sizeof(float));
+        memcpy(&B[IX(i0, j)], &BTmp[IX(i0, j)], (i1 - i0) * sizeof(float));
+    });
+}
+
+//-----------------------------------------------------
+void reactionBrush::updateTiles(){
+
+    for(int ty = 0; ty < tilesY; ty++){
+        for(int tx = 0; tx < tilesX; tx++){
+            int t = ty * tilesX + tx;
+            if(!simulate[t]) continue;
+
+            float maxChange = 0;
+            int jEnd = MIN(1 + (ty + 1) * RD_TILE_SIZE, gridH + 1);
+            int iEnd = MIN(1 + (tx + 1) * RD_TILE_SIZE, gridW + 1);
+            for(int j = 1 + ty * RD_TILE_SIZE; j < jEnd; j++){
+                for(int i = 1 + tx * RD_TILE_SIZE; i < iEnd; i++){
+                    int ix = IX(i, j);
+                    maxChange = MAX(maxChange, fabs(B[ix] - BStart[ix]));
+                }
+            }
+
+            //halo tiles that something grew into join in
+            if(maxChange > RD_ACTIVE_EPS){
+                quietFrames[t] = 0;
+            }else if(quietFrames[t] >= 0){
+                quietFrames[t]++;
+                if(quietFrames[t] > RD_RETIRE_FRAMES) quietFrames[t] = -1;
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------
+void reactionBrush::update(){
+
+    //active tiles plus one tile around them
+    numActive = 0;
+    bool any = false;
+    for(int ty = 0; ty < tilesY; ty++){
+        for(int tx = 0; tx < tilesX; tx++){
+            bool on = false;
+            for(int y = MAX(0, ty - 1); y <= MIN(tilesY - 1, ty + 1) && !on; y++){
+                for(int x = MAX(0, tx - 1); x <= MIN(tilesX - 1, tx + 1) && !on; x++){
+                    on = quietFrames[y * tilesX + x] >= 0;
+                }
+            }
+            simulate[ty * tilesX + tx] = on;
+            if(quietFrames[ty * tilesX + tx] >= 0) numActive++;
+            any = any || on;
+        }
+    }
+
+    if(any){
+        forActiveRows([&](int j, int i0, int i1){
+            memcpy(&BStart[IX(i0, j)], &B[IX(i0, j)], (i1 - i0) * sizeof(float));
+        });
+
+        for(int s = 0; s < RD_STEPS_PER_FRAME; s++){
+            step(rdFeed[brushNumber], rdKill[brushNumber]);
+        }
+
+        updateTiles();
+
+        //empty is black - the more b the brighter
+        unsigned char * pix = gridPixels.getData();
+        forActiveRows([&](int j, int i0, int i1){
+            unsigned char * out = pix + (j - 1) * gridW;
+            for(int i = i0; i < i1; i++){
+                int ix = IX(i, j);
+                out[i - 1] = ofClamp(1.0f - (A[ix] - B[ix]), 0.0f, 1.0f) * 255;
+            }
+        });
+
+        bDirty = true;
+    }
+
+    //nothing grew - the texture is still good
+    if(!bDirty) return;
+    bDirty = false;
+
+    gridTex.loadData(gridPixels);
+
+    fbo.begin();
+    ofPushStyle();
+    ofClear(0, 0, 0, 255);
+    ofSetColor(255, 255, 255);
+    gridTex.draw(0, 0, width, height);
+    ofPopStyle();
+    fbo.end();
+}
@@ -0,0 +1,81 @@
+#ifndef _REACTION_BRUSH_H
+#define _REACTION_BRUSH_H
+
+#include "ofMain.h"
+#include "baseBrush.h"
+#include "threadPool.h"
+
+//strokes seed a gray-scott reaction diffusion which keeps on
+//growing after the laser has gone.
+//
+//the field is half the canvas size and cut into tiles. only tiles
+//that are still changing - plus one tile around them so the growth
+//can spread - get stepped. tiles that stay still for a while are
+//retired and cost nothing until something grows into them again.
+//
+//brush styles are different feed / kill rates
+//  0 - coral   1 - spots   2 - maze
+
+#define RD_SCALE			2		//canvas pixels per cell
+#define RD_TILE_SIZE		32
+#define RD_STEPS_PER_FRAME	8
+#define RD_RETIRE_FRAMES	30		//quiet frames before a tile is retired
+#define RD_NUM_STYLES		3
+
+class reactionBrush : public baseBrush{
+
+public:
+
+    reactionBrush();
+
+    void setupCustom();
+    void clear();
+
+    void addPoint(float _x, float _y, bool newStroke);
+    void update();
+    bool isAnimating();
+
+    void setBrushNumber(int _num);
+    void setThreadPool(threadPool * _pool);
+
+    ofTexture & getTexture();
+
+    int getNumActiveTiles();
+
+protected:
+
+    inline int IX(int i, int j){ return i + (gridW + 2) * j; }
+
+    void seed(float gx, float gy, float radius);
+    void wakeTile(int tx, int ty);
+
+    //calls fn(row, i0, i1) for every simulated span of every row
+    void forActiveRows(const std::function<void(int, int, int)> & fn);
+
+    void step(float feed, float kill);
+    void updateTiles();
+
+    threadPool * pool;
+
+    int gridW, gridH;
+    int tilesX, tilesY;
+
+    //a and b with a one cell border all round
+    vector<float> A, B, ATmp, BTmp;
+
+    //b at the start of the frame - to see which tiles changed
+    vector<float> BStart;
+
+    vector<int>  quietFrames;	//-1 means retired
+    vector<unsigned char> simulate;	//active tiles plus the halo
+    int numActive;
+
+    float lastX, lastY;
+    bool  bDirty;
+
+    ofPixels  gridPixels;
+    ofTexture gridTex;
+    ofFbo     fbo;
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include "revealBrush.h"
+#include "asyncLogger.h"
+
+//-----------------------------------------------------
+revealBrush::revealBrush(){
+    numMedia  = 0;
+    stampSize = 0;
+    dirtyY0   = 0;
+    dirtyY1   = 0;
+    oldX      = 0;
+    oldY      = 0;
+}
+
+//-----------------------------------------------------
+void revealBrush::setupCustom(){
+
+    //we are a raster brush
+    isVector = false;
+
+    //the mask is greyscale but what we show is the picture
+    isColor = true;
+
+    setName("revealBrush");
+    setShortDescription("paint the wall away - video / images from data/reveal/");
+
+    brushNumber = 0;
+    brushWidth  = 40;
+
+    mask.allocate(width, height, OF_PIXELS_GRAY);
+    maskTex.allocate(width, height, GL_LUMINANCE);
+
+    updateStamp();
+    clear();
+
+    loadMedia(ofToDataPath(REVEAL_DIR));
+}
+
+//-----------------------------------------------------
+void revealBrush::clear(){
+    mask.set(0);
+    dirtyY0 = 0;
+    dirtyY1 = height;
+}
+
+//lists the videos and images we can reveal
+//-----------------------------------------------------
+int revealBrush::loadMedia(string mediaDir){
+    DL.allowExt("mov");
+    DL.allowExt("mp4");
+    DL.allowExt("avi");
+    DL.allowExt("png");
+    DL.allowExt("jpg");
+    DL.allowExt("jpeg");
+    numMedia = DL.listDir(mediaDir);
+    DL.sort();
+
+    if(numMedia == 0){
+        LT_LOG_NOTICE("revealBrush") << "nothing to reveal in " << mediaDir;
+    }else{
+        setBrushNumber(0);
+    }
+    return numMedia;
+}
+
+//-----------------------------------------------------
+void revealBrush::setBrushNumber(int _num){
+    if(numMedia == 0) return;
+
+    _num = ofClamp(_num, 0, numMedia - 1);
+    if(_num == brushNumber && (source.isLoaded() || source.isVideo())) return;
+
+    brushNumber = _num;
+    source.load(DL.getPath(brushNumber));
+}
+
+int revealBrush::getNumBrushStyles(){
+    return numMedia;
+}
+
+//-----------------------------------------------------
+void revealBrush::setBrushWidth(int _width){
+    if(_width == brushWidth) return;
+    brushWidth = _width;
+    updateStamp();
+}
+
+//a round dab with a soft edge
+//-----------------------------------------------------
+void revealBrush::updateStamp(){
+    stampSize = MAX(2, brushWidth);
+    stampPix.assign(stampSize * stampSize, 0);
+
+    float radius = stampSize * 0.5;
+    for(int y = 0; y < stampSize; y++){
+        for(int x = 0; x < stampSize; x++){
+            float dx = x + 0.5 - radius;
+            float dy = y + 0.5 - radius;
+            float d  = sqrt(dx * dx + dy * dy) / radius;
+
+            //solid in the middle - fades out over the last third
+            float v = ofClamp((1.0 - d) * 3.0, 0, 1);
+            stampPix[y * stampSize + x] = v * 255;
+        }
+    }
+}
+
+//-----------------------------------------------------
+void revealBrush::stamp(int cx, int cy){
+    int x0 = cx - stampSize / 2;
+    int y0 = cy - stampSize / 2;
+
+    int sx0 = MAX(0, -x0);
+    int sy0 = MAX(0, -y0);
+    int sx1 = MIN(stampSize, width  - x0);
+    int sy1 = MIN(stampSize, height - y0);
+    if(sx0 >= sx1 || sy0 >= sy1) return;
+
+    unsigned char * pix = mask.getData();
+    for(int sy = sy0; sy < sy1; sy++){
+        const unsigned char * src = &stampPix[sy * stampSize];
+        unsigned char * dst = pix + (y0 + sy) * width + x0;
+        for(int sx = sx0; sx < sx1; sx++){
+            dst[sx] = MAX(dst[sx], src[sx]);
+        }
+    }
+
+    dirtyY0 = MIN(dirtyY0, y0 + sy0);
+    dirtyY1 = MAX(dirtyY1, y0 + sy1);
+}
+
+//-----------------------------------------------------
+void revealBrush::addPoint(float _x, float _y, bool newStroke){
+
+    //scale up to our dimensions
+    _x *= (float)width;
+    _y *= (float)height;
+
+    if(newStroke){
+        oldX = _x;
+        oldY = _y;
+    }
+
+    //a dab every quarter of the brush width
+    float dx = _x - oldX;
+    float dy = _y - oldY;
+    int steps = MAX(1, (int)ceil(sqrt(dx * dx + dy * dy) / MAX(1, stampSize / 4)));
+
+    for(int i = 1; i <= steps; i++){
+        float t = i / (float)steps;
+        stamp(oldX + dx * t, oldY + dy * t);
+    }
+
+    oldX = _x;
+    oldY = _y;
+}
+
+//-----------------------------------------------------
+void revealBrush::update(){
+    source.update();
+
+    if(dirtyY1 <= dirtyY0) return;
+
+    //only send the rows we painted on
+    ofTextureData & texData = maskTex.getTextureData();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(texData.textureTarget, texData.textureID);
+    glTexSubImage2D(texData.textureTarget, 0, 0, dirtyY0, width, dirtyY1 - dirtyY0,
+                    GL_LUMINANCE, GL_UNSIGNED_BYTE, mask.getData() + dirtyY0 * width);
+    glBindTexture(texData.textureTarget, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    dirtyY0 = height;
+    dirtyY1 = 0;
+}
+
+//-----------------------------------------------------
+void revealBrush::drawTool(int x, int y, int w, int h){
+    if(!source.isLoaded()) return;
+    ofSetColor(255, 255, 255, 255);
+    source.getTexture().draw(x, y, w, h);
+}
+
+//-----------------------------------------------------
+ofTexture & revealBrush::getTexture(){
+    return maskTex;
+}
+
+ofTexture * revealBrush::getRevealTexture(){
+    if(!source.isLoaded()) return NULL;
+    return &source.getTexture();
+}
@@ -0,0 +1,67 @@
+#ifndef _REVEAL_BRUSH_H
+#define _REVEAL_BRUSH_H
+
+#include "ofMain.h"
+#include "baseBrush.h"
+#include "revealSource.h"
+
+//paints the wall away to show a video or image underneath.
+//
+//the brush only paints a greyscale coverage mask - the picture
+//itself never goes near the cpu side of the brush. the projection
+//multiplies the two on the gpu, so a stroke costs the same whatever
+//the size of the video.
+//
+//brush styles are the files in data/reveal/
+
+#define REVEAL_DIR	"reveal/"
+
+class revealBrush : public baseBrush{
+
+public:
+
+    revealBrush();
+
+    void setupCustom();
+    void clear();
+
+    void addPoint(float _x, float _y, bool newStroke);
+    void update();
+
+    void setBrushNumber(int _num);
+    int  getNumBrushStyles();
+    void setBrushWidth(int _width);
+    int  loadMedia(string mediaDir);
+
+    void drawTool(int x, int y, int w, int h);
+
+    //the mask
+    ofTexture & getTexture();
+
+    //the picture - NULL until there is something to show
+    ofTexture * getRevealTexture();
+
+protected:
+
+    void updateStamp();
+    void stamp(int cx, int cy);
+
+    ofDirectory DL;
+    int numMedia;
+
+    revealSource source;
+
+    ofPixels  mask;
+    ofTexture maskTex;
+
+    //soft round dab - stampSize x stampSize
+    vector<unsigned char> stampPix;
+    int stampSize;
+
+    //rows that need uploading
+    int dirtyY0, dirtyY1;
+
+    float oldX, oldY;
+};
+
+#endif
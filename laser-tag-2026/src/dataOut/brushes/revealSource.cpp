@@ -0,0 +1,164 @@
+#include "revealSource.h"
+#include "asyncLogger.h"
+
+//-----------------------------------------------------
+revealSource::revealSource(){
+    bLoaded    = false;
+    bVideo     = false;
+    frameCount = 0;
+    current    = 0;
+
+    for(int i = 0; i < REVEAL_NUM_SLOTS; i++){
+        states[i] = SLOT_FREE;
+        stamps[i] = 0;
+    }
+}
+
+//-----------------------------------------------------
+revealSource::~revealSource(){
+    close();
+}
+
+//-----------------------------------------------------
+bool revealSource::load(string filePath){
+    close();
+
+    path = filePath;
+    string ext = ofToLower(ofFilePath::getFileExt(path));
+
+    if(ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "tif" || ext == "tiff" || ext == "bmp"){
+        ofPixels pix;
+        if(!ofLoadImage(pix, path)){
+            LT_LOG_ERROR("revealSource") << "couldn't load " << path;
+            return false;
+        }
+        textures[0].allocate(pix);
+        textures[0].loadData(pix);
+        current = 0;
+        bVideo  = false;
+        bLoaded = true;
+        return true;
+    }
+
+    //nothing to show until the first frame is decoded
+    bVideo  = true;
+    bLoaded = false;
+    startThread();
+    return true;
+}
+
+//-----------------------------------------------------
+void revealSource::close(){
+    if(isThreadRunning()){
+        waitForThread(true);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for(int i = 0; i < REVEAL_NUM_SLOTS; i++){
+        states[i] = SLOT_FREE;
+        stamps[i] = 0;
+    }
+    frameCount = 0;
+    bLoaded    = false;
+    bVideo     = false;
+}
+
+//the video player lives on this thread and never touches gl
+//-----------------------------------------------------
+void revealSource::threadedFunction(){
+
+    ofVideoPlayer player;
+    player.setUseTexture(false);
+
+    if(!player.load(path)){
+        LT_LOG_ERROR("revealSource") << "couldn't load " << path;
+        return;
+    }
+
+    player.setLoopState(OF_LOOP_NORMAL);
+    player.play();
+
+    while(isThreadRunning()){
+        player.update();
+
+        if(!player.isFrameNew()){
+            sleep(2);
+            continue;
+        }
+
+        //a free slot - or else drop the oldest frame the
+        //main thread hasn't got to yet
+        int slot = -1;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            for(int i = 0; i < REVEAL_NUM_SLOTS; i++){
+                if(states[i] == SLOT_FREE){
+                    slot = i;
+                    break;
+                }
+                if(states[i] == SLOT_READY && (slot < 0 || stamps[i] < stamps[slot])){
+                    slot = i;
+                }
+            }
+            if(slot >= 0) states[slot] = SLOT_WRITING;
+        }
+        if(slot < 0) continue;
+
+        //the copy happens outside the lock
+        slots[slot] = player.getPixels();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        states[slot] = SLOT_READY;
+        stamps[slot] = ++frameCount;
+    }
+
+    player.close();
+}
+
+//-----------------------------------------------------
+bool revealSource::update(){
+    if(!bVideo) return false;
+
+    //take the newest frame - anything older is stale
+    int slot = -1;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for(int i = 0; i < REVEAL_NUM_SLOTS; i++){
+            if(states[i] == SLOT_READY && (slot < 0 || stamps[i] > stamps[slot])){
+                slot = i;
+            }
+        }
+        if(slot < 0) return false;
+
+        for(int i = 0; i < REVEAL_NUM_SLOTS; i++){
+            if(i != slot && states[i] == SLOT_READY) states[i] = SLOT_FREE;
+        }
+        states[slot] = SLOT_UPLOADING;
+    }
+
+    int next = (current + 1) % REVEAL_NUM_TEXTURES;
+    ofPixels & pix = slots[slot];
+    if(!textures[next].isAllocated() || textures[next].getWidth() != pix.getWidth() || textures[next].getHeight() != pix.getHeight()){
+        textures[next].allocate(pix);
+    }
+    textures[next].loadData(pix);
+    current = next;
+    bLoaded = true;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    states[slot] = SLOT_FREE;
+    return true;
+}
+
+//-----------------------------------------------------
+bool revealSource::isLoaded(){
+    return bLoaded;
+}
+
+bool revealSource::isVideo(){
+    return bVideo;
+}
+
+ofTexture & revealSource::getTexture(){
+    return textures[current];
+}
@@ -0,0 +1,62 @@
+#ifndef _REVEAL_SOURCE_H
+#define _REVEAL_SOURCE_H
+
+#include "ofMain.h"
+
+//the picture under the wall for revealBrush - either a still image
+//or a looping video.
+//
+//videos are decoded on their own thread into a small ring of pixel
+//slots. the main thread only ever uploads the newest finished slot
+//into the next texture of a ring of textures, so a slow or fast
+//video never holds up the render loop and we never upload into the
+//texture that is being drawn.
+
+#define REVEAL_NUM_SLOTS	3
+#define REVEAL_NUM_TEXTURES	2
+
+class revealSource : public ofThread{
+
+public:
+
+    revealSource();
+    ~revealSource();
+
+    //images are loaded straight away - videos start the decode thread
+    bool load(string filePath);
+    void close();
+
+    //main thread - uploads the newest decoded frame if there is one
+    //returns true if the texture changed
+    bool update();
+
+    bool isLoaded();
+    bool isVideo();
+
+    ofTexture & getTexture();
+
+protected:
+
+    enum slotState{
+        SLOT_FREE,
+        SLOT_WRITING,
+        SLOT_READY,
+        SLOT_UPLOADING
+    };
+
+    void threadedFunction();
+
+    string path;
+    bool   bLoaded, bVideo;
+
+    //decoded frames - the states and stamps are guarded by mutex
+    ofPixels  slots[REVEAL_NUM_SLOTS];
+    slotState states[REVEAL_NUM_SLOTS];
+    unsigned int stamps[REVEAL_NUM_SLOTS];
+    unsigned int frameCount;
+
+    ofTexture textures[REVEAL_NUM_TEXTURES];
+    int current;
+};
+
+#endif
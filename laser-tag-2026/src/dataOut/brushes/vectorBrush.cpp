@@ -1,4 +1,5 @@
 #include "vectorBrush.h"
+#include "asyncLogger.h"
 
 //------------------------
 void vectorBrush::setupCustom(){
@@ -36,6 +37,11 @@ void vectorBrush::update(){
     FBO.end();
 }
 
+//the strokes only change when points come in
+bool vectorBrush::isAnimating(){
+    return false;
+}
+
 ofTexture & vectorBrush::getTexture(){
     return FBO.getTexture();
 }
@@ -55,7 +61,7 @@ void vectorBrush::clear(){
 void vectorBrush::addPoint(float _x, float _y, bool isNewStroke){
     
     if(whichStroke >= MAX_NUM_STROKES){
-        printf("vectorBrush::addPoint() - maxStrokes reached\n");
+        LT_LOG_LIMITED(OF_LOG_NOTICE, "vectorBrush") << "addPoint - maxStrokes reached";
         return;
     }
     
@@ -63,7 +69,7 @@ void vectorBrush::addPoint(float _x, float _y, bool isNewStroke){
         whichStroke++;
         
         if(whichStroke >= MAX_NUM_STROKES){
-            printf("vectorBrush::addPoint() - maxStrokes reached\n");
+            LT_LOG_LIMITED(OF_LOG_NOTICE, "vectorBrush") << "addPoint - maxStrokes reached";
             return;
         }
         
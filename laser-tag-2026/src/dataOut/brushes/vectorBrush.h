@@ -32,6 +32,7 @@ public:
     void setupCustom();
     void clear();
     void update();
+    bool isAnimating();
     void addPoint(float _x, float _y, bool isNewStroke);
     void draw(int x, int y, int w, int h);
     ofTexture & getTexture();
@@ -0,0 +1,210 @@
+#include "canvasSnapshot.h"
+#include "asyncLogger.h"
+
+//-----------------------------------------------------
+canvasSnapshot::canvasSnapshot(){
+    width  = 0;
+    height = 0;
+    folder = "snapshots/";
+
+    bJpeg           = false;
+    quality         = OF_IMAGE_QUALITY_HIGH;
+    intervalMinutes = 0;
+    lastAutoTime    = 0;
+
+    bRequested       = false;
+    bReadbackPending = false;
+    readbackFrame    = 0;
+
+    numInFlight = 0;
+    numSaved    = 0;
+}
+
+canvasSnapshot::~canvasSnapshot(){
+    close();
+}
+
+//-----------------------------------------------------
+void canvasSnapshot::setup(int w, int h, string saveFolder){
+
+    //a readback at the old size can't be finished anymore
+    if(bReadbackPending){
+        bReadbackPending = false;
+        numInFlight--;
+    }
+
+    width  = w;
+    height = h;
+    folder = saveFolder;
+
+    ofDirectory::createDirectory(folder, true, true);
+
+    //rgba so rows are always 4 byte aligned for the readback
+    fbo.allocate(width, height, GL_RGBA);
+    pbo.allocate(width * height * 4, GL_STREAM_READ);
+
+    bRequested = false;
+    bReadbackPending = false;
+    lastAutoTime = ofGetElapsedTimef();
+
+    if(!isThreadRunning()) startThread();
+}
+
+//-----------------------------------------------------
+void canvasSnapshot::close(){
+    if(isThreadRunning()){
+        //the worker finishes what is queued and then exits
+        toEncode.close();
+        waitForThread(false);
+    }
+}
+
+//-----------------------------------------------------
+void canvasSnapshot::setFormat(bool _bJpeg, int _quality){
+    bJpeg = _bJpeg;
+    if(_quality < 0) _quality = 0;
+    if(_quality > 4) _quality = 4;
+
+    //OF_IMAGE_QUALITY_BEST is 0 and WORST is 4
+    quality = (ofImageQualityType)(4 - _quality);
+}
+
+void canvasSnapshot::setInterval(float minutes){
+    intervalMinutes = minutes;
+}
+
+//-----------------------------------------------------
+void canvasSnapshot::requestSnapshot(){
+    bRequested = true;
+}
+
+bool canvasSnapshot::isBusy(){
+    return bReadbackPending || numInFlight > 0;
+}
+
+int canvasSnapshot::getNumSaved(){
+    return numSaved;
+}
+
+bool canvasSnapshot::getNewSaved(string & fileName){
+    if(saved.tryReceive(fileName)){
+        numSaved++;
+        return true;
+    }
+    return false;
+}
+
+//-----------------------------------------------------
+void canvasSnapshot::update(imageProjection & projection){
+
+    if(width == 0 || height == 0) return;
+
+    //the readback from last frame should be done by now
+    if(bReadbackPending && ofGetFrameNum() - readbackFrame >= SNAPSHOT_READBACK_FRAMES){
+        finishReadback();
+    }
+
+    //periodic snapshots - skipped if we are still busy
+    //with the last one so they can never pile up
+    if(intervalMinutes > 0 && ofGetElapsedTimef() - lastAutoTime >= intervalMinutes * 60.0){
+        lastAutoTime = ofGetElapsedTimef();
+        if(!isBusy()) bRequested = true;
+    }
+
+    if(bRequested && !isBusy()){
+        bRequested = false;
+        startReadback(projection);
+    }
+}
+
+//-----------------------------------------------------
+void canvasSnapshot::prewarm(imageProjection & projection){
+    if(width == 0 || height == 0 || isBusy()) return;
+
+    fbo.begin();
+    ofClear(0, 0, 0, 255);
+    projection.drawCanvas(0, 0, width, height);
+    fbo.end();
+
+    fbo.getTexture().copyTo(pbo);
+    pbo.map<unsigned char>(GL_READ_ONLY);
+    pbo.unmap();
+}
+
+//-----------------------------------------------------
+void canvasSnapshot::startReadback(imageProjection & projection){
+
+    fbo.begin();
+    ofClear(0, 0, 0, 255);
+    projection.drawCanvas(0, 0, width, height);
+    fbo.end();
+
+    //copies into the buffer on the gpu - returns straight away
+    fbo.getTexture().copyTo(pbo);
+
+    pendingPath = folder + "laser-tag-" + ofGetTimestampString("%Y-%m-%d-%H-%M-%S-%i") + (bJpeg ? ".jpg" : ".png");
+    readbackFrame = ofGetFrameNum();
+    bReadbackPending = true;
+    numInFlight++;
+}
+
+//-----------------------------------------------------
+void canvasSnapshot::finishReadback(){
+
+    bReadbackPending = false;
+
+    snapshotJob job;
+
+    //reuse a buffer the worker has finished with if we can
+    if(!recycled.tryReceive(job.pixels) || (int)job.pixels.getWidth() != width || (int)job.pixels.getHeight() != height){
+        job.pixels.allocate(width, height, OF_PIXELS_RGBA);
+    }
+
+    unsigned char * data = pbo.map<unsigned char>(GL_READ_ONLY);
+    if(data != NULL){
+        memcpy(job.pixels.getData(), data, width * height * 4);
+    }
+    pbo.unmap();
+
+    if(data == NULL){
+        LT_LOG_ERROR("canvasSnapshot") << "couldn't map the readback buffer";
+        numInFlight--;
+        return;
+    }
+
+    job.filePath = pendingPath;
+    job.quality  = quality;
+    toEncode.send(std::move(job));
+}
+
+//-----------------------------------------------------
+void canvasSnapshot::threadedFunction(){
+
+    snapshotJob job;
+    ofPixels rgb;
+
+    while(toEncode.receive(job)){
+
+        //drop the alpha - jpeg can't store it and the canvas is opaque
+        rgb.allocate(job.pixels.getWidth(), job.pixels.getHeight(), OF_PIXELS_RGB);
+        const unsigned char * src = job.pixels.getData();
+        unsigned char * dst = rgb.getData();
+        size_t numPixels = job.pixels.getWidth() * job.pixels.getHeight();
+        for(size_t i = 0; i < numPixels; i++){
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            src += 4;
+            dst += 3;
+        }
+
+        if(ofSaveImage(rgb, job.filePath, job.quality)){
+            saved.send(ofFilePath::getFileName(job.filePath));
+        }else{
+            LT_LOG_ERROR("canvasSnapshot") << "couldn't save " << job.filePath;
+        }
+
+        recycled.send(std::move(job.pixels));
+        numInFlight--;
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef _CANVAS_SNAPSHOT_H
+#define _CANVAS_SNAPSHOT_H
+
+#include "ofMain.h"
+#include "imageProjection.h"
+
+//saves what is on the wall as a png or jpeg without stalling
+//the projection.
+//
+//frame N    - the canvas is drawn into an fbo and copied into a
+//             pixel buffer object - the gpu does this in the background
+//frame N+1  - the buffer is mapped and copied out
+//worker     - encoding and writing the file happens on our own thread
+//
+//only one snapshot is in flight at a time - periodic snapshots are
+//skipped rather than queued if the previous one is still encoding
+
+#define SNAPSHOT_READBACK_FRAMES 1	//frames to wait before mapping the buffer
+
+class canvasSnapshot : public ofThread{
+
+public:
+
+    canvasSnapshot();
+    ~canvasSnapshot();
+
+    void setup(int w, int h, string saveFolder);
+    void close();
+
+    //quality is 0 (smallest) - 4 (best) - png is always lossless
+    void setFormat(bool bJpeg, int quality);
+
+    //0 turns periodic snapshots off
+    void setInterval(float minutes);
+
+    void requestSnapshot();
+
+    //call once per frame from the gl thread
+    void update(imageProjection & projection);
+
+    //one readback at startup that isn't saved - the driver sets
+    //up the buffer then and not on the first real snapshot
+    void prewarm(imageProjection & projection);
+
+    bool isBusy();
+    int getNumSaved();
+
+    //returns true once for every file written
+    bool getNewSaved(string & fileName);
+
+protected:
+
+    struct snapshotJob{
+        ofPixels pixels;
+        string   filePath;
+        ofImageQualityType quality;
+    };
+
+    void startReadback(imageProjection & projection);
+    void finishReadback();
+    void threadedFunction();
+
+    ofFbo fbo;
+    ofBufferObject pbo;
+
+    int width, height;
+    string folder;
+
+    bool  bJpeg;
+    ofImageQualityType quality;
+    float intervalMinutes;
+    float lastAutoTime;
+
+    bool bRequested;
+    bool bReadbackPending;
+    int  readbackFrame;
+    string pendingPath;
+
+    //jobs go to the worker - pixel buffers come back to be reused
+    ofThreadChannel<snapshotJob> toEncode;
+    ofThreadChannel<ofPixels>    recycled;
+    ofThreadChannel<string>      saved;
+
+    std::atomic<int> numInFlight;
+    int numSaved;
+};
+
+#endif
@@ -0,0 +1,417 @@
+#include "colorCorrection.h"
+#include "asyncLogger.h"
+
+//the projected texture is drawn by openFrameworks so it can
+//either be a rectangle texture or a normalised 2D texture
+//we pick the sampler when the shader is built
+static const string lutVertShader =
+"#version 120\n"
+"void main(){\n"
+"    gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;\n"
+"    gl_FrontColor  = gl_Color;\n"
+"    gl_Position    = ftransform();\n"
+"}\n";
+
+static const string lutFragShaderBody =
+"uniform sampler3D lut;\n"
+"uniform float lutSize;\n"
+"uniform vec3 domainMin;\n"
+"uniform vec3 domainMax;\n"
+"uniform float gamma;\n"
+"uniform float brightness;\n"
+"void main(){\n"
+"    vec4 src = SAMPLE_TEX(tex0, gl_TexCoord[0].st) * gl_Color;\n"
+"    vec3 c   = pow(clamp(src.rgb, 0.0, 1.0), vec3(gamma));\n"
+"    c = clamp((c - domainMin) / (domainMax - domainMin), 0.0, 1.0);\n"
+"    c = c * ((lutSize - 1.0) / lutSize) + 0.5 / lutSize;\n"
+"    gl_FragColor = vec4(texture3D(lut, c).rgb * brightness, src.a);\n"
+"}\n";
+
+//-----------------------------------------------------
+colorCorrection::colorCorrection(){
+    currentLut    = -1;
+    size          = 0;
+    gamma         = 1.0;
+    lutTexture    = 0;
+    bLoaded       = false;
+    bTextureDirty = false;
+    bShaderSetup  = false;
+
+    for(int i = 0; i < 3; i++){
+        domainMin[i] = 0.0;
+        domainMax[i] = 1.0;
+    }
+}
+
+//-----------------------------------------------------
+colorCorrection::~colorCorrection(){
+    if(lutTexture != 0){
+        glDeleteTextures(1, &lutTexture);
+    }
+}
+
+//reads a directory for .cube files
+//------------------------
+int colorCorrection::loadLuts(string lutDir){
+    DL.allowExt("cube");
+    int numLuts = DL.listDir(lutDir);
+    DL.sort();
+
+    if(numLuts == 0){
+        LT_LOG_NOTICE("colorCorrection") << "no .cube files found in " << lutDir;
+    }
+    return numLuts;
+}
+
+//-----------------------------------------------------
+bool colorCorrection::selectLut(int which){
+    if(getNumLuts() == 0) return false;
+
+    if(which < 0) which = 0;
+    if(which >= getNumLuts()) which = getNumLuts() - 1;
+    if(which == currentLut && bLoaded) return true;
+
+    currentLut = which;
+    return loadCube(DL.getPath(currentLut));
+}
+
+//-----------------------------------------------------
+int colorCorrection::getNumLuts(){
+    return DL.size();
+}
+
+//-----------------------------------------------------
+string colorCorrection::getLutName(){
+    if(currentLut < 0 || currentLut >= getNumLuts()) return "";
+    return DL.getName(currentLut);
+}
+
+//.cube is plain text - a few keywords and then
+//size^3 lines of r g b with red changing fastest
+//-----------------------------------------------------
+bool colorCorrection::loadCube(string filePath){
+
+    ifstream file(ofToDataPath(filePath).c_str());
+    if(!file.is_open()){
+        LT_LOG_ERROR("colorCorrection") << "could not open " << filePath;
+        return false;
+    }
+
+    vector<float> newTable;
+    int   newSize = 0;
+    float newMin[3] = {0.0, 0.0, 0.0};
+    float newMax[3] = {1.0, 1.0, 1.0};
+
+    string line;
+    while(getline(file, line)){
+
+        if(line.empty() || line[0] == '#') continue;
+
+        istringstream ss(line);
+        string key;
+        ss >> key;
+
+        if(key.empty() || key == "TITLE") continue;
+
+        if(key == "LUT_1D_SIZE"){
+            LT_LOG_ERROR("colorCorrection") << filePath << " is a 1D LUT - only 3D luts are supported";
+            return false;
+        }
+        else if(key == "LUT_3D_SIZE"){
+            ss >> newSize;
+            if(newSize < 2 || newSize > LUT_MAX_SIZE){
+                LT_LOG_ERROR("colorCorrection") << filePath << " has unsupported size " << newSize;
+                return false;
+            }
+            newTable.reserve(newSize * newSize * newSize * 3);
+        }
+        else if(key == "DOMAIN_MIN"){
+            ss >> newMin[0] >> newMin[1] >> newMin[2];
+        }
+        else if(key == "DOMAIN_MAX"){
+            ss >> newMax[0] >> newMax[1] >> newMax[2];
+        }
+        else{
+            //should be a data line
+            float r, g, b;
+            istringstream data(line);
+            if(data >> r >> g >> b){
+                newTable.push_back(r);
+                newTable.push_back(g);
+                newTable.push_back(b);
+            }
+        }
+    }
+
+    if(newSize == 0 || (int)newTable.size() != newSize * newSize * newSize * 3){
+        LT_LOG_ERROR("colorCorrection") << filePath << " expected " << newSize * newSize * newSize << " entries, found " << newTable.size() / 3;
+        return false;
+    }
+
+    for(int i = 0; i < 3; i++){
+        if(newMax[i] <= newMin[i]){
+            LT_LOG_ERROR("colorCorrection") << filePath << " has an invalid domain";
+            return false;
+        }
+        domainMin[i] = newMin[i];
+        domainMax[i] = newMax[i];
+    }
+
+    table.swap(newTable);
+    size          = newSize;
+    bLoaded       = true;
+    bTextureDirty = true;
+
+    LT_LOG_NOTICE("colorCorrection") << "loaded " << size << "^3 lut from " << filePath;
+    return true;
+}
+
+//handy for checking the pipeline - should look exactly
+//like the uncorrected image
+//-----------------------------------------------------
+void colorCorrection::setIdentity(int _size){
+    if(_size < 2) _size = 2;
+    if(_size > LUT_MAX_SIZE) _size = LUT_MAX_SIZE;
+
+    size = _size;
+    table.resize(size * size * size * 3);
+
+    float step = 1.0 / (float)(size - 1);
+    int k = 0;
+    for(int b = 0; b < size; b++){
+        for(int g = 0; g < size; g++){
+            for(int r = 0; r < size; r++){
+                table[k++] = r * step;
+                table[k++] = g * step;
+                table[k++] = b * step;
+            }
+        }
+    }
+
+    for(int i = 0; i < 3; i++){
+        domainMin[i] = 0.0;
+        domainMax[i] = 1.0;
+    }
+
+    bLoaded       = true;
+    bTextureDirty = true;
+}
+
+//-----------------------------------------------------
+void colorCorrection::setGamma(float _gamma){
+    if(_gamma < 0.01) _gamma = 0.01;
+    gamma = _gamma;
+}
+
+//-----------------------------------------------------
+float colorCorrection::getGamma(){
+    return gamma;
+}
+
+//-----------------------------------------------------
+bool colorCorrection::isLoaded(){
+    return bLoaded;
+}
+
+//-----------------------------------------------------
+int colorCorrection::getSize(){
+    return size;
+}
+
+///////////////////////////////////////////////////////
+//
+//		CPU REFERENCE PATH
+//
+///////////////////////////////////////////////////////
+
+//trilinear lookup - same as what the 3D texture does
+//with GL_LINEAR filtering
+//-----------------------------------------------------
+void colorCorrection::lookup(float r, float g, float b, float * out){
+
+    float in[3] = {r, g, b};
+    int   i0[3], i1[3];
+    float f[3];
+
+    for(int i = 0; i < 3; i++){
+        float c = (in[i] - domainMin[i]) / (domainMax[i] - domainMin[i]);
+        if(c < 0) c = 0;
+        else if(c > 1) c = 1;
+
+        float p = c * (float)(size - 1);
+        i0[i] = (int)p;
+        if(i0[i] > size - 2) i0[i] = size - 2;
+        i1[i] = i0[i] + 1;
+        f[i]  = p - (float)i0[i];
+    }
+
+    int slice = size * size;
+
+    for(int ch = 0; ch < 3; ch++){
+        float c000 = table[3 * (i0[0] + i0[1] * size + i0[2] * slice) + ch];
+        float c100 = table[3 * (i1[0] + i0[1] * size + i0[2] * slice) + ch];
+        float c010 = table[3 * (i0[0] + i1[1] * size + i0[2] * slice) + ch];
+        float c110 = table[3 * (i1[0] + i1[1] * size + i0[2] * slice) + ch];
+        float c001 = table[3 * (i0[0] + i0[1] * size + i1[2] * slice) + ch];
+        float c101 = table[3 * (i1[0] + i0[1] * size + i1[2] * slice) + ch];
+        float c011 = table[3 * (i0[0] + i1[1] * size + i1[2] * slice) + ch];
+        float c111 = table[3 * (i1[0] + i1[1] * size + i1[2] * slice) + ch];
+
+        float c00 = c000 + (c100 - c000) * f[0];
+        float c10 = c010 + (c110 - c010) * f[0];
+        float c01 = c001 + (c101 - c001) * f[0];
+        float c11 = c011 + (c111 - c011) * f[0];
+
+        float c0 = c00 + (c10 - c00) * f[1];
+        float c1 = c01 + (c11 - c01) * f[1];
+
+        out[ch] = c0 + (c1 - c0) * f[2];
+    }
+}
+
+//-----------------------------------------------------
+void colorCorrection::applyToColor(const float * rgbIn, float * rgbOut, float brightness){
+
+    float c[3];
+    for(int i = 0; i < 3; i++){
+        c[i] = rgbIn[i];
+        if(c[i] < 0) c[i] = 0;
+        else if(c[i] > 1) c[i] = 1;
+        c[i] = powf(c[i], gamma);
+    }
+
+    if(bLoaded){
+        lookup(c[0], c[1], c[2], rgbOut);
+    }else{
+        rgbOut[0] = c[0];
+        rgbOut[1] = c[1];
+        rgbOut[2] = c[2];
+    }
+
+    for(int i = 0; i < 3; i++){
+        rgbOut[i] *= brightness;
+    }
+}
+
+//works on rgb or rgba pixels - alpha is left untouched
+//-----------------------------------------------------
+void colorCorrection::applyToPixels(ofPixels & pix, float brightness){
+
+    int numChannels = pix.getNumChannels();
+    if(numChannels < 3){
+        LT_LOG_ERROR("colorCorrection") << "applyToPixels needs rgb or rgba pixels";
+        return;
+    }
+
+    unsigned char * data = pix.getData();
+    int totalPixels = pix.getWidth() * pix.getHeight();
+
+    float in[3], out[3];
+
+    for(int i = 0; i < totalPixels; i++){
+        unsigned char * p = data + i * numChannels;
+
+        in[0] = p[0] / 255.0;
+        in[1] = p[1] / 255.0;
+        in[2] = p[2] / 255.0;
+
+        applyToColor(in, out, brightness);
+
+        for(int ch = 0; ch < 3; ch++){
+            float v = out[ch] * 255.0 + 0.5;
+            if(v < 0) v = 0;
+            else if(v > 255) v = 255;
+            p[ch] = (unsigned char)v;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////
+//
+//		GPU PATH
+//
+///////////////////////////////////////////////////////
+
+//-----------------------------------------------------
+void colorCorrection::setupShader(){
+
+    string frag = "#version 120\n";
+    if(ofGetUsingArbTex()){
+        frag += "#extension GL_ARB_texture_rectangle : enable\n";
+        frag += "uniform sampler2DRect tex0;\n";
+        frag += "#define SAMPLE_TEX texture2DRect\n";
+    }else{
+        frag += "uniform sampler2D tex0;\n";
+        frag += "#define SAMPLE_TEX texture2D\n";
+    }
+    frag += lutFragShaderBody;
+
+    shader.setupShaderFromSource(GL_VERTEX_SHADER, lutVertShader);
+    shader.setupShaderFromSource(GL_FRAGMENT_SHADER, frag);
+    shader.linkProgram();
+
+    bShaderSetup = true;
+}
+
+//16 bit normalised is supported everywhere and
+//is plenty for a 33^3 lut
+//-----------------------------------------------------
+void colorCorrection::uploadTexture(){
+
+    vector<unsigned short> data(table.size());
+    for(int i = 0; i < (int)table.size(); i++){
+        float v = table[i];
+        if(v < 0) v = 0;
+        else if(v > 1) v = 1;
+        data[i] = (unsigned short)(v * 65535.0 + 0.5);
+    }
+
+    if(lutTexture == 0){
+        glGenTextures(1, &lutTexture);
+    }
+
+    glBindTexture(GL_TEXTURE_3D, lutTexture);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB16, size, size, size, 0, GL_RGB, GL_UNSIGNED_SHORT, &data[0]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    bTextureDirty = false;
+}
+
+//-----------------------------------------------------
+void colorCorrection::begin(float brightness){
+    if(!bLoaded) return;
+
+    if(!bShaderSetup) setupShader();
+    if(bTextureDirty) uploadTexture();
+
+    shader.begin();
+    shader.setUniform1i("tex0", 0);
+    shader.setUniform1i("lut", 1);
+    shader.setUniform1f("lutSize", (float)size);
+    shader.setUniform3f("domainMin", domainMin[0], domainMin[1], domainMin[2]);
+    shader.setUniform3f("domainMax", domainMax[0], domainMax[1], domainMax[2]);
+    shader.setUniform1f("gamma", gamma);
+    shader.setUniform1f("brightness", brightness);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, lutTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+//-----------------------------------------------------
+void colorCorrection::end(){
+    if(!bLoaded) return;
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.end();
+}
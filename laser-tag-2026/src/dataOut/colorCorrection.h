@@ -0,0 +1,66 @@
+#ifndef _COLOR_CORRECTION_H
+#define _COLOR_CORRECTION_H
+
+#include "ofMain.h"
+
+//per projector color matching - loads a 3D LUT from a .cube
+//file and applies it together with gamma and brightness in
+//the final projection pass. the same maths is available on
+//the cpu so results can be checked without a gl context.
+//
+//order of operations is:  pow(color, gamma) -> LUT -> * brightness
+
+#define LUT_MAX_SIZE 65
+
+class colorCorrection{
+
+public:
+
+    colorCorrection();
+    ~colorCorrection();
+
+    //lists all .cube files in a folder - like pngBrush::loadbrushes
+    int  loadLuts(string lutDir);
+    bool selectLut(int which);
+    int  getNumLuts();
+    string getLutName();
+
+    //parses a .cube file - only 3D luts are supported
+    bool loadCube(string filePath);
+    void setIdentity(int size);
+
+    void setGamma(float _gamma);
+    float getGamma();
+    bool isLoaded();
+    int getSize();
+
+    //cpu reference path - rgb values are 0-1
+    void applyToColor(const float * rgbIn, float * rgbOut, float brightness);
+    void applyToPixels(ofPixels & pix, float brightness);
+
+    //gpu path - wrap the texture draw with these
+    //brightness is 0-1
+    void begin(float brightness);
+    void end();
+
+protected:
+
+    void lookup(float r, float g, float b, float * out);
+    void uploadTexture();
+    void setupShader();
+
+    ofDirectory DL;
+    int currentLut;
+
+    vector<float> table;	//rgb triplets - red changes fastest
+    int   size;
+    float domainMin[3];
+    float domainMax[3];
+    float gamma;
+
+    ofShader shader;
+    GLuint lutTexture;
+    bool bLoaded, bTextureDirty, bShaderSetup;
+};
+
+#endif
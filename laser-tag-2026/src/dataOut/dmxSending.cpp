@@ -0,0 +1,418 @@
+#include "dmxSending.h"
+#include "asyncLogger.h"
+#include "UdpSocket.h"
+#include "IpEndpointName.h"
+
+static const char SACN_SOURCE_NAME[] = "laser-tag-2026";
+
+// ------------------------
+dmxSending::dmxSending(){
+    bSetup       = false;
+    protocol     = DMX_ARTNET;
+    host         = "127.0.0.1";
+    numUniverses = 0;
+    numMappings  = 0;
+    headerSize   = ARTNET_HEADER_SIZE;
+    packetsSent  = 0;
+    socket       = NULL;
+    endpoints    = NULL;
+
+    lastX = lastY = lastTime = 0;
+
+    state.x = state.y = 0;
+    state.speed      = 0;
+    state.lastSeen   = -DMX_DRAW_TIMEOUT;
+    state.bNewStroke = false;
+    state.r = state.g = state.b = 255;
+
+    memset(packets, 0, sizeof(packets));
+    memset(sequence, 0, sizeof(sequence));
+
+    //sACN wants a unique id per source - it only needs to
+    //stay the same while we are running
+    for(int i = 0; i < 16; i++){
+        cid[i] = (unsigned char)ofRandom(0, 255);
+    }
+
+    xml.setVerbose(false);
+}
+
+dmxSending::~dmxSending(){
+    close();
+}
+
+//-------------------------
+int dmxSending::parseSource(string name){
+    name = ofToLower(name);
+    if(name == "x")         return DMX_SRC_X;
+    if(name == "y")         return DMX_SRC_Y;
+    if(name == "speed")     return DMX_SRC_SPEED;
+    if(name == "drawing")   return DMX_SRC_DRAWING;
+    if(name == "newstroke") return DMX_SRC_NEW_STROKE;
+    if(name == "red")       return DMX_SRC_RED;
+    if(name == "green")     return DMX_SRC_GREEN;
+    if(name == "blue")      return DMX_SRC_BLUE;
+    if(name == "fixed")     return DMX_SRC_FIXED;
+    return -1;
+}
+
+//-------------------------
+bool dmxSending::loadMapping(string filePath){
+
+    if(isThreadRunning()){
+        LT_LOG_ERROR("dmxSending") << "close before loading a new mapping";
+        return false;
+    }
+
+    if(!xml.loadFile(ofToDataPath(filePath))){
+        LT_LOG_ERROR("dmxSending") << "couldn't load " << filePath;
+        return false;
+    }
+
+    host = xml.getValue("HOST", "127.0.0.1");
+    protocol = ofToLower(xml.getValue("PROTOCOL", "artnet")) == "sacn" ? DMX_SACN : DMX_ARTNET;
+
+    numUniverses = 0;
+    numMappings  = 0;
+
+    int numTags = xml.getNumTags("CHANNEL");
+    for(int i = 0; i < numTags; i++){
+
+        if(numMappings >= DMX_MAX_MAPPINGS){
+            LT_LOG_ERROR("dmxSending") << "too many channels - max is " << DMX_MAX_MAPPINGS;
+            break;
+        }
+
+        xml.pushTag("CHANNEL", i);
+
+        dmxMapping & m = mappings[numMappings];
+
+        m.source = parseSource(xml.getValue("SOURCE", "none"));
+        m.address = xml.getValue("ADDRESS", 0);
+        m.bFine = xml.getValue("FINE", 0) != 0;
+
+        int universe = xml.getValue("UNIVERSE", 0);
+
+        //speed is in screen widths per second - everything
+        //else is already 0 - 1
+        float defaultMax = (m.source == DMX_SRC_SPEED) ? 2.0 : 1.0;
+        m.inMin  = xml.getValue("IN_MIN", 0.0);
+        m.inMax  = xml.getValue("IN_MAX", (double)defaultMax);
+        m.outMin = xml.getValue("OUT_MIN", 0);
+        m.outMax = xml.getValue("OUT_MAX", m.bFine ? 65535 : 255);
+
+        //fixed channels just hold a value
+        if(m.source == DMX_SRC_FIXED){
+            m.inMin = 0;
+            m.inMax = 1;
+            m.outMin = m.outMax = xml.getValue("VALUE", 0);
+        }
+
+        xml.popTag();
+
+        int lastAddress = m.bFine ? DMX_UNIVERSE_SIZE-1 : DMX_UNIVERSE_SIZE;
+        if(m.source < 0 || m.address < 1 || m.address > lastAddress){
+            LT_LOG_ERROR("dmxSending") << "skipping channel " << i << " - bad source or address";
+            continue;
+        }
+
+        if(protocol == DMX_SACN && universe < 1){
+            LT_LOG_ERROR("dmxSending") << "sACN universes start at 1 - using 1 for channel " << i;
+            universe = 1;
+        }
+
+        //find or add the universe
+        m.universe = -1;
+        for(int u = 0; u < numUniverses; u++){
+            if(universeNumbers[u] == universe) m.universe = u;
+        }
+        if(m.universe == -1){
+            if(numUniverses >= DMX_MAX_UNIVERSES){
+                LT_LOG_ERROR("dmxSending") << "too many universes - max is " << DMX_MAX_UNIVERSES;
+                continue;
+            }
+            universeNumbers[numUniverses] = universe;
+            m.universe = numUniverses;
+            numUniverses++;
+        }
+
+        numMappings++;
+    }
+
+    LT_LOG_NOTICE("dmxSending") << "loaded " << numMappings << " channels in " << numUniverses << " universes for " << getProtocolName();
+    return numMappings > 0;
+}
+
+//-------------------------
+bool dmxSending::setup(){
+
+    close();
+
+    if(numUniverses == 0){
+        LT_LOG_ERROR("dmxSending") << "no channels mapped - check settings/dmx.xml";
+        return false;
+    }
+
+    headerSize = (protocol == DMX_SACN) ? SACN_HEADER_SIZE : ARTNET_HEADER_SIZE;
+
+    endpoints = new IpEndpointName[numUniverses];
+
+    try{
+        socket = new UdpSocket();
+        socket->SetEnableBroadcast(true);
+
+        for(int u = 0; u < numUniverses; u++){
+            int uni = universeNumbers[u];
+
+            //sACN can multicast - one group per universe
+            if(protocol == DMX_SACN && host == "multicast"){
+                endpoints[u] = IpEndpointName(239, 255, (uni >> 8) & 0xff, uni & 0xff, SACN_PORT);
+            }else{
+                endpoints[u] = IpEndpointName(host.c_str(), protocol == DMX_SACN ? SACN_PORT : ARTNET_PORT);
+            }
+
+            memset(packets[u], 0, DMX_PACKET_SIZE);
+            dmxData[u] = packets[u] + headerSize;
+            sequence[u] = 0;
+        }
+    }
+    catch(std::exception & e){
+        LT_LOG_ERROR("dmxSending") << "couldn't open socket to " << host << ": " << e.what();
+        close();
+        return false;
+    }
+
+    packetsSent = 0;
+    bSetup = true;
+    startThread();
+
+    return true;
+}
+
+//-------------------------
+void dmxSending::close(){
+    if(isThreadRunning()){
+        stopThread();
+        waitForThread(false);
+    }
+
+    if(socket != NULL){
+        delete socket;
+        socket = NULL;
+    }
+    if(endpoints != NULL){
+        delete [] endpoints;
+        endpoints = NULL;
+    }
+    bSetup = false;
+}
+
+bool dmxSending::isSetup(){
+    return bSetup;
+}
+
+//-------------------------
+void dmxSending::setLaserPos(float x, float y, bool isNewStroke, bool bMoved){
+
+    float now = ofGetElapsedTimef();
+
+    //between camera frames the point is just the last one again - only
+    //when it hasn't moved for a while is the laser really held still
+    if(!bMoved){
+        std::unique_lock<std::mutex> lock(mutex);
+        if(now - lastTime > DMX_DRAW_TIMEOUT) state.speed *= 0.6;
+        state.lastSeen = now;
+        return;
+    }
+
+    //speed in normalized units per second - smoothed a little
+    //as camera frames don't arrive evenly
+    float speed = 0;
+    float dt = now - lastTime;
+    if(!isNewStroke && dt > 0 && dt < DMX_DRAW_TIMEOUT){
+        speed = sqrt((x-lastX)*(x-lastX) + (y-lastY)*(y-lastY)) / dt;
+    }
+    lastX = x;
+    lastY = y;
+    lastTime = now;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    state.x = x;
+    state.y = y;
+    state.speed = state.speed * 0.6 + speed * 0.4;
+    state.lastSeen = now;
+
+    //latched until the send thread has put it in a packet
+    if(isNewStroke) state.bNewStroke = true;
+}
+
+void dmxSending::setLaserColor(unsigned char r, unsigned char g, unsigned char b){
+    std::unique_lock<std::mutex> lock(mutex);
+    state.r = r;
+    state.g = g;
+    state.b = b;
+}
+
+//-------------------------
+int dmxSending::getNumUniverses(){
+    return numUniverses;
+}
+
+int dmxSending::getPacketsSent(){
+    return packetsSent;
+}
+
+string dmxSending::getProtocolName(){
+    return protocol == DMX_SACN ? "sACN" : "Art-Net";
+}
+
+//-------------------------
+float dmxSending::getSourceValue(const dmxMapping & m, const dmxLaserState & s, float now){
+    bool bDrawing = (now - s.lastSeen) < DMX_DRAW_TIMEOUT;
+
+    switch(m.source){
+        case DMX_SRC_X:          return s.x;
+        case DMX_SRC_Y:          return s.y;
+        case DMX_SRC_SPEED:      return bDrawing ? s.speed : 0;
+        case DMX_SRC_DRAWING:    return bDrawing ? 1 : 0;
+        case DMX_SRC_NEW_STROKE: return s.bNewStroke ? 1 : 0;
+        case DMX_SRC_RED:        return s.r / 255.0;
+        case DMX_SRC_GREEN:      return s.g / 255.0;
+        case DMX_SRC_BLUE:       return s.b / 255.0;
+        default:                 return 0;
+    }
+}
+
+//-------------------------
+void dmxSending::buildUniverses(const dmxLaserState & s, float now){
+    for(int i = 0; i < numMappings; i++){
+        const dmxMapping & m = mappings[i];
+
+        float pct = 0;
+        if(m.inMax != m.inMin){
+            pct = (getSourceValue(m, s, now) - m.inMin) / (m.inMax - m.inMin);
+        }
+        if(pct < 0) pct = 0;
+        if(pct > 1) pct = 1;
+
+        int value = m.outMin + (int)(pct * (m.outMax - m.outMin) + 0.5);
+
+        unsigned char * data = dmxData[m.universe];
+        if(m.bFine){
+            if(value > 65535) value = 65535;
+            data[m.address-1] = (value >> 8) & 0xff;
+            data[m.address]   = value & 0xff;
+        }else{
+            if(value > 255) value = 255;
+            data[m.address-1] = value;
+        }
+    }
+}
+
+//-------------------------
+void dmxSending::writeArtnetHeader(unsigned char * pkt, int universe, unsigned char seq){
+    memcpy(pkt, "Art-Net", 8);		//includes the trailing 0
+    pkt[8]  = 0x00;					//OpDmx 0x5000 - little endian
+    pkt[9]  = 0x50;
+    pkt[10] = 0;					//protocol version 14
+    pkt[11] = 14;
+    pkt[12] = seq;
+    pkt[13] = 0;					//physical port
+    pkt[14] = universe & 0xff;		//sub-net + universe
+    pkt[15] = (universe >> 8) & 0x7f;	//net
+    pkt[16] = (DMX_UNIVERSE_SIZE >> 8) & 0xff;
+    pkt[17] = DMX_UNIVERSE_SIZE & 0xff;
+}
+
+//-------------------------
+static void writeFlagsAndLength(unsigned char * p, int length){
+    p[0] = 0x70 | ((length >> 8) & 0x0f);
+    p[1] = length & 0xff;
+}
+
+void dmxSending::writeSacnHeader(unsigned char * pkt, int universe, unsigned char seq){
+
+    //root layer
+    pkt[0] = 0x00; pkt[1] = 0x10;			//preamble size
+    pkt[2] = 0x00; pkt[3] = 0x00;			//postamble size
+    memcpy(pkt + 4, "ASC-E1.17\0\0\0", 12);
+    writeFlagsAndLength(pkt + 16, DMX_PACKET_SIZE - 16);
+    pkt[18] = 0; pkt[19] = 0; pkt[20] = 0; pkt[21] = 0x04;	//VECTOR_ROOT_E131_DATA
+    memcpy(pkt + 22, cid, 16);
+
+    //framing layer
+    writeFlagsAndLength(pkt + 38, DMX_PACKET_SIZE - 38);
+    pkt[40] = 0; pkt[41] = 0; pkt[42] = 0; pkt[43] = 0x02;	//VECTOR_E131_DATA_PACKET
+    memset(pkt + 44, 0, 64);
+    memcpy(pkt + 44, SACN_SOURCE_NAME, sizeof(SACN_SOURCE_NAME));
+    pkt[108] = 100;							//priority
+    pkt[109] = 0; pkt[110] = 0;				//sync address
+    pkt[111] = seq;
+    pkt[112] = 0;							//options
+    pkt[113] = (universe >> 8) & 0xff;
+    pkt[114] = universe & 0xff;
+
+    //dmp layer
+    writeFlagsAndLength(pkt + 115, DMX_PACKET_SIZE - 115);
+    pkt[117] = 0x02;						//VECTOR_DMP_SET_PROPERTY
+    pkt[118] = 0xa1;						//address + data type
+    pkt[119] = 0; pkt[120] = 0;				//first property address
+    pkt[121] = 0; pkt[122] = 1;				//address increment
+    pkt[123] = ((DMX_UNIVERSE_SIZE+1) >> 8) & 0xff;
+    pkt[124] = (DMX_UNIVERSE_SIZE+1) & 0xff;
+    pkt[125] = 0;							//dmx start code
+}
+
+//-------------------------
+void dmxSending::sendUniverses(){
+    int packetSize = headerSize + DMX_UNIVERSE_SIZE;
+
+    for(int u = 0; u < numUniverses; u++){
+        //art-net says 0 means 'no sequence' so skip it
+        sequence[u]++;
+        if(protocol == DMX_ARTNET && sequence[u] == 0) sequence[u] = 1;
+
+        if(protocol == DMX_SACN){
+            writeSacnHeader(packets[u], universeNumbers[u], sequence[u]);
+        }else{
+            writeArtnetHeader(packets[u], universeNumbers[u], sequence[u]);
+        }
+
+        try{
+            socket->SendTo(endpoints[u], (const char *)packets[u], packetSize);
+            packetsSent++;
+        }
+        catch(std::exception & e){
+            LT_LOG_ERROR("dmxSending") << "send failed: " << e.what();
+        }
+    }
+}
+
+//-------------------------
+void dmxSending::threadedFunction(){
+
+    const std::chrono::microseconds period(1000000 / DMX_SEND_HZ);
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+
+    dmxLaserState local;
+
+    while(isThreadRunning()){
+
+        //take a copy so the main thread is never blocked on the network
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            local = state;
+            state.bNewStroke = false;
+        }
+
+        buildUniverses(local, ofGetElapsedTimef());
+        sendUniverses();
+
+        //fixed rate - if we fell behind (eg the machine stalled)
+        //start again from now instead of bursting to catch up
+        next += period;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if(next < now) next = now;
+        std::this_thread::sleep_until(next);
+    }
+}
@@ -0,0 +1,136 @@
+#ifndef _DMX_SENDING_H
+#define _DMX_SENDING_H
+
+#include "ofMain.h"
+#include "ofxXmlSettings.h"
+
+//lighting output - sends dmx universes as art-net or sACN (E1.31)
+//so moving heads / led bars can follow the laser without an
+//external osc to dmx bridge.
+//
+//the mapping from laser state to dmx channels is read from
+//settings/dmx.xml - see the comments in that file.
+//
+//packets go out from our own thread at a fixed rate no matter
+//what the render fps is. all buffers are allocated in setup so
+//nothing is allocated while sending.
+
+#define DMX_SEND_HZ          44
+#define DMX_MAX_UNIVERSES    8
+#define DMX_MAX_MAPPINGS     128
+#define DMX_UNIVERSE_SIZE    512
+#define DMX_DRAW_TIMEOUT     0.25	//seconds without a laser before we stop 'drawing'
+
+#define ARTNET_PORT          6454
+#define ARTNET_HEADER_SIZE   18
+#define SACN_PORT            5568
+#define SACN_HEADER_SIZE     126
+#define DMX_PACKET_SIZE      (SACN_HEADER_SIZE + DMX_UNIVERSE_SIZE)
+
+class UdpSocket;
+class IpEndpointName;
+
+enum{
+    DMX_ARTNET = 0,
+    DMX_SACN
+};
+
+enum{
+    DMX_SRC_X = 0,
+    DMX_SRC_Y,
+    DMX_SRC_SPEED,
+    DMX_SRC_DRAWING,
+    DMX_SRC_NEW_STROKE,
+    DMX_SRC_RED,
+    DMX_SRC_GREEN,
+    DMX_SRC_BLUE,
+    DMX_SRC_FIXED
+};
+
+//one dmx channel (or coarse/fine pair) driven by one laser value
+struct dmxMapping{
+    int   universe;		//index into our universe list
+    int   address;		//1 - 512
+    int   source;
+    float inMin, inMax;
+    int   outMin, outMax;
+    bool  bFine;		//16 bit - coarse on address, fine on address+1
+};
+
+//what the main thread hands over to the send thread
+struct dmxLaserState{
+    float x, y;
+    float speed;
+    float lastSeen;
+    bool  bNewStroke;
+    unsigned char r, g, b;
+};
+
+class dmxSending : public ofThread{
+
+public:
+
+    dmxSending();
+    ~dmxSending();
+
+    //reads host, protocol and the channel mapping
+    bool loadMapping(string filePath);
+
+    //opens the socket and starts the send thread
+    bool setup();
+    void close();
+    bool isSetup();
+
+    //main thread - call every frame the tracker sees the laser.
+    //bMoved is false when the tracker has no new point - a laser held
+    //still keeps drawing and only its speed runs down
+    void setLaserPos(float x, float y, bool isNewStroke, bool bMoved);
+    void setLaserColor(unsigned char r, unsigned char g, unsigned char b);
+
+    int getNumUniverses();
+    int getPacketsSent();
+    string getProtocolName();
+
+protected:
+
+    void threadedFunction();
+
+    void buildUniverses(const dmxLaserState & state, float now);
+    void sendUniverses();
+    void writeArtnetHeader(unsigned char * pkt, int universe, unsigned char sequence);
+    void writeSacnHeader(unsigned char * pkt, int universe, unsigned char sequence);
+
+    float getSourceValue(const dmxMapping & m, const dmxLaserState & state, float now);
+    int   parseSource(string name);
+
+    ofxXmlSettings xml;
+
+    string host;
+    int    protocol;
+    bool   bSetup;
+
+    int numUniverses;
+    int universeNumbers[DMX_MAX_UNIVERSES];
+    unsigned char sequence[DMX_MAX_UNIVERSES];
+    unsigned char packets[DMX_MAX_UNIVERSES][DMX_PACKET_SIZE];
+    unsigned char * dmxData[DMX_MAX_UNIVERSES];	//points into packets
+    int headerSize;
+
+    int numMappings;
+    dmxMapping mappings[DMX_MAX_MAPPINGS];
+
+    unsigned char cid[16];
+
+    //shared with the main thread - guarded by mutex
+    dmxLaserState state;
+
+    //per frame bookkeeping on the main thread
+    float lastX, lastY, lastTime;
+
+    UdpSocket * socket;
+    IpEndpointName * endpoints;		//one per universe
+
+    int packetsSent;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "drips.h"
+#include "asyncLogger.h"
 
 //-----------------------------------
 drip::drip(){
@@ -195,6 +196,13 @@ drips::drips(){
     blue        = 255;
     alpha       = 255;
     bSetup        = false;
+    random      = &ownRandom;
+    pixels      = NULL;
+}
+
+//------------------------------------
+drips::~drips(){
+    delete [] pixels;
 }
 
 //------------------------------------
@@ -204,8 +212,8 @@ void drips::setup(int w, int h){
     width  = w;
     height = h;
     
+    //brushes that hand us their own pixels never need ours
     totalPixels = width * height * 4;
-    pixels = new unsigned char[totalPixels];
     
     clear();
     bSetup = true;
@@ -228,7 +236,7 @@ void drips::clear(){
     
     currentDrip = 0;
     numDrips    = 0;
-    memset(pixels, 0, totalPixels);
+    if(pixels != NULL) memset(pixels, 0, totalPixels);
 }
 
 //-------------------------------------
@@ -261,10 +269,15 @@ int drips::getWidth(){
     return dripWidth;
 }
 
+//-------------------------------------
+void drips::setRandom(brushRandom * _random){
+    random = _random != NULL ? _random : &ownRandom;
+}
+
 //------------------------------------
 bool drips::addDrip(int x, int y){
     if(!bSetup){
-        printf("addDrip: call setup first!!\n");
+        LT_LOG_ERROR("drips") << "addDrip: call setup first!!";
         return false;
     }
     
@@ -280,19 +293,19 @@ bool drips::addDrip(int x, int y){
     float length = 0;
                 
     if(direction == 0){
-        if(height - y > 0)length = rand()%(height/3);
+        if(height - y > 0)length = random->below(height/3);
     }
     else
     if(direction == 1){
-        if(x > 0)length = rand()%x;
+        if(x > 0)length = random->below(x);
     }
     else
     if(direction == 2){
-        if(y > 0)length = rand()%y;
+        if(y > 0)length = random->below(y);
     }
     else
     if(direction == 3){
-        if(width - x > 0)length = rand()%(width - x);
+        if(width - x > 0)length = random->below(width - x);
     }
     
     length *= 0.75;
@@ -303,7 +316,7 @@ bool drips::addDrip(int x, int y){
     }
                 
     DRIP[numDrips].reset();
-    DRIP[numDrips].setup(x, y, width, height, direction, (int)ofRandom(150), speed, dripWidth);
+    DRIP[numDrips].setup(x, y, width, height, direction, (int)random->uniform(150), speed, dripWidth);
     DRIP[numDrips].setColor(red, green, blue);
     DRIP[numDrips].startDripping();
     
@@ -317,7 +330,7 @@ bool drips::addDrip(int x, int y){
 //-----------------------------------
 void drips::updateDrips(unsigned char * pix){
     if(!bSetup){
-        printf("addDrip: call setup first!!\n");
+        LT_LOG_ERROR("drips") << "updateDrips: call setup first!!";
         return;
     }
 
@@ -339,11 +352,24 @@ void drips::updateDrips(unsigned char * pix){
 
 //-----------------------------------
 void drips::updateDrips(){
-    updateDrips(pixels);
+    updateDrips(getPixels());
+}
+
+//true while any drip is still running
+//-----------------------------------
+bool drips::isDripping(){
+    for(int i = 0; i < numDrips; i++){
+        if(DRIP[i].isDripping()) return true;
+    }
+    return false;
 }
 
 //----------------------------
 unsigned char * drips::getPixels(){
+    if(pixels == NULL){
+        pixels = new unsigned char[totalPixels];
+        memset(pixels, 0, totalPixels);
+    }
     return pixels;
 }
 
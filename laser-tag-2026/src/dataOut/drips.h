@@ -3,8 +3,14 @@
 
 #include "ofMain.h"
 #include "miscUtils.h"
+#include "brushRandom.h"
 
+//all of these are allocated up front - about 7mb at full size
+#ifdef LT_LOW_MEMORY
+#define MAX_DRIPS 10000
+#else
 #define MAX_DRIPS 100000
+#endif
 
 class drip{
     
@@ -45,6 +51,7 @@ public:
     
     //------------------------------------
     drips();
+    ~drips();
     void setup(int w, int h);
     void setColor(int r, int g, int b);
     void clear();
@@ -54,9 +61,15 @@ public:
     float getSpeed();
     void setWidth(int dWidth);
     int getWidth();
+    
+    //the brush that owns us hands us its generator
+    void setRandom(brushRandom * _random);
     bool addDrip(int x, int y);
     void updateDrips(unsigned char * pix);
     void updateDrips();
+    bool isDripping();
+    
+    //our own canvas - only made if something asks for it
     unsigned char * getPixels();
     
 protected:
@@ -74,6 +87,9 @@ protected:
     drip DRIP[MAX_DRIPS];
     unsigned char * pixels;
     
+    brushRandom   ownRandom;
+    brushRandom * random;
+    
 };
 
 #endif
@@ -15,6 +15,9 @@ imageProjection::imageProjection(){
     
     brightness		= 100;
     bGreyscaleTexture   = false;
+    bUseLut             = false;
+    bRevealShaderSetup  = false;
+    sceneTexture        = NULL;
     
     whichToolSelected = 0;
     
@@ -33,6 +36,15 @@ void imageProjection::setup(int _width, int _height){
     
     colorTexture.allocate(width, height, GL_RGBA);
     greyscaleTexture.allocate(width, height, GL_LUMINANCE);
+    
+    //only made once revealBrush is used - but if it has been it
+    //has to follow the projection size
+    if(revealFbo.isAllocated() && (revealFbo.getWidth() != width || revealFbo.getHeight() != height)){
+        revealFbo.allocate(width, height, GL_RGB);
+    }
+    
+    //stored scenes are for the old size
+    sceneTexture = NULL;
 }
 
 void imageProjection::setColorTexture(ofTexture & tex){
@@ -44,6 +56,94 @@ void imageProjection::setGrayTexture(ofTexture & tex){
     bGreyscaleTexture = true;
 }
 
+//the picture can be any size - it is stretched over the canvas.
+//the mask and picture can be rectangle or normalised textures so
+//we turn the coords of one into the other with their tex_t / tex_u
+//-----------------------------------------------------
+static const string revealVertShader =
+"#version 120\n"
+"void main(){\n"
+"    gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;\n"
+"    gl_FrontColor  = gl_Color;\n"
+"    gl_Position    = ftransform();\n"
+"}\n";
+
+static const string revealFragShaderBody =
+"uniform vec2 maskScale;\n"
+"uniform vec2 pictureScale;\n"
+"void main(){\n"
+"    vec2  st = gl_TexCoord[0].st;\n"
+"    float m  = SAMPLE_TEX(mask, st).r;\n"
+"    vec3  c  = SAMPLE_TEX(picture, st / maskScale * pictureScale).rgb;\n"
+"    gl_FragColor = vec4(c * m, 1.0) * gl_Color;\n"
+"}\n";
+
+//multiplies the two into a color texture on the gpu so the
+//rest of the projection - lut, preview etc - doesn't change
+//-----------------------------------------------------
+void imageProjection::setRevealTextures(ofTexture & mask, ofTexture & picture){
+    
+    if(!bRevealShaderSetup){
+        string frag = "#version 120\n";
+        if(ofGetUsingArbTex()){
+            frag += "#extension GL_ARB_texture_rectangle : enable\n";
+            frag += "uniform sampler2DRect mask;\n";
+            frag += "uniform sampler2DRect picture;\n";
+            frag += "#define SAMPLE_TEX texture2DRect\n";
+        }else{
+            frag += "uniform sampler2D mask;\n";
+            frag += "uniform sampler2D picture;\n";
+            frag += "#define SAMPLE_TEX texture2D\n";
+        }
+        frag += revealFragShaderBody;
+        
+        revealShader.setupShaderFromSource(GL_VERTEX_SHADER, revealVertShader);
+        revealShader.setupShaderFromSource(GL_FRAGMENT_SHADER, frag);
+        revealShader.linkProgram();
+        
+        bRevealShaderSetup = true;
+    }
+    
+    if(!revealFbo.isAllocated()){
+        revealFbo.allocate(width, height, GL_RGB);
+    }
+    
+    ofTextureData & maskData    = mask.getTextureData();
+    ofTextureData & pictureData = picture.getTextureData();
+    
+    revealFbo.begin();
+    ofPushStyle();
+    ofClear(0, 0, 0, 255);
+    ofSetColor(255, 255, 255);
+    revealShader.begin();
+    revealShader.setUniform1i("mask", 0);
+    revealShader.setUniformTexture("picture", picture, 1);
+    revealShader.setUniform2f("maskScale", maskData.tex_t, maskData.tex_u);
+    revealShader.setUniform2f("pictureScale", pictureData.tex_t, pictureData.tex_u);
+    mask.draw(0, 0, width, height);
+    revealShader.end();
+    ofPopStyle();
+    revealFbo.end();
+    
+    colorTexture = revealFbo.getTexture();
+    bGreyscaleTexture = false;
+}
+
+//-----------------------------------------------------
+void imageProjection::setSceneTexture(ofTexture * tex){
+    sceneTexture = tex;
+}
+
+//the scene goes underneath and the brush is added on top
+//so the scene shows wherever nothing has been painted
+//-----------------------------------------------------
+void imageProjection::drawScene(float x, float y, float w, float h, float dim){
+    if(sceneTexture == NULL) return;
+    ofSetColor(255.0 * dim, 255.0 * dim, 255.0 * dim);
+    sceneTexture->draw(x, y, w, h);
+    ofEnableBlendMode(OF_BLENDMODE_ADD);
+}
+
 //if we have to dim the image
 //projector is too bright close etc
 //-----------------------------------------------------				
@@ -61,6 +161,13 @@ void imageProjection::setProjectionColor(int r, int g, int b){
     blue 	= b;
 }
 
+//per projector color matching - see colorCorrection
+//-----------------------------------------------------
+void imageProjection::setColorCorrection(bool useLut, float gamma){
+    bUseLut = useLut;
+    LUT.setGamma(gamma);
+}
+
 ///////////////////////////////////////////////////////
 //
 //		UPDATE THE PROJECTED TEXTURE
@@ -238,6 +345,7 @@ void imageProjection::drawMiniProjectionTool(float x, float y, bool showOutline,
         ofEnableAlphaBlending();
         
         float dim = brightness *0.01;
+        drawScene(0, 0, width, height, 1.0);
         if(bGreyscaleTexture){
             ofSetColor((float)red, (float)green, (float)blue);
             greyscaleTexture.draw(0, 0, greyscaleTexture.getWidth(), greyscaleTexture.getHeight());
@@ -305,20 +413,23 @@ void imageProjection::drawProjectionMask(float x, float y, float w, float h){
 //-----------------------------------------------------
 void imageProjection::drawProjectionTex(float x, float y, float w, float h){
     
-    float sX = w/width;
-    float sY = h/height;
     ofPushStyle();
     {
         ofEnableAlphaBlending();
         {
-            ofPushMatrix();
+            beginProjection(x, y, w, h);
             {
-                ofTranslate(x,y,0);
-                ofScale(sX, sY, 1);
-                ofMultMatrix(matrix);
-                
                 float dim = brightness *0.01;
                 
+                //with a lut the dimming happens in the shader
+                //after the color has been corrected
+                bool bCorrect = bUseLut && LUT.isLoaded();
+                if(bCorrect){
+                    LUT.begin(dim);
+                    dim = 1.0;
+                }
+                
+                drawScene(0, 0, width, height, dim);
                 if(bGreyscaleTexture){
                     ofSetColor((float)red * dim, (float)green * dim, (float)blue * dim);
                     greyscaleTexture.draw(0, 0, greyscaleTexture.getWidth(), greyscaleTexture.getHeight());
@@ -327,21 +438,57 @@ void imageProjection::drawProjectionTex(float x, float y, float w, float h){
                     ofSetColor(255.0 * dim, 255.0 * dim, 255.0 * dim);
                     colorTexture.draw(0, 0, colorTexture.getWidth(), colorTexture.getHeight());
                 }
+                
+                if(bCorrect){
+                    LUT.end();
+                }
             }
             ofDisableAlphaBlending();
         }
-        ofPopMatrix();
+        endProjection();
     }
     ofPopStyle();
 }
 
+//-----------------------------------------------------
+void imageProjection::beginProjection(float x, float y, float w, float h){
+    ofPushMatrix();
+    ofTranslate(x, y, 0);
+    ofScale(w/width, h/height, 1);
+    ofMultMatrix(matrix);
+}
+
+void imageProjection::endProjection(){
+    ofPopMatrix();
+}
+
 
 //draws an uwarped texture of what is projected
 //-----------------------------------------------------
 void imageProjection::drawPreviewTex(float x, float y, float w, float h){
     ofEnableAlphaBlending();
+    drawScene(x, y, w, h, 1.0);
     if(bGreyscaleTexture)greyscaleTexture.draw(x,y,w,h);
     else colorTexture.draw(x,y,w,h);
     ofDisableAlphaBlending();
+}
+
+//the unwarped canvas with the brush color - what people see
+//on the wall without the projector brightness or color lut
+//-----------------------------------------------------
+void imageProjection::drawCanvas(float x, float y, float w, float h){
+    ofPushStyle();
+    ofEnableAlphaBlending();
+    drawScene(x, y, w, h, 1.0);
+    if(bGreyscaleTexture){
+        ofSetColor((float)red, (float)green, (float)blue);
+        greyscaleTexture.draw(x,y,w,h);
+    }
+    else{
+        ofSetColor(255, 255, 255);
+        colorTexture.draw(x,y,w,h);
+    }
+    ofDisableAlphaBlending();
+    ofPopStyle();
 }		
 
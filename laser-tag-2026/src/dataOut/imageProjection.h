@@ -3,6 +3,7 @@
 
 #include "ofMain.h"
 #include "guiQuad.h"
+#include "colorCorrection.h"
 
 //this class deals with the projection of lasertag
 //it manages textures for the different modes and the distortion
@@ -17,12 +18,17 @@ public:
     
     void setProjectionBrightness(float pBrightness);
     void setProjectionColor(int r, int g, int b);
+    void setColorCorrection(bool useLut, float gamma);
     
     void updateGreyscaleTexture(unsigned char * pixels);
     void updateColorTexture(unsigned char * pixels);
     
     void setColorTexture(ofTexture & tex);
     void setGrayTexture(ofTexture & tex);
+    void setRevealTextures(ofTexture & mask, ofTexture & picture);
+    
+    //a stored wall drawn under the brush - NULL for none
+    void setSceneTexture(ofTexture * tex);
     
     void loadSettings(string filePath);
     
@@ -42,7 +48,15 @@ public:
     void drawMiniProjectionTool(float x, float y, bool showOutline, bool showTexture);
     void drawProjectionToolHandles(float x, float y, float w, float h, bool showOutline, bool highlyVisible);
     void drawProjectionTex(float x, float y, float w, float h);
+    
+    //draw in canvas coords with the same warp as the projection
+    void beginProjection(float x, float y, float w, float h);
+    void endProjection();
+    
+    //leaves add blending on for the brush that goes on top
+    void drawScene(float x, float y, float w, float h, float dim);
     void drawPreviewTex(float x, float y, float w, float h);
+    void drawCanvas(float x, float y, float w, float h);
     void drawProjectionMask(float x, float y, float w, float h);
     
     
@@ -53,9 +67,18 @@ public:
 
     
     guiQuad		 QUAD;
+    colorCorrection LUT;
     ofPoint 	 warpSrc[4];
     
+    //mask x picture for revealBrush
+    ofFbo       revealFbo;
+    ofShader    revealShader;
+    bool        bRevealShaderSetup;
+    
+    ofTexture * sceneTexture;
+    
     bool bGreyscaleTexture;
+    bool bUseLut;
     
     int toolX, toolY, red, green, blue;
     int width, height, scaledWidth, scaledHeight, whichToolSelected;
@@ -0,0 +1,677 @@
+#include "pagedCanvas.h"
+#include "sceneSlots.h"
+#include "asyncLogger.h"
+#include <filesystem>
+
+//-----------------------------------------------------
+pagedCanvas::pagedCanvas(){
+    width        = 0;
+    height       = 0;
+    viewX        = 0;
+    viewY        = 0;
+    bPendingBake = false;
+    pendingX     = 0;
+    pendingY     = 0;
+    generation   = 0;
+    numMisses    = 0;
+}
+
+pagedCanvas::~pagedCanvas(){
+    close();
+}
+
+//-----------------------------------------------------
+void pagedCanvas::setup(int w, int h, string folder){
+    width  = w;
+    height = h;
+
+    viewPixels.allocate(width, height, OF_PIXELS_RGB);
+    viewFbo.allocate(width, height, GL_RGB);
+    bakeFbo.allocate(width, height, GL_RGB);
+
+    //a new projection size - the same mural seen through a
+    //bigger or smaller window
+    if(isThreadRunning()){
+        composeView();
+        prefetch();
+        evict();
+        return;
+    }
+
+    bPendingBake = false;
+    pendingX     = 0;
+    pendingY     = 0;
+    clearTiles();
+
+    ofDirectory::createDirectory(folder, true, true);
+    pagesPath = folder + "mural.pages";
+    indexPath = folder + "mural.index";
+    openPages();
+
+    startThread();
+    composeView();
+    prefetch();
+}
+
+//-----------------------------------------------------
+void pagedCanvas::close(){
+    if(isThreadRunning()){
+        toPage.close();
+        loaded.close();
+        waitForThread(false);
+        pageFile.close();
+        indexFile.close();
+    }
+}
+
+//-----------------------------------------------------
+void pagedCanvas::reset(){
+    if(!isThreadRunning() || width == 0 || height == 0) return;
+
+    bPendingBake = false;
+    pendingX     = 0;
+    pendingY     = 0;
+    clearTiles();
+
+    pageJob job;
+    job.type       = PAGE_RESET;
+    job.generation = generation;
+    job.key        = makeKey(viewX, viewY);
+    toPage.send(std::move(job));
+
+    LT_LOG_NOTICE("pagedCanvas") << "started a new mural";
+}
+
+//-----------------------------------------------------
+void pagedCanvas::clearTiles(){
+    //anything still on its way back is from the old mural
+    generation++;
+    resident.clear();
+    paged.clear();
+    loading.clear();
+    numMisses = 0;
+
+    viewX = 0;
+    viewY = 0;
+    viewPixels.set(0);
+    viewFbo.getTexture().loadData(viewPixels);
+}
+
+//the page file is never started over here - only reset() does that.
+//whatever the index points at is the mural from the last run
+//-----------------------------------------------------
+void pagedCanvas::openPages(){
+    index.clear();
+
+    int64_t pagesSize = 0;
+    std::ifstream pages(pagesPath.c_str(), std::ios::binary | std::ios::ate);
+    if(pages.is_open()) pagesSize = pages.tellg();
+    pages.close();
+
+    //a record past the end of the page file is from a write that
+    //didn't make it - a cut off record at the end is dropped too
+    bool bFound = false;
+    std::ifstream in(indexPath.c_str(), std::ios::binary);
+    uint32_t header[2] = {0, 0};
+    if(in.read((char *)header, sizeof(header)) && header[0] == MURAL_INDEX_MAGIC && header[1] == MURAL_INDEX_VERSION){
+        bFound = true;
+        pageRecord record;
+        while(in.read((char *)&record, sizeof(record))){
+            if(record.type == RECORD_VIEW){
+                viewX = keyX(record.key);
+                viewY = keyY(record.key);
+            }
+            else if(record.type == RECORD_TILE && record.offset + record.size <= (uint64_t)pagesSize){
+                pageEntry entry;
+                entry.offset = record.offset;
+                entry.size   = record.size;
+                index[record.key] = entry;
+            }
+        }
+    }
+    in.close();
+
+    uint64_t live = 0;
+    for(auto & it : index){
+        live += it.second.size;
+    }
+    if(bFound && pagesSize - (int64_t)live > (int64_t)MURAL_COMPACT_MB * 1024 * 1024){
+        compactPages(pagesSize);
+    }
+
+    //no index - whatever is in the page file can't be found again
+    std::ios::openmode mode = std::ios::in | std::ios::out | std::ios::binary;
+    if(!bFound || pagesSize == 0) mode |= std::ios::trunc;
+    pageFile.open(pagesPath.c_str(), mode);
+    if(!pageFile.is_open()){
+        LT_LOG_ERROR("pagedCanvas") << "couldn't open " << pagesPath << " - tiles off the wall will be lost";
+        index.clear();
+    }
+
+    writeIndex(makeKey(viewX, viewY));
+
+    for(auto & it : index){
+        paged.insert(it.first);
+    }
+    if(!index.empty()){
+        LT_LOG_NOTICE("pagedCanvas") << "found the mural from the last run - " << index.size() << " tiles, the view at " << viewX << ", " << viewY;
+    }
+}
+
+//every bake writes the tiles it changed again at the end of the page
+//file - the old copies are dropped here
+//-----------------------------------------------------
+void pagedCanvas::compactPages(int64_t pagesSize){
+    string tmpPath = pagesPath + ".tmp";
+    std::ifstream in(pagesPath.c_str(), std::ios::binary);
+    std::ofstream out(tmpPath.c_str(), std::ios::binary | std::ios::trunc);
+
+    map<tileKey, pageEntry> compacted;
+    vector<unsigned char> packed;
+    uint64_t offset = 0;
+    for(auto & it : index){
+        packed.resize(it.second.size);
+        in.seekg(it.second.offset);
+        if(!in.read((char *)packed.data(), packed.size())) break;
+        out.write((const char *)packed.data(), packed.size());
+
+        pageEntry & entry = compacted[it.first];
+        entry.offset = offset;
+        entry.size   = it.second.size;
+        offset += it.second.size;
+    }
+    bool bOk = in.good() && out.good();
+    in.close();
+    out.close();
+
+    std::error_code ec;
+    if(bOk) std::filesystem::rename(tmpPath, pagesPath, ec);
+    if(!bOk || ec){
+        std::filesystem::remove(tmpPath, ec);
+        LT_LOG_WARNING("pagedCanvas") << "couldn't compact " << pagesPath << " - it keeps growing";
+        return;
+    }
+
+    index.swap(compacted);
+    LT_LOG_NOTICE("pagedCanvas") << "compacted the mural page file from " << pagesSize / (1024 * 1024) << " to " << offset / (1024 * 1024) << " MB";
+}
+
+//the whole index in one go - the old one stays until the new one is
+//complete. after that records are only added to the end
+//-----------------------------------------------------
+void pagedCanvas::writeIndex(tileKey view){
+    indexFile.close();
+
+    string tmpPath = indexPath + ".tmp";
+    std::ofstream out(tmpPath.c_str(), std::ios::binary | std::ios::trunc);
+    uint32_t header[2] = {MURAL_INDEX_MAGIC, MURAL_INDEX_VERSION};
+    out.write((const char *)header, sizeof(header));
+
+    pageRecord record;
+    record.key    = view;
+    record.offset = 0;
+    record.size   = 0;
+    record.type   = RECORD_VIEW;
+    out.write((const char *)&record, sizeof(record));
+
+    for(auto & it : index){
+        record.key    = it.first;
+        record.offset = it.second.offset;
+        record.size   = it.second.size;
+        record.type   = RECORD_TILE;
+        out.write((const char *)&record, sizeof(record));
+    }
+    bool bOk = out.good();
+    out.close();
+
+    std::error_code ec;
+    if(bOk) std::filesystem::rename(tmpPath, indexPath, ec);
+    if(!bOk || ec){
+        LT_LOG_ERROR("pagedCanvas") << "couldn't write " << indexPath << " - the mural won't be there next run";
+        return;
+    }
+
+    indexFile.open(indexPath.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+}
+
+void pagedCanvas::addRecord(uint32_t type, tileKey key, const pageEntry & entry){
+    if(!indexFile.is_open()) return;
+
+    pageRecord record;
+    record.key    = key;
+    record.offset = entry.offset;
+    record.size   = entry.size;
+    record.type   = type;
+    indexFile.write((const char *)&record, sizeof(record));
+    indexFile.flush();
+}
+
+//-----------------------------------------------------
+void pagedCanvas::requestPan(int dx, int dy){
+    pendingX += dx;
+    pendingY += dy;
+    bPendingBake = true;
+}
+
+void pagedCanvas::requestBake(){
+    bPendingBake = true;
+}
+
+//-----------------------------------------------------
+bool pagedCanvas::update(imageProjection & projection){
+    pageResult result;
+    while(loaded.tryReceive(result)){
+        addLoaded(result);
+    }
+
+    if(!bPendingBake) return false;
+    bPendingBake = false;
+
+    bake(projection);
+    if(pendingX != 0 || pendingY != 0){
+        pan(pendingX, pendingY);
+        pendingX = 0;
+        pendingY = 0;
+    }
+    return true;
+}
+
+//-----------------------------------------------------
+void pagedCanvas::bake(imageProjection & projection){
+    if(width == 0 || height == 0) return;
+
+    bakeFbo.begin();
+    ofClear(0, 0, 0, 255);
+    projection.drawCanvas(0, 0, width, height);
+    bakeFbo.end();
+    bakeFbo.readToPixels(bakePixels);
+
+    storeView(bakePixels);
+}
+
+//-----------------------------------------------------
+void pagedCanvas::setView(const ofPixels & pix){
+    if(width == 0 || height == 0) return;
+    if((int)pix.getWidth() != width || (int)pix.getHeight() != height || pix.getNumChannels() < 3) return;
+
+    //the shared canvas is rgba - the tiles are rgb
+    size_t ch = pix.getNumChannels();
+    bakePixels.allocate(width, height, OF_PIXELS_RGB);
+    const unsigned char * src = pix.getData();
+    unsigned char * dst = bakePixels.getData();
+    for(size_t i = 0; i < (size_t)width * height; i++){
+        dst[i * 3    ] = src[i * ch    ];
+        dst[i * 3 + 1] = src[i * ch + 1];
+        dst[i * 3 + 2] = src[i * ch + 2];
+    }
+
+    storeView(bakePixels);
+}
+
+//the view's worth of pixels into the tiles under it
+//-----------------------------------------------------
+void pagedCanvas::storeView(const ofPixels & pix){
+    const unsigned char * src = pix.getData();
+    int tx0, ty0, tx1, ty1;
+    getTileRange(0, tx0, ty0, tx1, ty1);
+
+    for(int ty = ty0; ty <= ty1; ty++){
+        int y0 = MAX(viewY, ty * MURAL_TILE);
+        int y1 = MIN(viewY + height, (ty + 1) * MURAL_TILE);
+
+        for(int tx = tx0; tx <= tx1; tx++){
+            int x0 = MAX(viewX, tx * MURAL_TILE);
+            int x1 = MIN(viewX + width, (tx + 1) * MURAL_TILE);
+            int rowBytes = (x1 - x0) * 3;
+
+            //nothing painted here and no tile yet - keep it that way
+            tileKey key = makeKey(tx, ty);
+            if(resident.count(key) == 0 && paged.count(key) == 0){
+                bool bBlank = true;
+                for(int y = y0; y < y1 && bBlank; y++){
+                    const unsigned char * row = src + ((size_t)(y - viewY) * width + (x0 - viewX)) * 3;
+                    for(int i = 0; i < rowBytes; i++){
+                        if(row[i] != 0){
+                            bBlank = false;
+                            break;
+                        }
+                    }
+                }
+                if(bBlank) continue;
+            }
+
+            //only a tile that changed is written to the page file again
+            residentTile * tile = getTile(key, true);
+            unsigned char * dst = tile->pixels.getData();
+            for(int y = y0; y < y1; y++){
+                unsigned char * to = dst + ((size_t)(y - ty * MURAL_TILE) * MURAL_TILE + (x0 - tx * MURAL_TILE)) * 3;
+                const unsigned char * from = src + ((size_t)(y - viewY) * width + (x0 - viewX)) * 3;
+                if(memcmp(to, from, rowBytes) != 0){
+                    memcpy(to, from, rowBytes);
+                    tile->bDirty = true;
+                }
+            }
+        }
+    }
+    saveView();
+
+    //the view is what was just on the wall
+    viewFbo.getTexture().loadData(pix);
+}
+
+//the tiles in view that changed go to the page file now rather than
+//when they are evicted - so a crash or a relaunch finds them there
+//-----------------------------------------------------
+void pagedCanvas::saveView(){
+    int tx0, ty0, tx1, ty1;
+    getTileRange(0, tx0, ty0, tx1, ty1);
+
+    for(int ty = ty0; ty <= ty1; ty++){
+        for(int tx = tx0; tx <= tx1; tx++){
+            auto it = resident.find(makeKey(tx, ty));
+            if(it == resident.end() || !it->second.bDirty) continue;
+
+            pageJob job;
+            job.type       = PAGE_STORE;
+            job.generation = generation;
+            job.key        = it->first;
+            job.pixels     = it->second.pixels;
+            toPage.send(std::move(job));
+            paged.insert(it->first);
+            it->second.bDirty = false;
+        }
+    }
+}
+
+//-----------------------------------------------------
+void pagedCanvas::pan(int dx, int dy){
+    if(width == 0 || height == 0) return;
+
+    viewX += dx;
+    viewY += dy;
+
+    pageJob job;
+    job.type       = PAGE_VIEW;
+    job.generation = generation;
+    job.key        = makeKey(viewX, viewY);
+    toPage.send(std::move(job));
+
+    composeView();
+    prefetch();
+    evict();
+}
+
+//-----------------------------------------------------
+void pagedCanvas::clearView(){
+    if(width == 0 || height == 0) return;
+
+    int tx0, ty0, tx1, ty1;
+    getTileRange(0, tx0, ty0, tx1, ty1);
+
+    for(int ty = ty0; ty <= ty1; ty++){
+        int y0 = MAX(viewY, ty * MURAL_TILE);
+        int y1 = MIN(viewY + height, (ty + 1) * MURAL_TILE);
+
+        for(int tx = tx0; tx <= tx1; tx++){
+            residentTile * tile = getTile(makeKey(tx, ty), false);
+            if(tile == NULL) continue;
+
+            int x0 = MAX(viewX, tx * MURAL_TILE);
+            int x1 = MIN(viewX + width, (tx + 1) * MURAL_TILE);
+            unsigned char * dst = tile->pixels.getData();
+            for(int y = y0; y < y1; y++){
+                memset(dst + ((size_t)(y - ty * MURAL_TILE) * MURAL_TILE + (x0 - tx * MURAL_TILE)) * 3, 0, (x1 - x0) * 3);
+            }
+            tile->bDirty = true;
+        }
+    }
+    saveView();
+
+    viewPixels.set(0);
+    viewFbo.getTexture().loadData(viewPixels);
+}
+
+//-----------------------------------------------------
+ofTexture & pagedCanvas::getViewTexture(){
+    return viewFbo.getTexture();
+}
+
+int pagedCanvas::getViewX(){
+    return viewX;
+}
+
+int pagedCanvas::getViewY(){
+    return viewY;
+}
+
+int pagedCanvas::getNumResident(){
+    return resident.size();
+}
+
+int pagedCanvas::getNumPaged(){
+    return paged.size();
+}
+
+int pagedCanvas::getNumMisses(){
+    return numMisses;
+}
+
+//-----------------------------------------------------
+pagedCanvas::tileKey pagedCanvas::makeKey(int tx, int ty){
+    return ((uint64_t)(uint32_t)tx << 32) | (uint32_t)ty;
+}
+
+int pagedCanvas::keyX(tileKey key){
+    return (int32_t)(key >> 32);
+}
+
+int pagedCanvas::keyY(tileKey key){
+    return (int32_t)(key & 0xFFFFFFFF);
+}
+
+//the view can go left of or above 0, 0
+int pagedCanvas::floorDiv(int a, int b){
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+void pagedCanvas::getTileRange(int margin, int & tx0, int & ty0, int & tx1, int & ty1){
+    tx0 = floorDiv(viewX, MURAL_TILE) - margin;
+    ty0 = floorDiv(viewY, MURAL_TILE) - margin;
+    tx1 = floorDiv(viewX + width - 1, MURAL_TILE) + margin;
+    ty1 = floorDiv(viewY + height - 1, MURAL_TILE) + margin;
+}
+
+//-----------------------------------------------------
+pagedCanvas::residentTile * pagedCanvas::getTile(tileKey key, bool bCreate){
+    auto it = resident.find(key);
+    if(it != resident.end()) return &it->second;
+
+    if(paged.count(key)){
+        waitForTile(key);
+        it = resident.find(key);
+        if(it != resident.end()) return &it->second;
+    }
+
+    if(!bCreate) return NULL;
+
+    residentTile & tile = resident[key];
+    tile.pixels.allocate(MURAL_TILE, MURAL_TILE, OF_PIXELS_RGB);
+    tile.pixels.set(0);
+    tile.bDirty = true;
+    return &tile;
+}
+
+//the prefetch didn't get it in time - we have to wait for the disk
+//-----------------------------------------------------
+void pagedCanvas::waitForTile(tileKey key){
+    numMisses++;
+
+    if(loading.count(key) == 0){
+        pageJob job;
+        job.type       = PAGE_LOAD;
+        job.generation = generation;
+        job.key        = key;
+        toPage.send(std::move(job));
+        loading.insert(key);
+    }
+
+    pageResult result;
+    while(loading.count(key) && loaded.receive(result)){
+        addLoaded(result);
+    }
+}
+
+void pagedCanvas::addLoaded(pageResult & result){
+    if(result.generation != generation) return;
+
+    loading.erase(result.key);
+    if(result.bOk){
+        residentTile & tile = resident[result.key];
+        tile.pixels = std::move(result.pixels);
+        tile.bDirty = false;
+    }else{
+        paged.erase(result.key);
+    }
+}
+
+//-----------------------------------------------------
+void pagedCanvas::composeView(){
+    viewPixels.set(0);
+    unsigned char * dst = viewPixels.getData();
+
+    int tx0, ty0, tx1, ty1;
+    getTileRange(0, tx0, ty0, tx1, ty1);
+
+    for(int ty = ty0; ty <= ty1; ty++){
+        int y0 = MAX(viewY, ty * MURAL_TILE);
+        int y1 = MIN(viewY + height, (ty + 1) * MURAL_TILE);
+
+        for(int tx = tx0; tx <= tx1; tx++){
+            residentTile * tile = getTile(makeKey(tx, ty), false);
+            if(tile == NULL) continue;
+
+            int x0 = MAX(viewX, tx * MURAL_TILE);
+            int x1 = MIN(viewX + width, (tx + 1) * MURAL_TILE);
+            const unsigned char * src = tile->pixels.getData();
+            for(int y = y0; y < y1; y++){
+                memcpy(dst + ((size_t)(y - viewY) * width + (x0 - viewX)) * 3,
+                       src + ((size_t)(y - ty * MURAL_TILE) * MURAL_TILE + (x0 - tx * MURAL_TILE)) * 3, (x1 - x0) * 3);
+            }
+        }
+    }
+
+    viewFbo.getTexture().loadData(viewPixels);
+}
+
+//-----------------------------------------------------
+void pagedCanvas::prefetch(){
+    int tx0, ty0, tx1, ty1;
+    getTileRange(MURAL_PREFETCH_TILES, tx0, ty0, tx1, ty1);
+
+    for(int ty = ty0; ty <= ty1; ty++){
+        for(int tx = tx0; tx <= tx1; tx++){
+            tileKey key = makeKey(tx, ty);
+            if(paged.count(key) == 0 || resident.count(key) || loading.count(key)) continue;
+
+            pageJob job;
+            job.type       = PAGE_LOAD;
+            job.generation = generation;
+            job.key        = key;
+            toPage.send(std::move(job));
+            loading.insert(key);
+        }
+    }
+}
+
+//tiles out past the prefetch ring go to the page file - the ones
+//that haven't changed since they came from there are just dropped
+//-----------------------------------------------------
+void pagedCanvas::evict(){
+    int tx0, ty0, tx1, ty1;
+    getTileRange(MURAL_PREFETCH_TILES, tx0, ty0, tx1, ty1);
+
+    for(auto it = resident.begin(); it != resident.end();){
+        int tx = keyX(it->first);
+        int ty = keyY(it->first);
+        if(tx >= tx0 && tx <= tx1 && ty >= ty0 && ty <= ty1){
+            ++it;
+            continue;
+        }
+
+        if(it->second.bDirty || paged.count(it->first) == 0){
+            pageJob job;
+            job.type       = PAGE_STORE;
+            job.generation = generation;
+            job.key        = it->first;
+            job.pixels     = std::move(it->second.pixels);
+            toPage.send(std::move(job));
+            paged.insert(it->first);
+        }
+        it = resident.erase(it);
+    }
+}
+
+//-----------------------------------------------------
+void pagedCanvas::threadedFunction(){
+
+    //a tile that is paged out again is written again at the end -
+    //the file only grows until the next start compacts it. the page
+    //file is flushed before the index points into it
+    vector<unsigned char> packed;
+    pageJob job;
+
+    while(toPage.receive(job)){
+
+        if(job.type == PAGE_RESET){
+            pageFile.close();
+            index.clear();
+            pageFile.open(pagesPath.c_str(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+            if(!pageFile.is_open()){
+                LT_LOG_ERROR("pagedCanvas") << "couldn't open " << pagesPath << " - tiles off the wall will be lost";
+            }
+            writeIndex(job.key);
+        }
+        else if(job.type == PAGE_VIEW){
+            addRecord(RECORD_VIEW, job.key, pageEntry());
+        }
+        else if(job.type == PAGE_STORE){
+            sceneSlots::pack(job.pixels, packed);
+
+            pageFile.clear();
+            pageFile.seekp(0, std::ios::end);
+            pageEntry entry;
+            entry.offset = pageFile.tellp();
+            entry.size   = packed.size();
+            pageFile.write((const char *)packed.data(), packed.size());
+            pageFile.flush();
+
+            if(pageFile.good()){
+                index[job.key] = entry;
+                addRecord(RECORD_TILE, job.key, entry);
+            }else{
+                index.erase(job.key);
+                LT_LOG_ERROR("pagedCanvas") << "couldn't write a tile to the page file";
+            }
+        }
+        else{
+            pageResult result;
+            result.generation = job.generation;
+            result.key        = job.key;
+            result.bOk        = false;
+
+            auto it = index.find(job.key);
+            if(it != index.end()){
+                packed.resize(it->second.size);
+                pageFile.clear();
+                pageFile.seekg(it->second.offset);
+                pageFile.read((char *)packed.data(), packed.size());
+                result.bOk = pageFile.good() && sceneSlots::unpack(packed, result.pixels, MURAL_TILE, MURAL_TILE);
+            }
+            if(!result.bOk){
+                LT_LOG_ERROR("pagedCanvas") << "lost a tile from the page file - it comes back blank";
+            }
+
+            loaded.send(std::move(result));
+        }
+    }
+}
@@ -0,0 +1,192 @@
+#ifndef _PAGED_CANVAS_H
+#define _PAGED_CANVAS_H
+
+#include "ofMain.h"
+#include "imageProjection.h"
+#include <set>
+
+//a mural much bigger than the projector - the wall is a window onto
+//it that can be moved around over the night.
+//
+//the mural is kept in MURAL_TILE square tiles and only tiles that
+//have been painted exist. the ones in and around the view are in
+//memory, the rest are run length packed and written to a page file
+//by our thread - so memory only depends on the size of the view.
+//
+//the brushes still paint the view as usual. before the view moves
+//what is on the wall is baked into the tiles, the brushes are
+//cleared and the view is put together again from the tiles at the
+//new spot and drawn under the brushes like a scene.
+//
+//after a move the tiles MURAL_PREFETCH_TILES around the view are
+//loaded on our thread, so the next move rarely has to wait on the
+//disk. a tile that isn't in yet is waited for and counted as a miss.
+//
+//the mural outlives the app. tiles in view go to the page file as
+//soon as a bake changes them, and every tile written and every move
+//of the view is added to mural.index next to it. the next run - or
+//the supervisor's restart after a crash - reads the index back and
+//carries on where the view was. only reset() starts a new mural.
+//at startup a page file that is mostly old copies of tiles is
+//written again without them.
+
+#define MURAL_TILE              256
+#define MURAL_PREFETCH_TILES    2       //ring around the view kept in memory
+#define MURAL_COMPACT_MB        64      //dead bytes in the page file before it is rewritten
+#define MURAL_INDEX_MAGIC       0x494D544C  //"LTMI"
+#define MURAL_INDEX_VERSION     1
+
+class pagedCanvas : public ofThread{
+
+public:
+
+    pagedCanvas();
+    ~pagedCanvas();
+
+    //the first time opens the mural in folder as the last run left
+    //it - or a new empty one with the view at 0, 0. after that only
+    //the view changes size - the tiles are kept and the view is put
+    //together again from them
+    void setup(int w, int h, string folder);
+    void close();
+
+    //throws the whole mural away - a new empty one at 0, 0
+    void reset();
+
+    //both are done at the next update(). moving bakes first.
+    //baking puts what is on the wall into the mural - the view
+    //shows it from then on so the brushes can start again
+    void requestPan(int dx, int dy);
+    void requestBake();
+
+    //call once per frame from the gl thread before painting - picks
+    //up prefetched tiles. returns true if the wall was baked this
+    //frame and the brushes should be cleared
+    bool update(imageProjection & projection);
+
+    //blanks the part of the mural that is in view
+    void clearView();
+
+    //a wall from somewhere else - the one a crashed run left - goes
+    //into the mural where the view is. rgb or rgba at the view size
+    void setView(const ofPixels & pix);
+
+    ofTexture & getViewTexture();
+    int getViewX();
+    int getViewY();
+
+    //for the status line
+    int getNumResident();
+    int getNumPaged();
+    int getNumMisses();
+
+protected:
+
+    typedef uint64_t tileKey;
+
+    enum pageJobType{
+        PAGE_RESET,
+        PAGE_STORE,
+        PAGE_LOAD,
+        PAGE_VIEW           //the view moved - key is its origin
+    };
+
+    struct pageJob{
+        pageJobType type;
+        int generation;
+        tileKey key;
+        ofPixels pixels;
+    };
+
+    struct pageResult{
+        int generation;
+        tileKey key;
+        ofPixels pixels;
+        bool bOk;
+    };
+
+    struct residentTile{
+        ofPixels pixels;
+        bool bDirty;        //changed since it was last paged out
+    };
+
+    struct pageEntry{
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    //mural.index is a header then these one after another -
+    //a later record for the same tile wins
+    enum{
+        RECORD_TILE,
+        RECORD_VIEW
+    };
+
+    struct pageRecord{
+        uint64_t key;
+        uint64_t offset;
+        uint32_t size;
+        uint32_t type;
+    };
+
+    static tileKey makeKey(int tx, int ty);
+    static int keyX(tileKey key);
+    static int keyY(tileKey key);
+    static int floorDiv(int a, int b);
+
+    //the tiles the view covers - grown by a ring of margin tiles
+    void getTileRange(int margin, int & tx0, int & ty0, int & tx1, int & ty1);
+
+    //NULL if the tile was never painted
+    residentTile * getTile(tileKey key, bool bCreate);
+    void waitForTile(tileKey key);
+    void addLoaded(pageResult & result);
+
+    void clearTiles();
+
+    //reads the index back - before our thread starts
+    void openPages();
+    void compactPages(int64_t pagesSize);
+
+    void bake(imageProjection & projection);
+    void storeView(const ofPixels & pix);
+    void saveView();
+    void pan(int dx, int dy);
+    void composeView();
+    void prefetch();
+    void evict();
+
+    void threadedFunction();
+
+    int width, height;
+    int viewX, viewY;
+
+    bool bPendingBake;
+    int pendingX, pendingY;
+
+    ofFbo viewFbo;
+    ofFbo bakeFbo;
+    ofPixels viewPixels;
+    ofPixels bakePixels;
+
+    //only touched on the gl thread
+    int generation;          //results from before a setup are dropped
+    map<tileKey, residentTile> resident;
+    set<tileKey> paged;      //sent to the page file
+    set<tileKey> loading;    //asked our thread for
+    int numMisses;
+
+    ofThreadChannel<pageJob>    toPage;
+    ofThreadChannel<pageResult> loaded;
+
+    //only touched by our thread once it is running
+    string pagesPath, indexPath;
+    std::fstream pageFile;
+    std::fstream indexFile;
+    map<tileKey, pageEntry> index;
+
+    void writeIndex(tileKey view);
+    void addRecord(uint32_t type, tileKey key, const pageEntry & entry);
+};
+
+#endif
@@ -0,0 +1,295 @@
+#include "sceneSlots.h"
+#include "asyncLogger.h"
+
+//-----------------------------------------------------
+sceneSlots::sceneSlots(){
+    width         = 0;
+    height        = 0;
+    maxResident   = 1;
+    active        = -1;
+    pendingRecall = -1;
+    pendingStore  = -1;
+    useCounter    = 0;
+    restored      = NULL;
+
+    for(int i = 0; i < SCENE_NUM_SLOTS; i++){
+        slots[i].bUsed    = false;
+        slots[i].fbo      = NULL;
+        slots[i].lastUsed = 0;
+    }
+}
+
+//-----------------------------------------------------
+sceneSlots::~sceneSlots(){
+    for(int i = 0; i < SCENE_NUM_SLOTS; i++){
+        delete slots[i].fbo;
+    }
+    delete restored;
+}
+
+//stored walls don't survive a change of canvas size
+//-----------------------------------------------------
+void sceneSlots::setup(int w, int h){
+    if(w != width || h != height){
+        for(int i = 0; i < SCENE_NUM_SLOTS; i++){
+            delete slots[i].fbo;
+            slots[i].fbo   = NULL;
+            slots[i].bUsed = false;
+            slots[i].packed.clear();
+        }
+        active        = -1;
+        pendingRecall = -1;
+        pendingStore  = -1;
+        delete restored;
+        restored = NULL;
+    }
+
+    width  = w;
+    height = h;
+    setGpuBudget(SCENE_GPU_BUDGET_MB);
+}
+
+//-----------------------------------------------------
+void sceneSlots::setGpuBudget(int megabytes){
+    int bytesPerSlot = MAX(1, width * height * 3);
+    maxResident = MAX(1, (int)(((int64_t)megabytes * 1024 * 1024) / bytesPerSlot));
+    enforceBudget();
+}
+
+//-----------------------------------------------------
+void sceneSlots::store(int which, const sceneBrushState & state){
+    if(which < 0 || which >= SCENE_NUM_SLOTS) return;
+    pendingStore = which;
+    pendingState = state;
+}
+
+void sceneSlots::recall(int which){
+    if(which < 0 || which >= SCENE_NUM_SLOTS) return;
+    pendingRecall = which;
+}
+
+void sceneSlots::clearActive(){
+    active        = -1;
+    pendingRecall = -1;
+    delete restored;
+    restored = NULL;
+}
+
+//-----------------------------------------------------
+void sceneSlots::restore(const ofPixels & pix){
+    if((int)pix.getWidth() != width || (int)pix.getHeight() != height) return;
+
+    if(restored == NULL) restored = new ofFbo();
+    restored->allocate(width, height, GL_RGB);
+    restored->getTexture().loadData(pix);
+    active = -1;
+}
+
+//-----------------------------------------------------
+int sceneSlots::getActive(){
+    return active;
+}
+
+bool sceneSlots::isUsed(int which){
+    if(which < 0 || which >= SCENE_NUM_SLOTS) return false;
+    return slots[which].bUsed;
+}
+
+sceneBrushState sceneSlots::getState(int which){
+    return slots[(int)ofClamp(which, 0, SCENE_NUM_SLOTS - 1)].state;
+}
+
+int sceneSlots::getNumResident(){
+    int num = 0;
+    for(int i = 0; i < SCENE_NUM_SLOTS; i++){
+        if(slots[i].fbo != NULL) num++;
+    }
+    return num;
+}
+
+int sceneSlots::getCompressedBytes(){
+    int bytes = 0;
+    for(int i = 0; i < SCENE_NUM_SLOTS; i++){
+        bytes += slots[i].packed.size();
+    }
+    return bytes;
+}
+
+//-----------------------------------------------------
+bool sceneSlots::update(imageProjection & projection){
+    if(width == 0 || height == 0) return false;
+
+    if(pendingStore >= 0){
+        capture(pendingStore, projection);
+        slots[pendingStore].state = pendingState;
+        slots[pendingStore].bUsed = true;
+        pendingStore = -1;
+    }
+
+    bool bSwitched = false;
+    if(pendingRecall >= 0){
+        int which = pendingRecall;
+        pendingRecall = -1;
+
+        if(slots[which].bUsed && makeResident(which)){
+            active = which;
+            delete restored;
+            restored = NULL;
+            slots[which].lastUsed = ++useCounter;
+            enforceBudget();
+            bSwitched = true;
+        }
+    }
+
+    if(active >= 0){
+        projection.setSceneTexture(&slots[active].fbo->getTexture());
+    }else{
+        projection.setSceneTexture(restored != NULL ? &restored->getTexture() : NULL);
+    }
+    return bSwitched;
+}
+
+//draws into a new fbo - the slot might be the scene that is
+//being drawn. the readback stalls but only when storing
+//-----------------------------------------------------
+void sceneSlots::capture(int which, imageProjection & projection){
+    ofFbo * fbo = new ofFbo();
+    fbo->allocate(width, height, GL_RGB);
+
+    fbo->begin();
+    ofClear(0, 0, 0, 255);
+    projection.drawCanvas(0, 0, width, height);
+    fbo->end();
+
+    ofPixels pix;
+    fbo->readToPixels(pix);
+    pack(pix, slots[which].packed);
+
+    delete slots[which].fbo;
+    slots[which].fbo      = fbo;
+    slots[which].lastUsed = ++useCounter;
+
+    enforceBudget();
+
+    LT_LOG_NOTICE("sceneSlots") << "stored scene " << which + 1 << " - " << slots[which].packed.size() / 1024 << " kb compressed";
+}
+
+//-----------------------------------------------------
+bool sceneSlots::makeResident(int which){
+    slot & s = slots[which];
+    if(s.fbo != NULL) return true;
+
+    ofPixels pix;
+    if(!unpack(s.packed, pix, width, height)){
+        LT_LOG_ERROR("sceneSlots") << "scene " << which + 1 << " is damaged - dropping it";
+        s.bUsed = false;
+        s.packed.clear();
+        return false;
+    }
+
+    s.fbo = new ofFbo();
+    s.fbo->allocate(width, height, GL_RGB);
+    s.fbo->getTexture().loadData(pix);
+    return true;
+}
+
+//the active scene always stays on the gpu
+//-----------------------------------------------------
+void sceneSlots::enforceBudget(){
+    while(getNumResident() > maxResident){
+        int oldest = -1;
+        for(int i = 0; i < SCENE_NUM_SLOTS; i++){
+            if(i == active || slots[i].fbo == NULL) continue;
+            if(oldest < 0 || slots[i].lastUsed < slots[oldest].lastUsed) oldest = i;
+        }
+        if(oldest < 0) break;
+
+        delete slots[oldest].fbo;
+        slots[oldest].fbo = NULL;
+    }
+}
+
+//packbits on whole pixels. a control byte of 0 - 127 is followed
+//by that many + 1 pixels as they are, 128 - 255 by one pixel that
+//repeats (control - 126) times. the header is w, h and channels
+//-----------------------------------------------------
+void sceneSlots::pack(const ofPixels & pix, vector<unsigned char> & out){
+    int w  = pix.getWidth();
+    int h  = pix.getHeight();
+    int ch = pix.getNumChannels();
+    int n  = w * h;
+    const unsigned char * p = pix.getData();
+
+    out.clear();
+    out.reserve(n / 8);
+
+    for(int b = 0; b < 4; b++) out.push_back((w >> (b * 8)) & 0xFF);
+    for(int b = 0; b < 4; b++) out.push_back((h >> (b * 8)) & 0xFF);
+    out.push_back(ch);
+
+    auto same = [&](int a, int b){
+        return memcmp(p + a * ch, p + b * ch, ch) == 0;
+    };
+
+    int i = 0;
+    while(i < n){
+        int run = 1;
+        while(i + run < n && run < 129 && same(i, i + run)) run++;
+
+        if(run >= 2){
+            out.push_back(run + 126);
+            out.insert(out.end(), p + i * ch, p + (i + 1) * ch);
+            i += run;
+        }else{
+            int start = i;
+            int count = 0;
+            while(i < n && count < 128){
+                if(i + 1 < n && same(i, i + 1)) break;
+                i++;
+                count++;
+            }
+            out.push_back(count - 1);
+            out.insert(out.end(), p + start * ch, p + (start + count) * ch);
+        }
+    }
+}
+
+//-----------------------------------------------------
+bool sceneSlots::unpack(const vector<unsigned char> & in, ofPixels & pix, int width, int height){
+    if(in.size() < 9) return false;
+
+    int w = 0, h = 0;
+    for(int b = 0; b < 4; b++) w |= in[b] << (b * 8);
+    for(int b = 0; b < 4; b++) h |= in[4 + b] << (b * 8);
+    int ch = in[8];
+
+    if(w != width || h != height || ch < 1 || ch > 4) return false;
+
+    pix.allocate(w, h, ch);
+    unsigned char * p = pix.getData();
+    size_t total = (size_t)w * h * ch;
+    size_t outPos = 0;
+    size_t pos = 9;
+
+    while(pos < in.size() && outPos < total){
+        int control = in[pos++];
+
+        if(control < 128){
+            size_t bytes = (size_t)(control + 1) * ch;
+            if(pos + bytes > in.size() || outPos + bytes > total) return false;
+            memcpy(p + outPos, &in[pos], bytes);
+            pos    += bytes;
+            outPos += bytes;
+        }else{
+            int count = control - 126;
+            if(pos + ch > in.size() || outPos + (size_t)count * ch > total) return false;
+            for(int i = 0; i < count; i++){
+                memcpy(p + outPos, &in[pos], ch);
+                outPos += ch;
+            }
+            pos += ch;
+        }
+    }
+
+    return outPos == total;
+}
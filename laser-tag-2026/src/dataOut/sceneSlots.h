@@ -0,0 +1,96 @@
+#ifndef _SCENE_SLOTS_H
+#define _SCENE_SLOTS_H
+
+#include "ofMain.h"
+#include "imageProjection.h"
+
+//prepared walls we can jump between - a sponsor canvas, the last
+//artist's piece, a blank wall.
+//
+//storing a slot draws the whole canvas (scene + brush) into its own
+//fbo and keeps a run length compressed copy in memory - walls are
+//mostly black so that is tiny. the fbo stays on the gpu while we are
+//under the budget, past that the least recently used inactive ones
+//are freed and only the compressed copy is kept.
+//
+//recalling a slot is queued and happens in update() at the start of
+//the next frame. if it is on the gpu it is just a pointer swap - if
+//not it is decompressed and uploaded first. the scene is drawn under
+//the brush by imageProjection so the brushes start from clean.
+
+#define SCENE_NUM_SLOTS       8
+#define SCENE_GPU_BUDGET_MB   64
+
+//what the brush panel was set to when the slot was stored
+struct sceneBrushState{
+    int mode;
+    int number;
+    int color;
+    int width;
+};
+
+class sceneSlots{
+
+public:
+
+    sceneSlots();
+    ~sceneSlots();
+
+    void setup(int w, int h);
+    void setGpuBudget(int megabytes);
+
+    //both are done at the next update()
+    void store(int slot, const sceneBrushState & state);
+    void recall(int slot);
+
+    //no scene - just the brushes
+    void clearActive();
+
+    //puts back the wall a crashed run left in shared memory - it is
+    //under the brushes like a scene until one is recalled or we clear
+    void restore(const ofPixels & pix);
+
+    //call once per frame from the gl thread before painting.
+    //returns true if we switched to a stored scene this frame
+    bool update(imageProjection & projection);
+
+    int getActive();
+    bool isUsed(int slot);
+    sceneBrushState getState(int slot);
+
+    //for the status line
+    int getNumResident();
+    int getCompressedBytes();
+
+    //run length packing - walls are mostly black. unpack fails if
+    //the data is damaged or isn't w x h
+    static void pack(const ofPixels & pix, vector<unsigned char> & out);
+    static bool unpack(const vector<unsigned char> & in, ofPixels & pix, int w, int h);
+
+protected:
+
+    struct slot{
+        bool bUsed;
+        sceneBrushState state;
+        ofFbo * fbo;                     //NULL when not on the gpu
+        vector<unsigned char> packed;    //always there once stored
+        uint64_t lastUsed;
+    };
+
+    void capture(int which, imageProjection & projection);
+    bool makeResident(int which);
+    void enforceBudget();
+
+    slot slots[SCENE_NUM_SLOTS];
+    ofFbo * restored;                    //NULL unless we came back from a crash
+
+    int width, height;
+    int maxResident;
+    int active;
+    int pendingRecall;
+    int pendingStore;
+    sceneBrushState pendingState;
+    uint64_t useCounter;
+};
+
+#endif
@@ -0,0 +1,297 @@
+#include "sharedCanvas.h"
+#include "canvasSnapshot.h"
+#include "asyncLogger.h"
+
+#ifndef TARGET_WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+//-----------------------------------------------------
+sharedCanvas::sharedCanvas(){
+    numBytes = 0;
+    header   = NULL;
+    pixels   = NULL;
+
+#ifdef TARGET_WIN32
+    file    = INVALID_HANDLE_VALUE;
+    mapping = NULL;
+#else
+    fd = -1;
+#endif
+
+    width  = 0;
+    height = 0;
+
+    bReadbackPending = false;
+    readbackFrame    = 0;
+    lastCopyFrame    = 0;
+    tilesCopied      = 0;
+}
+
+sharedCanvas::~sharedCanvas(){
+    close();
+}
+
+//-----------------------------------------------------
+bool sharedCanvas::setup(int w, int h){
+
+    //a new size is a new wall - the old one can go
+    if(header != NULL && (w != width || h != height)){
+        remove();
+    }
+
+    width  = w;
+    height = h;
+
+    //the size is in the name so a run at another size never
+    //picks up a wall it can't use
+#ifdef TARGET_WIN32
+    name = ofToDataPath("canvas-" + ofToString(w) + "x" + ofToString(h) + ".shm", true);
+#else
+    name = "/lasertag-canvas-" + ofToString(w) + "x" + ofToString(h);
+#endif
+
+    if(header == NULL && !map(SHARED_CANVAS_HEADER + (size_t)w * h * 4)){
+        return false;
+    }
+
+    //zeroed if we just made it - or from an older build
+    if(header->magic != SHARED_CANVAS_MAGIC || header->version != SHARED_CANVAS_VERSION
+        || header->width != (uint32_t)w || header->height != (uint32_t)h){
+        memset(header, 0, sizeof(sharedCanvasHeader));
+        header->magic   = SHARED_CANVAS_MAGIC;
+        header->version = SHARED_CANVAS_VERSION;
+        header->width   = w;
+        header->height  = h;
+    }
+
+    //rgba so rows are always 4 byte aligned for the readback
+    fbo.allocate(width, height, GL_RGBA);
+    pbo.allocate(width * height * 4, GL_STREAM_READ);
+    bReadbackPending = false;
+    lastCopyFrame    = ofGetFrameNum();
+
+    if(header->bHasWall){
+        LT_LOG_NOTICE("sharedCanvas") << "found the wall from the last run - " << header->numCopies << " copies in " << name;
+    }
+    return header->bHasWall != 0;
+}
+
+//-----------------------------------------------------
+bool sharedCanvas::map(size_t bytes){
+    numBytes = bytes;
+
+#ifdef TARGET_WIN32
+    file = CreateFileA(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE){
+        LT_LOG_ERROR("sharedCanvas") << "couldn't open " << name;
+        return false;
+    }
+
+    //the wrong size is from something else - start it again
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || (uint64_t)size.QuadPart != bytes){
+        LARGE_INTEGER zero;
+        zero.QuadPart = 0;
+        SetFilePointerEx(file, zero, NULL, FILE_BEGIN);
+        SetEndOfFile(file);
+    }
+
+    //grows the file with zeros to the size we ask for
+    mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD)((uint64_t)bytes >> 32), (DWORD)(bytes & 0xFFFFFFFF), NULL);
+    void * data = mapping != NULL ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes) : NULL;
+    if(data == NULL){
+        LT_LOG_ERROR("sharedCanvas") << "couldn't map " << name;
+        unmap();
+        return false;
+    }
+#else
+    fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+    if(fd < 0){
+        LT_LOG_ERROR("sharedCanvas") << "couldn't open " << name << " - " << strerror(errno);
+        return false;
+    }
+
+    //mac only lets us size a segment once - so if it is the
+    //wrong size we unlink it and make a fresh one
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size != 0 && (size_t)st.st_size != bytes){
+        ::close(fd);
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+        st.st_size = 0;
+    }
+    if(fd >= 0 && st.st_size == 0 && ftruncate(fd, bytes) != 0){
+        ::close(fd);
+        fd = -1;
+    }
+
+    void * data = fd >= 0 ? mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if(data == MAP_FAILED){
+        LT_LOG_ERROR("sharedCanvas") << "couldn't map " << name << " - " << strerror(errno);
+        unmap();
+        return false;
+    }
+#endif
+
+    header = (sharedCanvasHeader *)data;
+    pixels = (unsigned char *)data + SHARED_CANVAS_HEADER;
+    return true;
+}
+
+//-----------------------------------------------------
+void sharedCanvas::unmap(){
+#ifdef TARGET_WIN32
+    if(header != NULL) UnmapViewOfFile(header);
+    if(mapping != NULL) CloseHandle(mapping);
+    if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    mapping = NULL;
+    file    = INVALID_HANDLE_VALUE;
+#else
+    if(header != NULL) munmap(header, numBytes);
+    if(fd >= 0) ::close(fd);
+    fd = -1;
+#endif
+
+    header = NULL;
+    pixels = NULL;
+    bReadbackPending = false;
+}
+
+//-----------------------------------------------------
+void sharedCanvas::close(){
+    unmap();
+}
+
+void sharedCanvas::remove(){
+    if(name.empty()) return;
+    unmap();
+#ifdef TARGET_WIN32
+    DeleteFileA(name.c_str());
+#else
+    shm_unlink(name.c_str());
+#endif
+}
+
+bool sharedCanvas::isSetup(){
+    return header != NULL;
+}
+
+//-----------------------------------------------------
+bool sharedCanvas::getWall(ofPixels & pix, sceneBrushState & state){
+    if(header == NULL || !header->bHasWall) return false;
+
+    if(header->sequence & 1){
+        LT_LOG_WARNING("sharedCanvas") << "the last run died mid copy - some tiles are a few frames older";
+    }
+
+    pix.allocate(width, height, OF_PIXELS_RGBA);
+    memcpy(pix.getData(), pixels, (size_t)width * height * 4);
+    state = header->brush;
+    return true;
+}
+
+void sharedCanvas::setBrushState(const sceneBrushState & state){
+    if(header == NULL) return;
+    header->brush = state;
+}
+
+//-----------------------------------------------------
+void sharedCanvas::clear(){
+    if(header == NULL) return;
+    header->bHasWall = 0;
+
+    //that readback is of the wall we just got rid of
+    bReadbackPending = false;
+    lastCopyFrame    = ofGetFrameNum();
+}
+
+int sharedCanvas::getTilesCopied(){
+    return tilesCopied;
+}
+
+//-----------------------------------------------------
+void sharedCanvas::update(imageProjection & projection){
+    if(header == NULL) return;
+
+    if(bReadbackPending && ofGetFrameNum() - readbackFrame >= SNAPSHOT_READBACK_FRAMES){
+        finishReadback();
+    }
+
+    if(!bReadbackPending && ofGetFrameNum() - lastCopyFrame >= SHARED_CANVAS_FRAMES){
+        startReadback(projection);
+    }
+}
+
+//-----------------------------------------------------
+void sharedCanvas::prewarm(imageProjection & projection){
+    if(header == NULL) return;
+    startReadback(projection);
+    finishReadback();
+}
+
+//-----------------------------------------------------
+void sharedCanvas::startReadback(imageProjection & projection){
+
+    fbo.begin();
+    ofClear(0, 0, 0, 255);
+    projection.drawCanvas(0, 0, width, height);
+    fbo.end();
+
+    //copies into the buffer on the gpu - returns straight away
+    fbo.getTexture().copyTo(pbo);
+
+    readbackFrame    = ofGetFrameNum();
+    lastCopyFrame    = readbackFrame;
+    bReadbackPending = true;
+}
+
+//-----------------------------------------------------
+void sharedCanvas::finishReadback(){
+
+    bReadbackPending = false;
+
+    unsigned char * data = pbo.map<unsigned char>(GL_READ_ONLY);
+    if(data == NULL){
+        pbo.unmap();
+        LT_LOG_ERROR("sharedCanvas") << "couldn't map the readback buffer";
+        return;
+    }
+
+    header->sequence++;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    //most of the wall doesn't change between copies - compare each
+    //tile row by row and only write from the first row that differs
+    size_t stride = (size_t)width * 4;
+    tilesCopied = 0;
+
+    for(int ty = 0; ty < height; ty += SHARED_CANVAS_TILE){
+        int rows = MIN(SHARED_CANVAS_TILE, height - ty);
+
+        for(int tx = 0; tx < width; tx += SHARED_CANVAS_TILE){
+            size_t rowBytes = MIN(SHARED_CANVAS_TILE, width - tx) * 4;
+            size_t offset   = ty * stride + tx * 4;
+
+            int y = 0;
+            while(y < rows && memcmp(pixels + offset + y * stride, data + offset + y * stride, rowBytes) == 0) y++;
+            if(y == rows) continue;
+
+            for(; y < rows; y++){
+                memcpy(pixels + offset + y * stride, data + offset + y * stride, rowBytes);
+            }
+            tilesCopied++;
+        }
+    }
+
+    pbo.unmap();
+
+    std::atomic_thread_fence(std::memory_order_release);
+    header->sequence++;
+    header->bHasWall = 1;
+    header->numCopies++;
+}
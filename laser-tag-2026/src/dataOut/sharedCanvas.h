@@ -0,0 +1,110 @@
+#ifndef _SHARED_CANVAS_H
+#define _SHARED_CANVAS_H
+
+#include "ofMain.h"
+#include "imageProjection.h"
+#include "sceneSlots.h"
+
+//keeps what is on the wall in a named shared memory segment that
+//outlives the app - if we crash mid show the supervisor starts us
+//straight back up (see supervisor.h), we attach to the segment
+//again and the wall comes back as it was.
+//
+//every SHARED_CANVAS_FRAMES frames the canvas is read back through a
+//pixel buffer like canvasSnapshot does and copied in tile by tile -
+//only the tiles that changed are written. the brush panel settings
+//go in with it.
+//
+//the header sequence is odd while tiles are being written. a crash
+//in the middle leaves each tile from one copy or the next, a few
+//frames apart, so we take it either way.
+//
+//a clean exit removes the segment so the next normal start is blank.
+//on linux and mac it lives in /dev/shm (shm_open) - on windows a
+//named mapping dies with its last handle so there it is backed by a
+//file in data/ instead.
+
+#define SHARED_CANVAS_FRAMES    10      //frames between copies - the most a crash can lose
+#define SHARED_CANVAS_TILE      64
+#define SHARED_CANVAS_MAGIC     0x5643544C  //"LTCV"
+#define SHARED_CANVAS_VERSION   1
+#define SHARED_CANVAS_HEADER    4096    //the pixels start a page in
+
+struct sharedCanvasHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width, height;
+    volatile uint32_t sequence;     //odd while writing
+    uint32_t bHasWall;              //0 after a clear - nothing to bring back
+    sceneBrushState brush;
+    uint64_t numCopies;
+};
+
+class sharedCanvas{
+
+public:
+
+    sharedCanvas();
+    ~sharedCanvas();
+
+    //attaches to the segment the last run left or makes a new one.
+    //returns true if there is a wall in it to bring back
+    bool setup(int w, int h);
+
+    //unmaps - the segment stays for the next run
+    void close();
+
+    //clean exit - unmaps and deletes the segment
+    void remove();
+
+    bool isSetup();
+
+    //what was on the wall when the last run died - rgba
+    bool getWall(ofPixels & pix, sceneBrushState & state);
+
+    void setBrushState(const sceneBrushState & state);
+
+    //the wall was cleared - a crash now should come back blank
+    void clear();
+
+    //call once per frame from the gl thread
+    void update(imageProjection & projection);
+
+    //a copy straight away at startup - every page of the segment
+    //is touched once so none of them fault in mid show
+    void prewarm(imageProjection & projection);
+
+    //for the status line
+    int getTilesCopied();
+
+protected:
+
+    bool map(size_t bytes);
+    void unmap();
+
+    void startReadback(imageProjection & projection);
+    void finishReadback();
+
+    string name;
+    size_t numBytes;
+    sharedCanvasHeader * header;
+    unsigned char * pixels;
+
+#ifdef TARGET_WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+
+    int width, height;
+
+    ofFbo fbo;
+    ofBufferObject pbo;
+    bool bReadbackPending;
+    uint64_t readbackFrame;
+    uint64_t lastCopyFrame;
+    int tilesCopied;
+};
+
+#endif
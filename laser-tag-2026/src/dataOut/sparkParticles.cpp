@@ -0,0 +1,230 @@
+#include "sparkParticles.h"
+
+//kept out of the class so the restrict qualifiers stick and
+//the loop vectorizes - every array is its own allocation
+//-----------------------------------------------------
+static void integrate(float * __restrict x, float * __restrict y,
+                      float * __restrict vx, float * __restrict vy,
+                      float * __restrict age, int n, float dt, float drag, float gravity){
+    for(int i = 0; i < n; i++){
+        vx[i] *= drag;
+        vy[i]  = vy[i] * drag + gravity;
+        x[i]  += vx[i] * dt;
+        y[i]  += vy[i] * dt;
+        age[i] += dt;
+    }
+}
+
+//-----------------------------------------------------
+sparkParticles::sparkParticles(){
+    width      = 0;
+    height     = 0;
+    numAlive   = 0;
+    bVboSetup  = false;
+    amount     = 60;
+    maxLife    = 0.6;
+    size       = 6;
+    red        = 1;
+    green      = 1;
+    blue       = 1;
+    brightness = 1;
+    oldX       = 0;
+    oldY       = 0;
+    carry      = 0;
+    bHaveOld   = false;
+}
+
+//-----------------------------------------------------
+void sparkParticles::setup(int w, int h){
+    width  = w;
+    height = h;
+
+    px.assign(SPARK_MAX, 0);
+    py.assign(SPARK_MAX, 0);
+    vx.assign(SPARK_MAX, 0);
+    vy.assign(SPARK_MAX, 0);
+    age.assign(SPARK_MAX, 0);
+    life.assign(SPARK_MAX, 1);
+
+    verts.assign(SPARK_MAX * 2, 0);
+    colors.assign(SPARK_MAX * 4, 0);
+
+    setupSprite();
+    clear();
+}
+
+//a soft round dot - point sprites need normalized coords so no arb
+//-----------------------------------------------------
+void sparkParticles::setupSprite(){
+    ofPixels pix;
+    pix.allocate(SPARK_SPRITE, SPARK_SPRITE, OF_PIXELS_RGBA);
+
+    float radius = SPARK_SPRITE * 0.5;
+    unsigned char * data = pix.getData();
+    for(int y = 0; y < SPARK_SPRITE; y++){
+        for(int x = 0; x < SPARK_SPRITE; x++){
+            float dx = x + 0.5 - radius;
+            float dy = y + 0.5 - radius;
+            float d  = ofClamp(1.0 - sqrt(dx * dx + dy * dy) / radius, 0, 1);
+
+            unsigned char * p = data + (y * SPARK_SPRITE + x) * 4;
+            p[0] = 255;
+            p[1] = 255;
+            p[2] = 255;
+            p[3] = d * d * 255;
+        }
+    }
+
+    sprite.allocate(pix, false);
+    sprite.loadData(pix);
+}
+
+//-----------------------------------------------------
+void sparkParticles::clear(){
+    numAlive = 0;
+    carry    = 0;
+    bHaveOld = false;
+}
+
+//-----------------------------------------------------
+void sparkParticles::setSettings(float _amount, float _life, float _size){
+    amount  = MAX(0, _amount);
+    maxLife = MAX(0.05, _life);
+    size    = MAX(1, _size);
+}
+
+void sparkParticles::setColor(int r, int g, int b){
+    red   = r / 255.0;
+    green = g / 255.0;
+    blue  = b / 255.0;
+}
+
+void sparkParticles::setBrightness(float _brightness){
+    brightness = ofClamp(_brightness * 0.01, 0, 1);
+}
+
+int sparkParticles::getNumAlive(){
+    return numAlive;
+}
+
+//-----------------------------------------------------
+void sparkParticles::addPoint(float x, float y, bool newStroke){
+    x *= width;
+    y *= height;
+
+    if(newStroke || !bHaveOld){
+        oldX     = x;
+        oldY     = y;
+        carry    = 0;
+        bHaveOld = true;
+        return;
+    }
+
+    float dx = x - oldX;
+    float dy = y - oldY;
+
+    //the fractional part carries over so slow strokes still spark
+    carry += amount * sqrt(dx * dx + dy * dy) / (float)width;
+    int count = (int)carry;
+    carry -= count;
+
+    emit(x, y, dx, dy, count);
+
+    oldX = x;
+    oldY = y;
+}
+
+//spread along the segment so a fast stroke leaves a trail
+//-----------------------------------------------------
+void sparkParticles::emit(float x, float y, float dx, float dy, int count){
+    count = MIN(count, SPARK_MAX - numAlive);
+
+    float dist = sqrt(dx * dx + dy * dy);
+
+    for(int i = 0; i < count; i++){
+        int n = numAlive++;
+
+        float t     = random.uniform();
+        float angle = random.uniform(TWO_PI);
+        float speed = random.uniform(0.2, 1.0) * (120.0 + dist * 6.0);
+
+        px[n]   = x - dx * t;
+        py[n]   = y - dy * t;
+        vx[n]   = cos(angle) * speed + dx * 4.0;
+        vy[n]   = sin(angle) * speed + dy * 4.0;
+        age[n]  = 0;
+        life[n] = maxLife * random.uniform(0.5, 1.0);
+    }
+}
+
+//swap in the last live spark so there are no holes
+//-----------------------------------------------------
+void sparkParticles::kill(int i){
+    int last = --numAlive;
+    px[i]   = px[last];
+    py[i]   = py[last];
+    vx[i]   = vx[last];
+    vy[i]   = vy[last];
+    age[i]  = age[last];
+    life[i] = life[last];
+}
+
+//-----------------------------------------------------
+void sparkParticles::update(float dt){
+    if(numAlive == 0) return;
+
+    dt = MIN(dt, 0.1);
+
+    float drag = MAX(0, 1.0 - SPARK_DRAG * dt);
+    integrate(&px[0], &py[0], &vx[0], &vy[0], &age[0], numAlive, dt, drag, SPARK_GRAVITY * dt);
+
+    for(int i = 0; i < numAlive; ){
+        if(age[i] >= life[i] || px[i] < 0 || px[i] >= width || py[i] >= height){
+            kill(i);
+        }else{
+            i++;
+        }
+    }
+
+    //white hot when they leave the tip - cooling to the brush color
+    for(int i = 0; i < numAlive; i++){
+        float fade = 1.0 - age[i] / life[i];
+        float hot  = fade * fade;
+
+        verts[i * 2    ] = px[i];
+        verts[i * 2 + 1] = py[i];
+
+        colors[i * 4    ] = (red   + (1.0 - red)   * hot) * brightness;
+        colors[i * 4 + 1] = (green + (1.0 - green) * hot) * brightness;
+        colors[i * 4 + 2] = (blue  + (1.0 - blue)  * hot) * brightness;
+        colors[i * 4 + 3] = fade;
+    }
+}
+
+//-----------------------------------------------------
+void sparkParticles::draw(float scale){
+    if(numAlive == 0) return;
+
+    //the buffers are sized for SPARK_MAX once - after that
+    //only the live part is sent each frame
+    if(!bVboSetup){
+        vbo.setVertexData(&verts[0], 2, SPARK_MAX, GL_STREAM_DRAW);
+        vbo.setColorData(&colors[0], SPARK_MAX, GL_STREAM_DRAW);
+        bVboSetup = true;
+    }else{
+        vbo.updateVertexData(&verts[0], numAlive);
+        vbo.updateColorData(&colors[0], numAlive);
+    }
+
+    ofPushStyle();
+    ofEnableBlendMode(OF_BLENDMODE_ADD);
+    ofEnablePointSprites();
+    glPointSize(MAX(1, size * scale));
+
+    sprite.bind();
+    vbo.draw(GL_POINTS, 0, numAlive);
+    sprite.unbind();
+
+    ofDisablePointSprites();
+    ofPopStyle();
+}
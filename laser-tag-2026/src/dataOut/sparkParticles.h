@@ -0,0 +1,78 @@
+#ifndef _SPARK_PARTICLES_H
+#define _SPARK_PARTICLES_H
+
+#include "ofMain.h"
+#include "brushRandom.h"
+
+//sparks thrown off the laser tip - drawn on top of whatever brush
+//is active. the faster the laser moves the more sparks fly.
+//
+//every particle field is its own array (x[], y[], vx[] ...) so the
+//integration loop is a straight run over floats that the compiler
+//turns into simd. dead sparks are swapped out with the last live one
+//so the live ones are always 0 - numAlive. they go to the gpu as one
+//vbo and get drawn with a single GL_POINTS call as point sprites.
+
+#define SPARK_MAX        8192    //hard cap - new sparks are dropped past this
+#define SPARK_GRAVITY    900.0   //canvas pixels per second squared
+#define SPARK_DRAG       2.5     //per second
+#define SPARK_SPRITE     32      //size of the round sprite texture
+
+class sparkParticles{
+
+public:
+
+    sparkParticles();
+
+    void setup(int w, int h);
+    void clear();
+
+    //amount - sparks per canvas width moved
+    //life   - seconds a spark lives for
+    //size   - sprite size in canvas pixels
+    void setSettings(float _amount, float _life, float _size);
+    void setColor(int r, int g, int b);
+
+    //0 - 100 same as the projector brightness so sparks
+    //don't outshine the laser for the tracker
+    void setBrightness(float _brightness);
+
+    //same coords as the brushes - 0 to 1
+    void addPoint(float x, float y, bool newStroke);
+
+    void update(float dt);
+
+    //draw in canvas coords - the caller sets up the warp
+    void draw(float scale);
+
+    int getNumAlive();
+
+protected:
+
+    void emit(float x, float y, float dx, float dy, int count);
+    void kill(int i);
+    void setupSprite();
+
+    int width, height;
+    int numAlive;
+
+    //structure of arrays - all SPARK_MAX long
+    vector<float> px, py, vx, vy, age, life;
+
+    //what we hand to the vbo
+    vector<float> verts;
+    vector<float> colors;
+
+    ofVbo vbo;
+    ofTexture sprite;
+    bool bVboSetup;
+
+    float amount, maxLife, size;
+    float red, green, blue, brightness;
+    float oldX, oldY, carry;
+    bool bHaveOld;
+
+    brushRandom random;
+};
+
+#endif
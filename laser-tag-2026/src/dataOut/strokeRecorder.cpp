@@ -0,0 +1,107 @@
+#include "strokeRecorder.h"
+#include "asyncLogger.h"
+
+//-----------------------------------------------------
+strokeRecorder::strokeRecorder(){
+    folder    = "strokes/";
+    startTime = 0;
+    numEvents = 0;
+}
+
+strokeRecorder::~strokeRecorder(){
+    close();
+}
+
+//-----------------------------------------------------
+void strokeRecorder::setup(string saveFolder){
+    endPiece();
+    folder = saveFolder;
+    ofDirectory::createDirectory(folder, true, true);
+    pruneLogs();
+}
+
+//-----------------------------------------------------
+bool strokeRecorder::startPiece(){
+
+    //milliseconds too - a clear and a new piece in the same second
+    //would overwrite the last one otherwise
+    filePath = folder + "strokes-" + ofGetTimestampString("%Y-%m-%d-%H-%M-%S-%i") + "." + STROKE_LOG_EXTENSION;
+
+    if(!file.open(filePath, ofFile::WriteOnly, true)){
+        LT_LOG_ERROR("strokeRecorder") << "couldn't open " << filePath;
+        return false;
+    }
+
+    uint32_t version = STROKE_LOG_VERSION;
+    file.write(STROKE_LOG_MAGIC, 4);
+    file.write((const char *)&version, 4);
+
+    startTime = ofGetElapsedTimeMillis();
+    numEvents = 0;
+    return true;
+}
+
+//-----------------------------------------------------
+void strokeRecorder::addPoint(float x, float y, bool newStroke){
+    addPoint(x, y, newStroke, ofGetElapsedTimeMillis());
+}
+
+void strokeRecorder::addPoint(float x, float y, bool newStroke, uint64_t timeMs){
+
+    if(!file.is_open() && !startPiece()) return;
+
+    strokeEvent e;
+    e.timeMs = timeMs > startTime ? timeMs - startTime : 0;
+    e.x      = x;
+    e.y      = y;
+    e.flags  = newStroke ? STROKE_FLAG_NEW_STROKE : 0;
+
+    //the stream buffers this for us
+    file.write((const char *)&e, sizeof(strokeEvent));
+    numEvents++;
+}
+
+//-----------------------------------------------------
+void strokeRecorder::endPiece(){
+    if(!file.is_open()) return;
+
+    file.close();
+
+    //someone just waving the laser around
+    if(numEvents < STROKE_LOG_MIN_EVENTS){
+        ofFile::removeFile(filePath, false);
+    }else{
+        pruneLogs();
+    }
+    numEvents = 0;
+}
+
+//the names are timestamps so sorted the oldest come first
+//-----------------------------------------------------
+void strokeRecorder::pruneLogs(){
+    ofDirectory dir;
+    dir.allowExt(STROKE_LOG_EXTENSION);
+    dir.listDir(folder);
+    dir.sort();
+
+    int numOld = (int)dir.size() - STROKE_LOG_MAX_FILES;
+    for(int i = 0; i < numOld; i++){
+        ofFile::removeFile(dir.getPath(i), false);
+    }
+    if(numOld > 0){
+        LT_LOG_NOTICE("strokeRecorder") << "removed the " << numOld << " oldest stroke logs";
+    }
+}
+
+void strokeRecorder::close(){
+    endPiece();
+}
+
+//-----------------------------------------------------
+bool strokeRecorder::isRecording(){
+    return file.is_open();
+}
+
+int strokeRecorder::getNumEvents(){
+    return numEvents;
+}
@@ -0,0 +1,67 @@
+#ifndef _STROKE_RECORDER_H
+#define _STROKE_RECORDER_H
+
+#include "ofMain.h"
+
+//records the laser points of each piece to a small binary log
+//so they can be played back later by strokePlayback.
+//
+//a piece is everything painted between two clears - each piece
+//gets its own file. the file is an 8 byte header followed by
+//fixed size events so it can be read straight out of memory.
+
+#define STROKE_LOG_MAGIC		"LTSK"
+#define STROKE_LOG_VERSION		1
+#define STROKE_LOG_HEADER_SIZE	8
+#define STROKE_LOG_EXTENSION	"lts"
+
+//pieces with fewer points than this are thrown away
+#define STROKE_LOG_MIN_EVENTS	30
+
+//past this many logs in the folder the oldest go
+#define STROKE_LOG_MAX_FILES	1000
+
+#define STROKE_FLAG_NEW_STROKE	1
+#define STROKE_FLAG_CLEAR		2
+
+typedef struct{
+    uint32_t timeMs;	//since the start of the piece
+    float    x, y;		//tracker coords 0 - 1
+    uint32_t flags;
+}strokeEvent;
+
+class strokeRecorder{
+
+public:
+
+    strokeRecorder();
+    ~strokeRecorder();
+
+    void setup(string saveFolder);
+
+    void addPoint(float x, float y, bool newStroke);
+    
+    //timeMs is ofGetElapsedTimeMillis() time - for points that
+    //happened a little before they reached us
+    void addPoint(float x, float y, bool newStroke, uint64_t timeMs);
+
+    //finishes the current piece - the next point starts a new one
+    void endPiece();
+    void close();
+
+    bool isRecording();
+    int  getNumEvents();
+
+protected:
+
+    bool startPiece();
+    void pruneLogs();
+
+    ofFile   file;
+    string   folder;
+    string   filePath;
+    uint64_t startTime;
+    int      numEvents;
+};
+
+#endif
@@ -1,9 +1,15 @@
 #include "ofMain.h"
 #include "ofApp.h"
 #include "ofAppGLFWWindow.h"
+#include "supervisor.h"
 
 //========================================================================
-int main( ){
+int main(int argc, char *argv[]){
+	//restarts us if we go down mid show - no window of its own
+	for(int i = 1; i < argc; i++){
+		if(string(argv[i]) == "--supervise") return runSupervisor(argc, argv);
+	}
+
 	ofGLFWWindowSettings settings;
 	settings.setSize(1280, 800);
 	settings.resizable = true;
@@ -29,6 +35,7 @@ int main( ){
 	guiWindow->setVerticalSync(false);
 
 	shared_ptr<ofApp> mainApp(new ofApp);
+	mainApp->args.assign(argv + 1, argv + argc);
 	mainApp->setupProjector();
 	ofAddListener(guiWindow->events().draw, mainApp.get(), &ofApp::drawProjector);
 	ofAddListener(guiWindow->events().keyPressed, mainApp.get(), &ofApp::keyPressedProjector);
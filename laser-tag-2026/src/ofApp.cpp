@@ -1,8 +1,12 @@
 #include "ofApp.h"
+#include "asyncLogger.h"
 
 
 //--------------------------------------------------------------
 void ofApp::setup(){
+	//log from here on without blocking the render thread
+	asyncLogger::get().setup(ofToDataPath("logs/"));
+
 	//set background to black
 //    ofSetLogLevel(OF_LOG_VERBOSE);
 	ofBackground(0, 0, 0);
@@ -27,17 +31,56 @@ void ofApp::setup(){
     ofAddListener(ofEvents().mouseMoved, this, &ofApp::scaleMouseCoords, OF_EVENT_ORDER_BEFORE_APP);
 
 	init();
+
+	//bring back the wall if the last run crashed - never for the
+	//test runs, and not when the supervisor thinks the wall is
+	//what keeps taking us down
+	bool bSoak = std::find(args.begin(), args.end(), "--soak") != args.end();
+	bool bRecord = std::find(args.begin(), args.end(), "--regression-record") != args.end();
+	bool bRegression = bRecord || std::find(args.begin(), args.end(), "--regression") != args.end();
+	bool bTestRun = bSoak || bRegression;
+	appCtrl.setRestoreWall(!bTestRun && std::find(args.begin(), args.end(), "--no-restore") == args.end());
+
+	//hours of synthetic painting - fails if memory or frame time creep up.
+	//update() runs it with no frame limit and quits when it is done
+	if(bSoak){
+		float hours = SOAK_HOURS;
+		auto it = std::find(args.begin(), args.end(), "--soak-hours");
+		if(it != args.end() && it + 1 != args.end()){
+			hours = ofToFloat(*(it + 1));
+		}
+		appCtrl.setSoakTest(hours);
+		ofSetFrameRate(0);
+	}
 	appCtrl.setup();
+
+	//check the brushes against the golden images and quit
+	if(bRegression){
+		int failed = appCtrl.runBrushRegression(bRecord);
+		asyncLogger::get().close();
+		OF_EXIT_APP(failed > 0 ? 1 : 0);
+	}
 }
 
+//called from main() before setup - args are already set.
+//a soak runs flat out so no waiting on the display either
 void ofApp::setupProjector(){
     ofBackground(0, 0, 0);
-    ofSetVerticalSync(true);
-    ofSetFrameRate(60);
+    bool bSoak = std::find(args.begin(), args.end(), "--soak") != args.end();
+    ofSetVerticalSync(!bSoak);
+    ofSetFrameRate(bSoak ? 0 : 60);
 }
 
 //--------------------------------------------------------------
 void ofApp::update(){
+	//the soak is over - report and quit
+	if(appCtrl.isSoakDone()){
+		int failed = appCtrl.finishSoakTest();
+		asyncLogger::get().close();
+		OF_EXIT_APP(failed > 0 ? 1 : 0);
+		return;
+	}
+
 	appCtrl.mainLoop();
 	ofSoundUpdate();  // Ensure sound system gets updated
 }
@@ -49,6 +92,7 @@ void ofApp::draw(){
 
 void ofApp::exit(){
     appCtrl.exit();
+    asyncLogger::get().close();
 }
 
 void ofApp::windowResized(int w, int h){
@@ -126,7 +170,7 @@ void ofApp::init(){
 	}
 	
 	if(bCount != 68669){
-		printf("You have attempted to modify or remove our notice - app exiting\n");
+		LT_LOG_FATAL("ofApp") << "You have attempted to modify or remove our notice - app exiting";
 		OF_EXIT_APP(0);
 	}
 	//printf("bCount is %i\n", bCount);
@@ -17,6 +17,9 @@ public:
 	void init();
     void exit();
 
+    //command line - set by main()
+    vector<string> args;
+
     void windowResized(int w, int h);
     void preDrawScale(ofEventArgs& args);
     void postDrawScale(ofEventArgs& args);
@@ -0,0 +1,203 @@
+#include "activityHeatmap.h"
+#include "asyncLogger.h"
+
+//-----------------------------------------------------
+activityHeatmap::activityHeatmap(){
+    gridW = 0;
+    gridH = 0;
+    maxDwell = 0;
+
+    lastX    = 0;
+    lastY    = 0;
+    bHasLast = false;
+
+    numStrokes    = 0;
+    numClears     = 0;
+    numCovered    = 0;
+    activeSeconds = 0;
+    sessionStart  = 0;
+    lastRefresh   = 0;
+}
+
+//-----------------------------------------------------
+void activityHeatmap::setup(int _gridW, int _gridH){
+    gridW = MAX(1, _gridW);
+    gridH = MAX(1, _gridH);
+
+    dwell.assign(gridW * gridH, 0);
+    strokes.assign(gridW * gridH, 0);
+    ink.assign(gridW * gridH, 0);
+    maxDwell = 0;
+
+    bHasLast = false;
+
+    numStrokes    = 0;
+    numClears     = 0;
+    numCovered    = 0;
+    activeSeconds = 0;
+    sessionStart  = ofGetElapsedTimef();
+    sessionName   = ofGetTimestampString("%Y-%m-%d-%H-%M-%S");
+
+    livePixels.allocate(gridW, gridH, OF_PIXELS_RGB);
+    livePixels.set(0);
+    liveTex.allocate(livePixels);
+    liveTex.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+    liveTex.loadData(livePixels);
+    lastRefresh = 0;
+}
+
+//-----------------------------------------------------
+void activityHeatmap::addSample(float x, float y, float dt, bool bLaserSeen, bool bNewStroke){
+    if(gridW == 0) return;
+
+    if(!bLaserSeen){
+        bHasLast = false;
+        return;
+    }
+
+    x = ofClamp(x, 0, 1);
+    y = ofClamp(y, 0, 1);
+
+    int cx = MIN((int)(x * gridW), gridW - 1);
+    int cy = MIN((int)(y * gridH), gridH - 1);
+    int cell = cy * gridW + cx;
+
+    dwell[cell] += dt;
+    if(dwell[cell] > maxDwell) maxDwell = dwell[cell];
+    activeSeconds += dt;
+
+    if(bNewStroke){
+        strokes[cell]++;
+        numStrokes++;
+        bHasLast = false;
+    }
+
+    //the ink goes in the cell the segment ends in
+    if(bHasLast){
+        float dist = sqrt((x - lastX) * (x - lastX) + (y - lastY) * (y - lastY));
+        if(dist > 0){
+            if(ink[cell] == 0) numCovered++;
+            ink[cell] += dist;
+        }
+    }
+
+    lastX    = x;
+    lastY    = y;
+    bHasLast = true;
+}
+
+void activityHeatmap::addClear(){
+    numClears++;
+    bHasLast = false;
+}
+
+//-----------------------------------------------------
+int activityHeatmap::getNumStrokes(){
+    return numStrokes;
+}
+
+int activityHeatmap::getNumClears(){
+    return numClears;
+}
+
+float activityHeatmap::getActiveMinutes(){
+    return activeSeconds / 60.0;
+}
+
+float activityHeatmap::getSessionMinutes(){
+    return (ofGetElapsedTimef() - sessionStart) / 60.0;
+}
+
+float activityHeatmap::getCoverage(){
+    if(gridW == 0) return 0;
+    return (float)numCovered / (float)(gridW * gridH);
+}
+
+//black - red - yellow - white
+//-----------------------------------------------------
+ofColor activityHeatmap::heatColor(float amount){
+    amount = ofClamp(amount, 0, 1) * 3.0;
+    if(amount < 1.0) return ofColor(amount * 255, 0, 0);
+    if(amount < 2.0) return ofColor(255, (amount - 1.0) * 255, 0);
+    return ofColor(255, 255, (amount - 2.0) * 255);
+}
+
+//-----------------------------------------------------
+void activityHeatmap::fillHeatPixels(ofPixels & pix, int scale){
+    if(!pix.isAllocated() || (int)pix.getWidth() != gridW * scale || (int)pix.getHeight() != gridH * scale){
+        pix.allocate(gridW * scale, gridH * scale, OF_PIXELS_RGB);
+    }
+
+    //square root so the quieter areas still show up
+    float norm = maxDwell > 0 ? 1.0 / sqrt(maxDwell) : 0;
+
+    for(int y = 0; y < gridH; y++){
+        for(int x = 0; x < gridW; x++){
+            ofColor c = heatColor(sqrt(dwell[y * gridW + x]) * norm);
+            for(int sy = 0; sy < scale; sy++){
+                for(int sx = 0; sx < scale; sx++){
+                    pix.setColor(x * scale + sx, y * scale + sy, c);
+                }
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------
+bool activityHeatmap::exportSession(string folder){
+    if(gridW == 0) return false;
+
+    ofDirectory::createDirectory(folder, true, true);
+    string base = folder + "session-" + sessionName;
+
+    ofFile csv(base + ".csv", ofFile::WriteOnly, false);
+    if(!csv.is_open()){
+        LT_LOG_ERROR("activityHeatmap") << "couldn't write " << base << ".csv";
+        return false;
+    }
+
+    csv << "session_start," << sessionName << "\n";
+    csv << "session_minutes," << getSessionMinutes() << "\n";
+    csv << "active_minutes," << getActiveMinutes() << "\n";
+    csv << "strokes," << numStrokes << "\n";
+    csv << "clears," << numClears << "\n";
+    csv << "coverage," << getCoverage() << "\n";
+    csv << "grid," << gridW << "x" << gridH << "\n";
+    csv << "\n";
+    csv << "cell_x,cell_y,dwell_seconds,strokes,ink\n";
+    for(int y = 0; y < gridH; y++){
+        for(int x = 0; x < gridW; x++){
+            int cell = y * gridW + x;
+            csv << x << "," << y << "," << dwell[cell] << "," << strokes[cell] << "," << ink[cell] << "\n";
+        }
+    }
+    csv.close();
+
+    ofPixels png;
+    fillHeatPixels(png, HEATMAP_PNG_SCALE);
+    if(!ofSaveImage(png, base + ".png")){
+        LT_LOG_ERROR("activityHeatmap") << "couldn't write " << base << ".png";
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------
+void activityHeatmap::draw(float x, float y, float w, float h){
+    if(gridW == 0) return;
+
+    //no need to upload every frame
+    if(ofGetElapsedTimef() - lastRefresh >= HEATMAP_REFRESH){
+        lastRefresh = ofGetElapsedTimef();
+        fillHeatPixels(livePixels, 1);
+        liveTex.loadData(livePixels);
+    }
+
+    ofPushStyle();
+    ofSetColor(255, 255, 255);
+    liveTex.draw(x, y, w, h);
+    ofNoFill();
+    ofDrawRectangle(x, y, w, h);
+    ofPopStyle();
+}
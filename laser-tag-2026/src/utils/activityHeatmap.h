@@ -0,0 +1,72 @@
+#ifndef _ACTIVITY_HEATMAP_H
+#define _ACTIVITY_HEATMAP_H
+
+#include "ofMain.h"
+
+//keeps a coarse grid of where people painted and a few
+//counters for the whole session.
+//
+//every sample only touches the one cell the laser is in so it
+//costs the same however big the wall is - cheap enough to leave
+//on all the time.
+//
+//per cell  - dwell   seconds the laser spent there
+//            strokes strokes that started there
+//            ink     distance the laser drew there (screen widths)
+
+#define HEATMAP_GRID_W	64
+#define HEATMAP_GRID_H	36
+#define HEATMAP_REFRESH	0.5		//seconds between updates of the live view
+#define HEATMAP_PNG_SCALE 10	//exported png is the grid scaled up by this
+
+class activityHeatmap{
+
+public:
+
+    activityHeatmap();
+
+    void setup(int gridW = HEATMAP_GRID_W, int gridH = HEATMAP_GRID_H);
+
+    //call once a frame - x and y are tracker coords 0 - 1
+    void addSample(float x, float y, float dt, bool bLaserSeen, bool bNewStroke);
+    void addClear();
+
+    int   getNumStrokes();
+    int   getNumClears();
+    float getActiveMinutes();
+    float getSessionMinutes();
+    float getCoverage();	//0 - 1 - how much of the grid got some ink
+
+    //writes <folder>/session-<timestamp>.csv and .png
+    bool exportSession(string folder);
+
+    void draw(float x, float y, float w, float h);
+
+protected:
+
+    void fillHeatPixels(ofPixels & pix, int scale);
+    ofColor heatColor(float amount);
+
+    int gridW, gridH;
+
+    vector<float> dwell;
+    vector<int>   strokes;
+    vector<float> ink;
+    float maxDwell;
+
+    float lastX, lastY;
+    bool  bHasLast;
+
+    int   numStrokes;
+    int   numClears;
+    int   numCovered;
+    float activeSeconds;
+    float sessionStart;
+    string sessionName;
+
+    ofPixels  livePixels;
+    ofTexture liveTex;
+    float     lastRefresh;
+};
+
+#endif
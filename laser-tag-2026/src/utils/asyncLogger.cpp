@@ -0,0 +1,310 @@
+#include "asyncLogger.h"
+
+//so openFrameworks' own ofLog calls go through us as well
+//-----------------------------------------------------
+class asyncLogChannel : public ofBaseLoggerChannel{
+
+public:
+
+    void log(ofLogLevel level, const std::string & module, const std::string & message){
+        asyncLogger::get().push(level, module.c_str(), message.c_str(), 0);
+    }
+
+    void log(ofLogLevel level, const std::string & module, const char * format, ...){
+        va_list args;
+        va_start(args, format);
+        log(level, module, format, args);
+        va_end(args);
+    }
+
+    void log(ofLogLevel level, const std::string & module, const char * format, va_list args){
+        char text[LOG_TEXT_SIZE];
+        vsnprintf(text, LOG_TEXT_SIZE, format, args);
+        asyncLogger::get().push(level, module.c_str(), text, 0);
+    }
+};
+
+//the ring this thread writes to - handed back when the thread ends
+//-----------------------------------------------------
+struct logRingHolder{
+    logRing * ring;
+    logRingHolder(){ ring = NULL; }
+    ~logRingHolder(){ if(ring != NULL) ring->bInUse = false; }
+};
+
+static thread_local logRingHolder threadRing;
+
+///////////////////////////////////////////////////////
+//
+//		PER LINE RATE LIMIT
+//
+///////////////////////////////////////////////////////
+
+//-----------------------------------------------------
+logSite::logSite(){
+    windowStart = 0;
+    count       = 0;
+    skipped     = 0;
+}
+
+//a few threads could race on a new window - worst case
+//one or two extra lines get through which is fine
+//-----------------------------------------------------
+bool logSite::allow(ofLogLevel level, int & suppressed){
+    if(level >= OF_LOG_WARNING){
+        suppressed = skipped.exchange(0);
+        return true;
+    }
+
+    uint64_t now   = asyncLogger::get().getTimeMs();
+    uint64_t start = windowStart.load(std::memory_order_relaxed);
+
+    if(now - start >= LOG_SITE_WINDOW && windowStart.compare_exchange_strong(start, now)){
+        count = 0;
+    }
+
+    if(count.fetch_add(1) >= LOG_SITE_BURST){
+        skipped++;
+        return false;
+    }
+
+    suppressed = skipped.exchange(0);
+    return true;
+}
+
+///////////////////////////////////////////////////////
+//
+//		ONE MESSAGE
+//
+///////////////////////////////////////////////////////
+
+//-----------------------------------------------------
+logLine::logLine(ofLogLevel _level, const char * _module, int _suppressed)
+    : buffer(text, LOG_TEXT_SIZE), stream(&buffer){
+    level      = _level;
+    module     = _module;
+    suppressed = _suppressed;
+}
+
+//-----------------------------------------------------
+logLine::~logLine(){
+    *buffer.end() = 0;
+    asyncLogger::get().push(level, module, text, suppressed);
+}
+
+///////////////////////////////////////////////////////
+//
+//		THE LOGGER
+//
+///////////////////////////////////////////////////////
+
+//-----------------------------------------------------
+asyncLogger & asyncLogger::get(){
+    static asyncLogger logger;
+    return logger;
+}
+
+//-----------------------------------------------------
+asyncLogger::asyncLogger(){
+    bRunning  = false;
+    bWake     = false;
+    bFileOpen = false;
+    startTime = std::chrono::steady_clock::now();
+}
+
+//-----------------------------------------------------
+asyncLogger::~asyncLogger(){
+    close();
+
+    for(size_t i = 0; i < rings.size(); i++){
+        delete rings[i];
+    }
+    rings.clear();
+}
+
+//-----------------------------------------------------
+void asyncLogger::setup(string logFolder){
+    if(bRunning) return;
+
+    if(logFolder != ""){
+        ofDirectory::createDirectory(logFolder, false, true);
+        string path = ofFilePath::join(logFolder, "laser-tag-" + ofGetTimestampString("%Y-%m-%d-%H-%M-%S") + ".log");
+        bFileOpen = logFile.open(path, ofFile::WriteOnly, false);
+    }
+
+    bRunning = true;
+    flusher  = std::thread(&asyncLogger::flusherLoop, this);
+
+    ofSetLoggerChannel(std::make_shared<asyncLogChannel>());
+}
+
+//-----------------------------------------------------
+void asyncLogger::close(){
+    if(bRunning){
+        ofLogToConsole();
+
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            bRunning = false;
+            bWake    = true;
+        }
+        wakeCondition.notify_one();
+        flusher.join();
+    }
+
+    flush();
+
+    std::unique_lock<std::mutex> lock(writeMutex);
+    if(bFileOpen){
+        logFile.close();
+        bFileOpen = false;
+    }
+}
+
+//-----------------------------------------------------
+bool asyncLogger::isEnabled(ofLogLevel level){
+    return level >= ofGetLogLevel() && ofGetLogLevel() != OF_LOG_SILENT;
+}
+
+//-----------------------------------------------------
+uint64_t asyncLogger::getTimeMs(){
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+//the first time a thread logs it gets a ring - a free one
+//from a thread that has finished or a new one
+//-----------------------------------------------------
+logRing * asyncLogger::getRing(){
+    if(threadRing.ring != NULL) return threadRing.ring;
+
+    std::unique_lock<std::mutex> lock(ringsMutex);
+
+    logRing * ring = NULL;
+    for(size_t i = 0; i < rings.size(); i++){
+        if(!rings[i]->bInUse){
+            ring = rings[i];
+            break;
+        }
+    }
+
+    if(ring == NULL){
+        ring = new logRing();
+        ring->head    = 0;
+        ring->tail    = 0;
+        ring->dropped = 0;
+        rings.push_back(ring);
+    }
+
+    ring->bInUse = true;
+    threadRing.ring = ring;
+    return ring;
+}
+
+//-----------------------------------------------------
+void asyncLogger::push(ofLogLevel level, const char * module, const char * text, int suppressed){
+    logRing * ring = getRing();
+
+    unsigned int head = ring->head.load(std::memory_order_relaxed);
+    unsigned int tail = ring->tail.load(std::memory_order_acquire);
+    if(head - tail >= LOG_RING_SIZE){
+        ring->dropped++;
+        return;
+    }
+
+    logRecord & r = ring->records[head & (LOG_RING_SIZE - 1)];
+    r.timeMs = getTimeMs();
+    r.level  = level;
+    strncpy(r.module, module, LOG_MODULE_SIZE - 1);
+    r.module[LOG_MODULE_SIZE - 1] = 0;
+
+    if(suppressed > 0){
+        snprintf(r.text, LOG_TEXT_SIZE, "%s (%d more like this skipped)", text, suppressed);
+    }else{
+        strncpy(r.text, text, LOG_TEXT_SIZE - 1);
+        r.text[LOG_TEXT_SIZE - 1] = 0;
+    }
+
+    ring->head.store(head + 1, std::memory_order_release);
+
+    //don't sit on errors - the app might be about to go down.
+    //no lock here - if the flusher misses it it's up in LOG_FLUSH_MS anyway
+    if(level >= OF_LOG_ERROR && bRunning){
+        bWake = true;
+        wakeCondition.notify_one();
+    }
+}
+
+//-----------------------------------------------------
+void asyncLogger::flusherLoop(){
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_MS), [this]{ return bWake.load(); });
+            bWake = false;
+        }
+
+        flush();
+
+        if(!bRunning) break;
+    }
+}
+
+//takes everything out of the rings and writes it in time order
+//-----------------------------------------------------
+void asyncLogger::flush(){
+    std::unique_lock<std::mutex> writeLock(writeMutex);
+
+    vector<logRing *> current;
+    {
+        std::unique_lock<std::mutex> lock(ringsMutex);
+        current = rings;
+    }
+
+    vector<logRecord> records;
+    for(size_t i = 0; i < current.size(); i++){
+        logRing * ring = current[i];
+
+        unsigned int tail = ring->tail.load(std::memory_order_relaxed);
+        unsigned int head = ring->head.load(std::memory_order_acquire);
+        for(unsigned int t = tail; t != head; t++){
+            records.push_back(ring->records[t & (LOG_RING_SIZE - 1)]);
+        }
+        ring->tail.store(head, std::memory_order_release);
+
+        unsigned int dropped = ring->dropped.exchange(0);
+        if(dropped > 0){
+            logRecord r;
+            r.timeMs = getTimeMs();
+            r.level  = OF_LOG_WARNING;
+            snprintf(r.module, LOG_MODULE_SIZE, "asyncLogger");
+            snprintf(r.text, LOG_TEXT_SIZE, "a thread logged too fast - %u messages dropped", dropped);
+            records.push_back(r);
+        }
+    }
+
+    if(records.empty()) return;
+
+    std::stable_sort(records.begin(), records.end(), [](const logRecord & a, const logRecord & b){
+        return a.timeMs < b.timeMs;
+    });
+
+    for(size_t i = 0; i < records.size(); i++){
+        write(records[i]);
+    }
+
+    fflush(stdout);
+    if(bFileOpen) logFile.flush();
+}
+
+//same layout as the openFrameworks console logger
+//-----------------------------------------------------
+void asyncLogger::write(const logRecord & r){
+    string levelName = ofGetLogLevelName((ofLogLevel)r.level, true);
+
+    FILE * out = r.level >= OF_LOG_ERROR ? stderr : stdout;
+    fprintf(out, "[%s] %s: %s\n", levelName.c_str(), r.module, r.text);
+
+    if(bFileOpen){
+        logFile << "[" << ofToString(r.timeMs / 1000.0, 3) << "] [" << levelName << "] " << r.module << ": " << r.text << "\n";
+    }
+}
@@ -0,0 +1,173 @@
+#ifndef _ASYNC_LOGGER_H
+#define _ASYNC_LOGGER_H
+
+#include "ofMain.h"
+
+//logging that never makes the calling thread wait on the terminal
+//or the disk.
+//
+//every thread writes fixed size records into its own ring buffer -
+//one writer and one reader so there are no locks, just two counters.
+//a background thread empties the rings every LOG_FLUSH_MS and writes
+//them to the console and to the log file. if a ring is full the
+//record is dropped and counted instead.
+//
+//lines that can fire every frame or every point use LT_LOG_LIMITED
+//instead - after LOG_SITE_BURST messages in LOG_SITE_WINDOW ms the
+//rest are skipped before they are even formatted, and the number
+//skipped goes out with the next one. warnings and errors are never
+//skipped.
+//
+//use it like ofLog:
+//    LT_LOG_ERROR("myModule") << "couldn't open " << path;
+//    LT_LOG_LIMITED(OF_LOG_NOTICE, "myModule") << "queue full";
+
+#define LOG_RING_SIZE		256		//records per thread - power of two
+#define LOG_TEXT_SIZE		200		//longer messages are cut short
+#define LOG_MODULE_SIZE		32
+#define LOG_FLUSH_MS		50
+#define LOG_SITE_BURST		5
+#define LOG_SITE_WINDOW		1000	//ms
+
+struct logRecord{
+    uint64_t timeMs;
+    int      level;
+    char     module[LOG_MODULE_SIZE];
+    char     text[LOG_TEXT_SIZE];
+};
+
+//one per thread that logs - the thread owns head, the flusher tail
+struct logRing{
+    logRecord records[LOG_RING_SIZE];
+    std::atomic<unsigned int> head;
+    std::atomic<unsigned int> tail;
+    std::atomic<unsigned int> dropped;
+    std::atomic<bool> bInUse;
+};
+
+//one per LT_LOG_LIMITED line in the code
+class logSite{
+
+public:
+
+    logSite();
+
+    //false if this line has used up its budget for now - always
+    //true from OF_LOG_WARNING up. suppressed is how many were
+    //skipped before this one
+    bool allow(ofLogLevel level, int & suppressed);
+
+protected:
+
+    std::atomic<uint64_t> windowStart;
+    std::atomic<int> count;
+    std::atomic<int> skipped;
+};
+
+class asyncLogger{
+
+public:
+
+    static asyncLogger & get();
+
+    //starts the flusher - the log file goes in logFolder,
+    //leave it empty to only log to the console.
+    //also takes over openFrameworks' own ofLog messages
+    void setup(string logFolder);
+
+    //stops the flusher and writes out anything left
+    void close();
+
+    bool isEnabled(ofLogLevel level);
+
+    //never blocks
+    void push(ofLogLevel level, const char * module, const char * text, int suppressed);
+
+    uint64_t getTimeMs();
+
+protected:
+
+    asyncLogger();
+    ~asyncLogger();
+
+    logRing * getRing();
+
+    void flusherLoop();
+    void flush();
+    void write(const logRecord & r);
+
+    //only taken the first time a thread logs and by the flusher
+    std::mutex ringsMutex;
+    vector<logRing *> rings;
+
+    std::thread flusher;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<bool> bRunning;
+    std::atomic<bool> bWake;
+
+    std::mutex writeMutex;		//flush from close and the flusher
+    ofFile logFile;
+    bool bFileOpen;
+
+    std::chrono::steady_clock::time_point startTime;
+};
+
+//collects one message into a fixed buffer - no allocations -
+//and hands it to the logger when it goes out of scope
+class logLine{
+
+public:
+
+    logLine(ofLogLevel _level, const char * _module, int _suppressed);
+    ~logLine();
+
+    template<class T>
+    logLine & operator<<(const T & value){
+        stream << value;
+        return *this;
+    }
+
+    //for std::endl and friends
+    logLine & operator<<(std::ostream & (*fn)(std::ostream &)){
+        fn(stream);
+        return *this;
+    }
+
+protected:
+
+    class fixedBuffer : public std::streambuf{
+    public:
+        fixedBuffer(char * start, int size){ setp(start, start + size - 1); }
+        char * end(){ return pptr(); }
+    };
+
+    ofLogLevel   level;
+    const char * module;
+    int          suppressed;
+
+    char text[LOG_TEXT_SIZE];
+    fixedBuffer  buffer;
+    std::ostream stream;
+};
+
+//runs the body once if the level is on
+#define LT_LOG(level, module) \
+    for(int ltOnce_ = asyncLogger::get().isEnabled(level); ltOnce_; ltOnce_ = 0) \
+        logLine(level, module, 0)
+
+//the same but only if the line is in budget too.
+//the lambda gives every line its own static logSite
+#define LT_LOG_LIMITED(level, module) \
+    for(int ltSkipped_ = 0, ltOnce_ = asyncLogger::get().isEnabled(level) && \
+            []() -> logSite & { static logSite site; return site; }().allow(level, ltSkipped_); \
+        ltOnce_; ltOnce_ = 0) \
+        logLine(level, module, ltSkipped_)
+
+#define LT_LOG_VERBOSE(module)	LT_LOG(OF_LOG_VERBOSE, module)
+#define LT_LOG_NOTICE(module)	LT_LOG(OF_LOG_NOTICE, module)
+#define LT_LOG_WARNING(module)	LT_LOG(OF_LOG_WARNING, module)
+#define LT_LOG_ERROR(module)	LT_LOG(OF_LOG_ERROR, module)
+#define LT_LOG_FATAL(module)	LT_LOG(OF_LOG_FATAL_ERROR, module)
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef _BRUSH_RANDOM_H
+#define _BRUSH_RANDOM_H
+
+#include "ofMain.h"
+#include <random>
+
+//a small random number generator that belongs to one brush.
+//
+//brushes use this instead of rand() / ofRandom() so that the same
+//seed and the same strokes always paint the same picture - which is
+//what brushRegression relies on. without a seed it starts somewhere
+//different every run like before.
+//
+//pcg32 - fast, tiny state and the same numbers on every platform
+
+class brushRandom{
+
+public:
+
+    brushRandom(){
+        setSeed(std::random_device()());
+    }
+
+    void setSeed(uint64_t seed){
+        state = 0;
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next(){
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t xorShifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+        uint32_t rot = (uint32_t)(old >> 59u);
+        return (xorShifted >> rot) | (xorShifted << ((-rot) & 31));
+    }
+
+    //0 - 1 but never 1
+    float uniform(){
+        return (next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    //same ranges as ofRandom
+    float uniform(float max){
+        return uniform() * max;
+    }
+
+    float uniform(float min, float max){
+        return min + uniform() * (max - min);
+    }
+
+    //0 - n-1 - same as rand() % n for the drips
+    int below(int n){
+        if(n <= 0) return 0;
+        return (int)(((uint64_t)next() * (uint64_t)n) >> 32);
+    }
+
+protected:
+
+    uint64_t state;
+};
+
+#endif
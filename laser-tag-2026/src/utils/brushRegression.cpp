@@ -0,0 +1,266 @@
+#include "brushRegression.h"
+#include "asyncLogger.h"
+
+//-----------------------------------------------------
+brushRegression::brushRegression(){
+    tolerance   = REGRESSION_TOLERANCE;
+    bRecord     = false;
+    numPassed   = 0;
+    numFailed   = 0;
+    numRecorded = 0;
+}
+
+//-----------------------------------------------------
+void brushRegression::setup(string _folder){
+    folder = _folder;
+}
+
+void brushRegression::setTolerance(int _tolerance){
+    tolerance = MAX(0, _tolerance);
+}
+
+void brushRegression::setRecord(bool _bRecord){
+    bRecord = _bRecord;
+}
+
+int brushRegression::getNumPassed(){
+    return numPassed;
+}
+
+int brushRegression::getNumFailed(){
+    return numFailed;
+}
+
+int brushRegression::getNumRecorded(){
+    return numRecorded;
+}
+
+//-----------------------------------------------------
+bool brushRegression::loadScript(string path, vector<regressionCommand> & commands){
+    ofBuffer buffer = ofBufferFromFile(path);
+    if(buffer.size() == 0){
+        LT_LOG_ERROR("brushRegression") << "empty or missing script " << path;
+        return false;
+    }
+
+    commands.clear();
+
+    int lineNum = 0;
+    for(auto line : buffer.getLines()){
+        lineNum++;
+
+        string trimmed = ofTrim(line);
+        if(trimmed.empty() || trimmed[0] == '#') continue;
+
+        vector<string> parts = ofSplitString(trimmed, " ", true, true);
+
+        regressionCommand c;
+        c.x      = 0;
+        c.y      = 0;
+        c.frames = 0;
+
+        if((parts[0] == "stroke" || parts[0] == "point") && parts.size() == 3){
+            c.type = parts[0] == "stroke" ? regressionCommand::STROKE : regressionCommand::POINT;
+            c.x    = ofToFloat(parts[1]);
+            c.y    = ofToFloat(parts[2]);
+        }
+        else if(parts[0] == "frames" && parts.size() == 2){
+            c.type   = regressionCommand::FRAMES;
+            c.frames = MAX(0, ofToInt(parts[1]));
+        }
+        else if(parts[0] == "clear" && parts.size() == 1){
+            c.type = regressionCommand::CLEAR;
+        }
+        else{
+            LT_LOG_ERROR("brushRegression") << path << " line " << lineNum << " - don't know '" << trimmed << "'";
+            return false;
+        }
+
+        commands.push_back(c);
+    }
+
+    return true;
+}
+
+//one point per frame - the same as the laser
+//-----------------------------------------------------
+void brushRegression::replay(baseBrush * brush, const vector<regressionCommand> & commands){
+
+    //settings fixed here so the gui doesn't change the result
+    brush->setBrushColor(255, 255, 255);
+    brush->setBrushBrightness(100);
+    brush->setBrushWidth(REGRESSION_BRUSH_WIDTH);
+    brush->setNumSteps(15);
+    brush->dripsSettings(true, 4, 0.5, 0, 2);
+    brush->setBrushNumber(0);
+    brush->clear();
+    brush->setRandomSeed(REGRESSION_SEED);
+
+    for(size_t i = 0; i < commands.size(); i++){
+        const regressionCommand & c = commands[i];
+
+        switch(c.type){
+            case regressionCommand::STROKE:
+            case regressionCommand::POINT:
+                brush->addPoint(c.x, c.y, c.type == regressionCommand::STROKE);
+                brush->update();
+                break;
+
+            case regressionCommand::FRAMES:
+                for(int f = 0; f < c.frames; f++){
+                    brush->update();
+                }
+                break;
+
+            case regressionCommand::CLEAR:
+                brush->clear();
+                brush->update();
+                break;
+        }
+    }
+}
+
+//-----------------------------------------------------
+bool brushRegression::compare(const ofPixels & result, const ofPixels & expected, ofPixels & diff, int & numBad){
+    numBad = 0;
+
+    if(result.getWidth() != expected.getWidth() || result.getHeight() != expected.getHeight()
+       || result.getNumChannels() != expected.getNumChannels()){
+        numBad = -1;
+        return false;
+    }
+
+    int w  = result.getWidth();
+    int h  = result.getHeight();
+    int ch = result.getNumChannels();
+
+    diff.allocate(w, h, OF_PIXELS_RGB);
+
+    const unsigned char * a = result.getData();
+    const unsigned char * b = expected.getData();
+    unsigned char * d = diff.getData();
+
+    for(int i = 0; i < w * h; i++){
+        int worst = 0;
+        int sum   = 0;
+        for(int c = 0; c < ch; c++){
+            worst = MAX(worst, abs((int)a[i * ch + c] - (int)b[i * ch + c]));
+            sum  += b[i * ch + c];
+        }
+
+        if(worst > tolerance){
+            numBad++;
+            d[i * 3    ] = 255;
+            d[i * 3 + 1] = 0;
+            d[i * 3 + 2] = 0;
+        }else{
+            unsigned char grey = sum / (ch * 3);
+            d[i * 3    ] = grey;
+            d[i * 3 + 1] = grey;
+            d[i * 3 + 2] = grey;
+        }
+    }
+
+    return numBad == 0;
+}
+
+//-----------------------------------------------------
+int brushRegression::run(baseBrush ** brushes, int numBrushes){
+    numPassed   = 0;
+    numFailed   = 0;
+    numRecorded = 0;
+    failed.clear();
+
+    string scriptDir = ofFilePath::join(folder, "scripts");
+    string goldenDir = ofFilePath::join(folder, "golden");
+    string diffDir   = ofFilePath::join(folder, "diff");
+
+    ofDirectory DL;
+    DL.allowExt("txt");
+    int numScripts = DL.listDir(scriptDir);
+    DL.sort();
+
+    if(numScripts == 0){
+        LT_LOG_ERROR("brushRegression") << "no stroke scripts in " << scriptDir;
+        return 1;
+    }
+
+    ofDirectory::createDirectory(goldenDir, false, true);
+    ofDirectory::createDirectory(diffDir, false, true);
+
+    for(int s = 0; s < numScripts; s++){
+        vector<regressionCommand> commands;
+        if(!loadScript(DL.getPath(s), commands)){
+            numFailed++;
+            failed.push_back(DL.getName(s));
+            continue;
+        }
+
+        string scriptName = ofFilePath::getBaseName(DL.getName(s));
+
+        for(int i = 0; i < numBrushes; i++){
+            string name = brushes[i]->getName() + "-" + scriptName;
+            string goldenPath = ofFilePath::join(goldenDir, name + ".png");
+
+            replay(brushes[i], commands);
+
+            ofPixels result;
+            brushes[i]->getTexture().readToPixels(result);
+
+            if(!ofFile::doesFileExist(goldenPath, false)){
+                if(bRecord){
+                    ofSaveImage(result, goldenPath);
+                    numRecorded++;
+                    LT_LOG_NOTICE("brushRegression") << name << " - recorded a new golden image";
+                }else{
+                    numFailed++;
+                    failed.push_back(name);
+                    LT_LOG_ERROR("brushRegression") << name << " - FAILED no golden image - record one with --regression-record";
+                }
+                continue;
+            }
+
+            ofPixels expected, diff;
+            ofLoadImage(expected, goldenPath);
+
+            int numBad = 0;
+            if(compare(result, expected, diff, numBad)){
+                numPassed++;
+                continue;
+            }
+
+            numFailed++;
+            failed.push_back(name);
+            if(numBad < 0){
+                LT_LOG_ERROR("brushRegression") << name << " - FAILED canvas is " << result.getWidth() << "x" << result.getHeight()
+                    << " " << result.getNumChannels() << "ch, golden is " << expected.getWidth() << "x" << expected.getHeight()
+                    << " " << expected.getNumChannels() << "ch";
+            }else{
+                ofSaveImage(diff, ofFilePath::join(diffDir, name + ".png"));
+                LT_LOG_ERROR("brushRegression") << name << " - FAILED " << numBad << " pixels off by more than " << tolerance;
+            }
+        }
+    }
+
+    //don't leave the test strokes on the wall
+    for(int i = 0; i < numBrushes; i++){
+        brushes[i]->clear();
+    }
+
+    LT_LOG(numFailed > 0 ? OF_LOG_ERROR : OF_LOG_NOTICE, "brushRegression") << numPassed << " passed, " << numFailed << " failed, " << numRecorded << " recorded";
+
+    //the names again at the end so ci only has to read the tail -
+    //as many lines as it takes to fit them in the log
+    string line;
+    for(size_t i = 0; i < failed.size(); i++){
+        if(!line.empty() && line.size() + failed[i].size() + 2 >= LOG_TEXT_SIZE - 10){
+            LT_LOG_ERROR("brushRegression") << "failed: " << line;
+            line.clear();
+        }
+        line += (line.empty() ? "" : ", ") + failed[i];
+    }
+    if(!line.empty()){
+        LT_LOG_ERROR("brushRegression") << "failed: " << line;
+    }
+    return numFailed;
+}
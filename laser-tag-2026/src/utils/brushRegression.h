@@ -0,0 +1,79 @@
+#ifndef _BRUSH_REGRESSION_H
+#define _BRUSH_REGRESSION_H
+
+#include "ofMain.h"
+#include "baseBrush.h"
+
+//checks that the brushes still paint what they used to.
+//
+//every stroke script in regression/scripts/ is played through every
+//brush with fixed settings and a fixed random seed, and the canvas
+//is compared with regression/golden/<brush>-<script>.png. a pixel
+//fails if any channel is more than the tolerance away. failures
+//write regression/diff/<brush>-<script>.png - failed pixels in red
+//over a dim copy of the golden image.
+//
+//a missing golden image is a failure. with --regression-record the
+//canvas is saved as the new golden image instead - so to accept a
+//change on purpose delete its golden image and record again. the
+//golden images are made on the reference machine and committed.
+//
+//run it with   laser-tag-2026 --regression
+//              laser-tag-2026 --regression-record
+//
+//script format - one command per line, # for comments
+//  stroke x y     start a new stroke at x y (0 - 1)
+//  point x y      carry on the stroke
+//  frames n       let the brush update n times without new points
+//  clear          clear the canvas
+
+#define REGRESSION_SEED			2026
+#define REGRESSION_TOLERANCE	8
+#define REGRESSION_BRUSH_WIDTH	20
+
+struct regressionCommand{
+    enum{
+        STROKE,
+        POINT,
+        FRAMES,
+        CLEAR
+    } type;
+    float x, y;
+    int frames;
+};
+
+class brushRegression{
+
+public:
+
+    brushRegression();
+
+    void setup(string _folder);
+    void setTolerance(int _tolerance);
+
+    //save missing golden images instead of failing them
+    void setRecord(bool _bRecord);
+
+    //plays every script through every brush - returns how many failed
+    int run(baseBrush ** brushes, int numBrushes);
+
+    int getNumPassed();
+    int getNumFailed();
+    int getNumRecorded();
+
+protected:
+
+    bool loadScript(string path, vector<regressionCommand> & commands);
+    void replay(baseBrush * brush, const vector<regressionCommand> & commands);
+
+    //false if the sizes differ or numBad > 0
+    bool compare(const ofPixels & result, const ofPixels & expected, ofPixels & diff, int & numBad);
+
+    string folder;
+    int tolerance;
+    bool bRecord;
+    int numPassed, numFailed, numRecorded;
+    vector<string> failed;
+};
+
+#endif
@@ -0,0 +1,391 @@
+#include "soakTest.h"
+#include "asyncLogger.h"
+#include <atomic>
+#include <new>
+
+#if defined(TARGET_LINUX)
+#include <unistd.h>
+#elif defined(TARGET_OSX)
+#include <mach/mach.h>
+#elif defined(TARGET_WIN32)
+#include <psapi.h>
+#endif
+
+#ifdef LT_SOAK_TEST
+
+//every heap allocation in the app goes through these in a soak
+//build. every form is replaced so nothing allocated by one of ours
+//is freed by the library's or the other way round
+static std::atomic<int64_t> numNews(0);
+static std::atomic<int64_t> numDeletes(0);
+
+static void * soakAlloc(size_t size, size_t alignment){
+    numNews.fetch_add(1, std::memory_order_relaxed);
+    if(size == 0) size = 1;
+    while(true){
+        void * p = NULL;
+        if(alignment == 0){
+            p = malloc(size);
+        }else{
+#ifdef TARGET_WIN32
+            p = _aligned_malloc(size, alignment);
+#else
+            if(posix_memalign(&p, alignment, size) != 0) p = NULL;
+#endif
+        }
+        if(p != NULL) return p;
+        std::new_handler handler = std::get_new_handler();
+        if(handler == NULL) throw std::bad_alloc();
+        handler();
+    }
+}
+
+static void soakFree(void * p){
+    if(p == NULL) return;
+    numDeletes.fetch_add(1, std::memory_order_relaxed);
+    free(p);
+}
+
+static void soakFreeAligned(void * p){
+#ifdef TARGET_WIN32
+    if(p == NULL) return;
+    numDeletes.fetch_add(1, std::memory_order_relaxed);
+    _aligned_free(p);
+#else
+    //posix_memalign memory goes back through free
+    soakFree(p);
+#endif
+}
+
+void * operator new(size_t size){
+    return soakAlloc(size, 0);
+}
+void * operator new[](size_t size){
+    return soakAlloc(size, 0);
+}
+void * operator new(size_t size, std::align_val_t al){
+    return soakAlloc(size, (size_t)al);
+}
+void * operator new[](size_t size, std::align_val_t al){
+    return soakAlloc(size, (size_t)al);
+}
+
+void * operator new(size_t size, const std::nothrow_t &) noexcept{
+    try{ return soakAlloc(size, 0); }catch(...){ return NULL; }
+}
+void * operator new[](size_t size, const std::nothrow_t &) noexcept{
+    try{ return soakAlloc(size, 0); }catch(...){ return NULL; }
+}
+void * operator new(size_t size, std::align_val_t al, const std::nothrow_t &) noexcept{
+    try{ return soakAlloc(size, (size_t)al); }catch(...){ return NULL; }
+}
+void * operator new[](size_t size, std::align_val_t al, const std::nothrow_t &) noexcept{
+    try{ return soakAlloc(size, (size_t)al); }catch(...){ return NULL; }
+}
+
+void operator delete(void * p) noexcept{
+    soakFree(p);
+}
+void operator delete[](void * p) noexcept{
+    soakFree(p);
+}
+void operator delete(void * p, size_t) noexcept{
+    soakFree(p);
+}
+void operator delete[](void * p, size_t) noexcept{
+    soakFree(p);
+}
+void operator delete(void * p, std::align_val_t) noexcept{
+    soakFreeAligned(p);
+}
+void operator delete[](void * p, std::align_val_t) noexcept{
+    soakFreeAligned(p);
+}
+void operator delete(void * p, size_t, std::align_val_t) noexcept{
+    soakFreeAligned(p);
+}
+void operator delete[](void * p, size_t, std::align_val_t) noexcept{
+    soakFreeAligned(p);
+}
+void operator delete(void * p, const std::nothrow_t &) noexcept{
+    soakFree(p);
+}
+void operator delete[](void * p, const std::nothrow_t &) noexcept{
+    soakFree(p);
+}
+void operator delete(void * p, std::align_val_t, const std::nothrow_t &) noexcept{
+    soakFreeAligned(p);
+}
+void operator delete[](void * p, std::align_val_t, const std::nothrow_t &) noexcept{
+    soakFreeAligned(p);
+}
+
+#endif
+
+//-----------------------------------------------------
+soakTest::soakTest(){
+    numFrames       = 0;
+    frameNum        = 0;
+    framesPerSample = SOAK_SAMPLE_SECS * SOAK_FPS;
+    frameStart      = 0;
+    runStart        = 0;
+}
+
+//-----------------------------------------------------
+void soakTest::setup(float hours, string _folder){
+    folder    = _folder;
+    numFrames = MAX(1, (int)(hours * 3600 * SOAK_FPS));
+    frameNum  = 0;
+
+    frameTimes.clear();
+    frameTimes.reserve(framesPerSample);
+    samples.clear();
+
+    LT_LOG_NOTICE("soakTest") << "running " << hours << " hours of show time - " << numFrames << " frames";
+}
+
+//-----------------------------------------------------
+bool soakTest::isDone(){
+    return frameNum >= numFrames;
+}
+
+int soakTest::getFrameNum(){
+    return frameNum;
+}
+
+float soakTest::getShowTime(){
+    return frameNum / (float)SOAK_FPS;
+}
+
+//-----------------------------------------------------
+void soakTest::update(){
+    uint64_t now = ofGetElapsedTimeMicros();
+    if(frameStart == 0){
+        frameStart = now;
+        runStart   = now;
+        return;
+    }
+
+    frameTimes.push_back((now - frameStart) / 1000.0f);
+    frameStart = now;
+    frameNum++;
+
+    if(frameNum % framesPerSample == 0 || frameNum == numFrames){
+        takeSample();
+    }
+}
+
+//a laser wandering over the wall - painting for most of
+//each stroke then off for the rest
+//-----------------------------------------------------
+bool soakTest::getLaser(float & x, float & y){
+    float t = getShowTime();
+    if(fmod(t, SOAK_STROKE_SECS) >= SOAK_STROKE_SECS * 0.75) return false;
+
+    int stroke = (int)(t / SOAK_STROKE_SECS);
+    float a = t * 0.9 + stroke * 1.7;
+    x = 0.5 + 0.4 * sin(a * 1.3) * cos(a * 0.31);
+    y = 0.5 + 0.4 * sin(a * 0.7 + stroke);
+    return true;
+}
+
+//the quad goes clockwise from the top left - in between is
+//close enough for a dot
+//-----------------------------------------------------
+void soakTest::makeFrame(ofPixels & frame, const ofPoint * quad, const ofColor & color){
+    frame.set(0);
+
+    float x, y;
+    if(!getLaser(x, y)) return;
+
+    ofPoint top    = quad[0] + (quad[1] - quad[0]) * x;
+    ofPoint bottom = quad[3] + (quad[2] - quad[3]) * x;
+    ofPoint pos    = top + (bottom - top) * y;
+
+    int w = frame.getWidth();
+    int h = frame.getHeight();
+    int ch = frame.getNumChannels();
+    int r = SOAK_LASER_RADIUS;
+
+    for(int py = MAX(0, (int)pos.y - r); py <= MIN(h - 1, (int)pos.y + r); py++){
+        for(int px = MAX(0, (int)pos.x - r); px <= MIN(w - 1, (int)pos.x + r); px++){
+            if((px - pos.x) * (px - pos.x) + (py - pos.y) * (py - pos.y) > r * r) continue;
+            unsigned char * p = frame.getData() + (py * w + px) * ch;
+            p[0] = color.r;
+            p[1] = color.g;
+            p[2] = color.b;
+        }
+    }
+}
+
+//-----------------------------------------------------
+void soakTest::takeSample(){
+    if(frameTimes.empty()) return;
+
+    sample s;
+    s.hours      = getShowTime() / 3600.0f;
+    s.rssMb      = getResidentBytes() / (1024.0 * 1024.0);
+    s.liveAllocs = getLiveAllocations();
+    s.numAllocs  = getNumAllocations();
+
+    double sumMs = 0;
+    for(float t : frameTimes) sumMs += t;
+    s.fps = sumMs > 0 ? frameTimes.size() * 1000.0 / sumMs : 0;
+
+    //the order doesn't matter once they are in here
+    size_t n = frameTimes.size();
+    std::nth_element(frameTimes.begin(), frameTimes.begin() + n / 2, frameTimes.end());
+    s.p50Ms = frameTimes[n / 2];
+    size_t p99 = MIN(n - 1, (size_t)(n * 0.99));
+    std::nth_element(frameTimes.begin(), frameTimes.begin() + p99, frameTimes.end());
+    s.p99Ms = frameTimes[p99];
+    s.maxMs = *std::max_element(frameTimes.begin() + p99, frameTimes.end());
+
+    samples.push_back(s);
+    frameTimes.clear();
+
+    LT_LOG_NOTICE("soakTest") << ofToString(s.hours, 2) << "h  rss " << ofToString(s.rssMb, 1) << "mb  live allocs " << s.liveAllocs
+        << "  p99 " << ofToString(s.p99Ms, 2) << "ms  max " << ofToString(s.maxMs, 2) << "ms  " << ofToString(s.fps, 0) << " fps";
+}
+
+//-----------------------------------------------------
+double soakTest::getGrowth(const vector<double> & values, int first, double & start){
+    int n = values.size() - first;
+    double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    for(int i = first; i < (int)values.size(); i++){
+        double x = samples[i].hours;
+        sumX  += x;
+        sumY  += values[i];
+        sumXX += x * x;
+        sumXY += x * values[i];
+    }
+
+    double denom = n * sumXX - sumX * sumX;
+    double slope = denom != 0 ? (n * sumXY - sumX * sumY) / denom : 0;
+    double hoursFirst = samples[first].hours;
+    double hoursLast  = samples.back().hours;
+
+    start = (sumY - slope * sumX) / n + slope * hoursFirst;
+    return slope * (hoursLast - hoursFirst);
+}
+
+//-----------------------------------------------------
+int soakTest::finish(){
+
+    //stuck at the display rate means vsync is still on somewhere -
+    //the run took as long as the show would and the frame times
+    //are mostly waiting
+    double realSecs = runStart != 0 ? (frameStart - runStart) / 1000000.0 : 0;
+    double fps = realSecs > 0 ? frameNum / realSecs : 0;
+    LT_LOG_NOTICE("soakTest") << frameNum << " frames in " << ofToString(realSecs / 3600.0, 2) << "h - "
+        << ofToString(fps, 0) << " fps, " << ofToString(fps / SOAK_FPS, 1) << "x show time";
+    if(fps > 0 && fps < SOAK_FPS * 1.1){
+        LT_LOG_WARNING("soakTest") << "ran at about the display rate - check vsync is off on both windows";
+    }
+
+    ofDirectory::createDirectory(folder, true, true);
+    string path = folder + "soak-" + ofGetTimestampString("%Y-%m-%d-%H-%M-%S") + ".csv";
+
+    ofFile csv(path, ofFile::WriteOnly, false);
+    if(csv.is_open()){
+        csv << "hours,rss_mb,live_allocs,total_allocs,p50_ms,p99_ms,max_ms,fps\n";
+        for(auto & s : samples){
+            csv << s.hours << "," << s.rssMb << "," << s.liveAllocs << "," << s.numAllocs << ","
+                << s.p50Ms << "," << s.p99Ms << "," << s.maxMs << "," << s.fps << "\n";
+        }
+        csv.close();
+    }else{
+        LT_LOG_ERROR("soakTest") << "couldn't write " << path;
+    }
+
+    int first = 0;
+    while(first < (int)samples.size() && samples[first].hours * 3600 < SOAK_WARMUP_SECS) first++;
+
+    if((int)samples.size() - first < 3){
+        LT_LOG_WARNING("soakTest") << "too short to see a trend - " << samples.size() - first << " samples after warm up";
+        return 0;
+    }
+
+    vector<double> rss, allocs, p99;
+    for(auto & s : samples){
+        rss.push_back(s.rssMb);
+        allocs.push_back(s.liveAllocs);
+        p99.push_back(s.p99Ms);
+    }
+
+    int numFailed = 0;
+    double start;
+
+    if(samples[first].rssMb >= 0){
+        double growth = getGrowth(rss, first, start);
+        bool bFailed = growth > SOAK_MAX_RSS_GROWTH_MB;
+        numFailed += bFailed;
+        LT_LOG(bFailed ? OF_LOG_ERROR : OF_LOG_NOTICE, "soakTest") << (bFailed ? "FAILED " : "") << "resident memory grew "
+            << ofToString(growth, 1) << "mb from " << ofToString(start, 1) << "mb - limit " << SOAK_MAX_RSS_GROWTH_MB << "mb";
+    }else{
+        LT_LOG_WARNING("soakTest") << "no resident memory on this platform - not checked";
+    }
+
+    double growth;
+    bool bFailed;
+
+    if(samples[first].liveAllocs >= 0){
+        growth = getGrowth(allocs, first, start);
+        bFailed = growth > SOAK_MAX_ALLOC_GROWTH;
+        numFailed += bFailed;
+        LT_LOG(bFailed ? OF_LOG_ERROR : OF_LOG_NOTICE, "soakTest") << (bFailed ? "FAILED " : "") << "live allocations grew "
+            << (int64_t)growth << " from " << (int64_t)start << " - limit " << SOAK_MAX_ALLOC_GROWTH;
+    }else{
+        LT_LOG_WARNING("soakTest") << "not built with LT_SOAK_TEST - live allocations not checked";
+    }
+
+    //under a millisecond a small wobble looks like a big change
+    growth = getGrowth(p99, first, start);
+    bFailed = growth > SOAK_MAX_P99_GROWTH * MAX(1.0, start);
+    numFailed += bFailed;
+    LT_LOG(bFailed ? OF_LOG_ERROR : OF_LOG_NOTICE, "soakTest") << (bFailed ? "FAILED " : "") << "p99 frame time grew "
+        << ofToString(growth, 2) << "ms from " << ofToString(start, 2) << "ms - limit " << (int)(SOAK_MAX_P99_GROWTH * 100) << "%";
+
+    LT_LOG_NOTICE("soakTest") << numFailed << " checks failed - samples in " << path;
+    return numFailed;
+}
+
+//-----------------------------------------------------
+int64_t soakTest::getResidentBytes(){
+#if defined(TARGET_LINUX)
+    long size = 0, resident = 0;
+    FILE * f = fopen("/proc/self/statm", "r");
+    if(f == NULL) return -1;
+    int num = fscanf(f, "%ld %ld", &size, &resident);
+    fclose(f);
+    if(num != 2) return -1;
+    return (int64_t)resident * sysconf(_SC_PAGESIZE);
+#elif defined(TARGET_OSX)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) return -1;
+    return info.resident_size;
+#elif defined(TARGET_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+    return counters.WorkingSetSize;
+#else
+    return -1;
+#endif
+}
+
+int64_t soakTest::getLiveAllocations(){
+#ifdef LT_SOAK_TEST
+    return numNews.load(std::memory_order_relaxed) - numDeletes.load(std::memory_order_relaxed);
+#else
+    return -1;
+#endif
+}
+
+int64_t soakTest::getNumAllocations(){
+#ifdef LT_SOAK_TEST
+    return numNews.load(std::memory_order_relaxed);
+#else
+    return -1;
+#endif
+}
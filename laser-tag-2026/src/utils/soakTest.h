@@ -0,0 +1,107 @@
+#ifndef _SOAK_TEST_H
+#define _SOAK_TEST_H
+
+#include "ofMain.h"
+
+//runs the whole app for hours of show time as fast as it will go
+//and checks nothing is slowly getting worse.
+//
+//these are the app's own frames with the frame rate limit off -
+//every one counts as 1 / SOAK_FPS of show time, so 12 hours is ~2.6
+//million frames. the camera is never opened - the tracker gets a
+//frame from makeFrame() with a synthetic laser dot in the quad, and
+//appController clears now and then and switches brush, the way a
+//night on the wall would. the app quits when it is done.
+//
+//every SOAK_SAMPLE_SECS of show time we take resident memory, the
+//number of live heap allocations and the frame times since the last
+//sample. once warmed up a straight line is fitted through each of
+//them - if it climbs more than the limit over the run the soak fails.
+//
+//heap allocations are only counted in a build with LT_SOAK_TEST
+//defined (make LT_SOAK=1) - the counting operator new would
+//otherwise be in every build. without it that check is skipped.
+//
+//run it with   laser-tag-2026 --soak [--soak-hours 12]
+//
+//samples go to soak/soak-<timestamp>.csv - returns how many checks failed
+
+#define SOAK_HOURS              12
+#define SOAK_FPS                60
+#define SOAK_SAMPLE_SECS        300     //show time between samples
+#define SOAK_WARMUP_SECS        1800    //pools and caches are still filling - not judged
+
+//what the synthetic laser does - in show time
+#define SOAK_STROKE_SECS        4       //a stroke and the gap after it
+#define SOAK_CLEAR_SECS         1800
+#define SOAK_BRUSH_SECS         1200
+#define SOAK_LASER_RADIUS       4       //camera pixels
+
+//how much each may climb over the judged part of the run
+#define SOAK_MAX_RSS_GROWTH_MB  32
+#define SOAK_MAX_ALLOC_GROWTH   20000
+#define SOAK_MAX_P99_GROWTH     0.25    //fraction of the p99 frame time at the start
+
+class soakTest{
+
+public:
+
+    soakTest();
+
+    void setup(float hours, string _folder);
+
+    bool isDone();
+    int   getFrameNum();
+    float getShowTime();    //seconds of show time so far
+
+    //call once per frame at the top of update - the time since
+    //the last call is how long the frame before took
+    void update();
+
+    //where the synthetic laser is on the wall, 0 - 1. false
+    //in the gaps between strokes
+    bool getLaser(float & x, float & y);
+
+    //a black camera frame with the laser in color where the quad
+    //puts that spot on the wall
+    void makeFrame(ofPixels & frame, const ofPoint * quad, const ofColor & color);
+
+    //writes the csv and checks the trends - returns how many failed
+    int finish();
+
+    //-1 if the platform doesn't say
+    static int64_t getResidentBytes();
+
+    //counted by our operator new / delete - see soakTest.cpp.
+    //-1 without LT_SOAK_TEST
+    static int64_t getLiveAllocations();
+    static int64_t getNumAllocations();
+
+protected:
+
+    struct sample{
+        float   hours;
+        double  rssMb;
+        int64_t liveAllocs;
+        int64_t numAllocs;
+        float   p50Ms, p99Ms, maxMs;
+        float   fps;        //real frames a second since the last sample
+    };
+
+    void takeSample();
+
+    //least squares line through values from the first judged sample on -
+    //how much it climbs over that span
+    double getGrowth(const vector<double> & values, int first, double & start);
+
+    string folder;
+    int numFrames, frameNum;
+    int framesPerSample;
+
+    uint64_t frameStart;
+    uint64_t runStart;
+    vector<float> frameTimes;   //ms since the last sample
+    vector<sample> samples;
+};
+
+#endif
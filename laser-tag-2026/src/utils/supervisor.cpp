@@ -0,0 +1,127 @@
+#include "supervisor.h"
+
+#ifdef TARGET_WIN32
+#include <process.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+enum childResult{
+    CHILD_EXITED,       //quit on its own - code is what it returned
+    CHILD_CRASHED,
+    CHILD_NOT_STARTED
+};
+
+//runs the app once and waits for it
+//-----------------------------------------------------
+static childResult runChild(vector<string> & args, int & code){
+    vector<char *> argv;
+    for(auto & a : args) argv.push_back((char *)a.c_str());
+    argv.push_back(NULL);
+    code = 0;
+
+#ifdef TARGET_WIN32
+    intptr_t r = _spawnv(_P_WAIT, argv[0], argv.data());
+    if(r == -1) return CHILD_NOT_STARTED;
+    code = (int)r;
+
+    //a crash comes back as the exception code - 0xC0000005 and
+    //friends. nothing we return ourselves looks like that
+    return ((uint32_t)r & 0xC0000000) == 0xC0000000 ? CHILD_CRASHED : CHILD_EXITED;
+#else
+    //the child writes errno down this if the exec fails - it closes
+    //by itself if the exec works, so any exit code is the app's own
+    int fds[2];
+    if(pipe(fds) != 0) return CHILD_NOT_STARTED;
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+    pid_t pid = fork();
+    if(pid < 0){
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return CHILD_NOT_STARTED;
+    }
+    if(pid == 0){
+        ::close(fds[0]);
+        execvp(argv[0], argv.data());
+        int err = errno;
+        if(write(fds[1], &err, sizeof(err)) < 0){}
+        _exit(127);
+    }
+    ::close(fds[1]);
+
+    int err = 0;
+    ssize_t n;
+    while((n = read(fds[0], &err, sizeof(err))) < 0 && errno == EINTR){}
+    ::close(fds[0]);
+
+    int status = 0;
+    while(waitpid(pid, &status, 0) < 0){
+        if(errno != EINTR) return CHILD_CRASHED;
+    }
+
+    if(n == sizeof(err)){
+        code = err;
+        return CHILD_NOT_STARTED;
+    }
+    if(WIFEXITED(status)){
+        code = WEXITSTATUS(status);
+        return CHILD_EXITED;
+    }
+    code = WIFSIGNALED(status) ? WTERMSIG(status) : -1;
+    return CHILD_CRASHED;
+#endif
+}
+
+//-----------------------------------------------------
+int runSupervisor(int argc, char * argv[]){
+
+    //the supervisor has no logger of its own - the app
+    //it runs writes to logs/ as usual
+    vector<string> args;
+    for(int i = 0; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--regression" || arg == "--regression-record" || arg == "--soak"){
+            ofLogError("supervisor") << arg << " is meant to end - run it without --supervise";
+            return 1;
+        }
+        if(arg != "--supervise") args.push_back(arg);
+    }
+
+    int numQuick = 0;
+    int numRuns  = 0;
+
+    while(true){
+        vector<string> runArgs = args;
+        if(numQuick >= SUPERVISOR_MAX_QUICK){
+            runArgs.push_back("--no-restore");
+            ofSleepMillis(1000);
+        }
+
+        uint64_t start = ofGetSystemTimeMillis();
+        int code = 0;
+        childResult result = runChild(runArgs, code);
+        numRuns++;
+
+        if(result == CHILD_NOT_STARTED){
+            ofLogError("supervisor") << "couldn't start " << args[0] << (code != 0 ? " - " + string(strerror(code)) : "");
+            return 1;
+        }
+
+        //it quit by itself - an error code is the app telling us
+        //something, not something a restart will fix
+        if(result == CHILD_EXITED){
+            ofLogNotice("supervisor") << "the app exited with " << code << " after " << numRuns << " runs";
+            return code;
+        }
+
+        bool bQuick = ofGetSystemTimeMillis() - start < SUPERVISOR_QUICK_SECS * 1000;
+        numQuick = bQuick ? numQuick + 1 : 0;
+
+        ofLogError("supervisor") << "the app crashed (" << code << ") - restarting"
+            << (numQuick >= SUPERVISOR_MAX_QUICK ? " with a blank wall" : "");
+    }
+}
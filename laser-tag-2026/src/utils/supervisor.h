@@ -0,0 +1,28 @@
+#ifndef _SUPERVISOR_H
+#define _SUPERVISOR_H
+
+#include "ofMain.h"
+
+//keeps the app up for a show. started with --supervise the app
+//doesn't open a window - it runs itself again without the flag and
+//waits. if the app crashes - a signal on linux and mac, an exception
+//code on windows - it is started again straight away and picks the
+//wall back up from shared memory (see sharedCanvas.h). any exit it
+//made itself, clean or with an error code, ends the supervisor too.
+//
+//if it keeps going down within SUPERVISOR_QUICK_SECS of starting
+//the wall itself might be what takes it down - after
+//SUPERVISOR_MAX_QUICK of those it starts with --no-restore and waits
+//a second between tries until a run lasts.
+//
+//run it with   laser-tag-2026 --supervise [the usual arguments]
+//
+//not with --regression or --soak - those are meant to end.
+
+#define SUPERVISOR_QUICK_SECS   10
+#define SUPERVISOR_MAX_QUICK    3
+
+//returns the exit code of the last run - 1 if it couldn't start it
+int runSupervisor(int argc, char * argv[]);
+
+#endif
@@ -0,0 +1,108 @@
+#include "threadPool.h"
+
+//-----------------------------------------------------
+threadPool::threadPool(){
+    currentJob = NULL;
+    jobCount   = 0;
+    nextJob    = 0;
+    numBusy    = 0;
+    generation = 0;
+    bQuit      = false;
+}
+
+threadPool::~threadPool(){
+    close();
+}
+
+//-----------------------------------------------------
+void threadPool::setup(int numThreads){
+    close();
+
+    if(numThreads <= 0){
+        numThreads = std::thread::hardware_concurrency();
+        if(numThreads <= 0) numThreads = 1;
+    }
+
+    bQuit = false;
+
+    //the caller is one of the threads
+    for(int i = 0; i < numThreads - 1; i++){
+        workers.push_back(std::thread(&threadPool::workerLoop, this, generation));
+    }
+}
+
+//-----------------------------------------------------
+void threadPool::close(){
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        bQuit = true;
+    }
+    startCondition.notify_all();
+
+    for(size_t i = 0; i < workers.size(); i++){
+        workers[i].join();
+    }
+    workers.clear();
+}
+
+int threadPool::getNumThreads(){
+    return workers.size() + 1;
+}
+
+//-----------------------------------------------------
+void threadPool::runJobs(){
+    int i;
+    while((i = nextJob++) < jobCount){
+        (*currentJob)(i);
+    }
+}
+
+//-----------------------------------------------------
+void threadPool::parallelFor(int count, const std::function<void(int)> & job){
+
+    if(count <= 0) return;
+
+    //nothing to share - don't wake anyone
+    if(count == 1 || workers.empty()){
+        for(int i = 0; i < count; i++) job(i);
+        return;
+    }
+
+    std::unique_lock<std::mutex> callLock(callMutex);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        currentJob = &job;
+        jobCount   = count;
+        nextJob    = 0;
+        numBusy    = workers.size();
+        generation++;
+    }
+    startCondition.notify_all();
+
+    runJobs();
+
+    //wait for the workers to finish the jobs they picked up
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this]{ return numBusy == 0; });
+    currentJob = NULL;
+}
+
+//-----------------------------------------------------
+void threadPool::workerLoop(unsigned int lastGeneration){
+
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCondition.wait(lock, [&]{ return bQuit || generation != lastGeneration; });
+            if(bQuit) return;
+            lastGeneration = generation;
+        }
+
+        runJobs();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        numBusy--;
+        if(numBusy == 0) doneCondition.notify_one();
+    }
+}
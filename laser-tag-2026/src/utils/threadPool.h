@@ -0,0 +1,48 @@
+#ifndef _THREAD_POOL_H
+#define _THREAD_POOL_H
+
+#include "ofMain.h"
+
+//a small fixed pool of worker threads for splitting per pixel
+//work into bands. parallelFor blocks until every job is done and
+//the calling thread helps out, so a pool of 1 just runs inline.
+//
+//calls from different threads are queued one after the other.
+
+class threadPool{
+
+public:
+
+    threadPool();
+    ~threadPool();
+
+    //total threads including the caller - 0 means one per core
+    void setup(int numThreads);
+    void close();
+
+    int getNumThreads();
+
+    //runs job(0) ... job(count-1) and waits for all of them
+    void parallelFor(int count, const std::function<void(int)> & job);
+
+protected:
+
+    void workerLoop(unsigned int lastGeneration);
+    void runJobs();
+
+    vector<std::thread> workers;
+
+    std::mutex callMutex;		//one parallelFor at a time
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+
+    const std::function<void(int)> * currentJob;
+    int jobCount;
+    std::atomic<int> nextJob;
+    int numBusy;
+    unsigned int generation;
+    bool bQuit;
+};
+
+#endif